@@ -66,10 +66,10 @@ namespace internal
     }
 
 
-    static void plot_samples(PlotProps& props, mic::MicDevice const& mic)
+    static void plot_samples(PlotProps& props, mic::MicFrame const& frame)
     {
         ++props.index;
-        props.data[props.index] = mic.sample;
+        props.data[props.index] = frame.sample[0];
 
         auto plot_data = props.data;
         int data_count = props.count;
@@ -81,7 +81,7 @@ namespace internal
         constexpr auto data_stride = sizeof(f32);
 
         char overlay[32] = { 0 };
-        stb::qsnprintf(overlay, 32, "%3.1f", mic.sample);
+        stb::qsnprintf(overlay, 32, "%3.1f", frame.sample[0]);
 
         ImGui::PlotLines("Samples", 
             plot_data, 
@@ -94,14 +94,14 @@ namespace internal
     }
 
 
-    static void plot_chunk_samples(PlotProps& props, mic::MicDevice const& mic)
+    static void plot_chunk_samples(PlotProps& props, mic::MicFrame const& frame)
     {
         static u32 chunk_max = 0;
 
         ++props.index;
-        props.data[props.index] = (f32)mic.chunk_samples;
+        props.data[props.index] = (f32)frame.chunk_samples;
 
-        chunk_max = num::max(mic.chunk_samples, chunk_max);
+        chunk_max = num::max(frame.chunk_samples, chunk_max);
 
         auto plot_data = props.data;
         int data_count = props.count;
@@ -114,7 +114,7 @@ namespace internal
         auto plot_max = (f32)chunk_max;
 
         char overlay[32] = { 0 };
-        stb::qsnprintf(overlay, 32, "%u", mic.chunk_samples);
+        stb::qsnprintf(overlay, 32, "%u", frame.chunk_samples);
 
         ImGui::PlotLines("Chunk sizes", 
             plot_data, 
@@ -127,14 +127,14 @@ namespace internal
     }
 
 
-    static void plot_chunk_times(PlotProps& props, mic::MicDevice const& mic)
+    static void plot_chunk_times(PlotProps& props, mic::MicFrame const& frame)
     {
         static f32 ms_max = 0.0f;
 
         ++props.index;
-        props.data[props.index] = (f32)mic.chunk_ms;
+        props.data[props.index] = (f32)frame.chunk_ms;
 
-        ms_max = num::max((f32)mic.chunk_ms, ms_max);
+        ms_max = num::max((f32)frame.chunk_ms, ms_max);
 
         auto plot_data = props.data;
         int data_count = props.count;
@@ -147,7 +147,7 @@ namespace internal
         auto plot_max = ms_max;
 
         char overlay[32] = { 0 };
-        stb::qsnprintf(overlay, 32, "%f", mic.chunk_ms);
+        stb::qsnprintf(overlay, 32, "%f", frame.chunk_ms);
 
         ImGui::PlotLines("Chunk times", 
             plot_data, 
@@ -160,14 +160,14 @@ namespace internal
     }
 
 
-    static void plot_buffer_times(PlotProps& props, mic::MicDevice const& mic)
+    static void plot_buffer_times(PlotProps& props, mic::MicFrame const& frame)
     {
         static f32 ms_max = 0.0f;
 
         ++props.index;
-        props.data[props.index] = (f32)mic.fill_buffer_ms;
+        props.data[props.index] = (f32)frame.fill_buffer_ms;
 
-        ms_max = num::max((f32)mic.fill_buffer_ms, ms_max);
+        ms_max = num::max((f32)frame.fill_buffer_ms, ms_max);
 
         auto plot_data = props.data;
         int data_count = props.count;
@@ -180,7 +180,7 @@ namespace internal
         auto plot_max = ms_max;
 
         char overlay[32] = { 0 };
-        stb::qsnprintf(overlay, 32, "%f", mic.fill_buffer_ms);
+        stb::qsnprintf(overlay, 32, "%f", frame.fill_buffer_ms);
 
         ImGui::PlotLines("Buffer times", 
             plot_data, 
@@ -193,14 +193,14 @@ namespace internal
     }
 
 
-    static void plot_fft_times(PlotProps& props, mic::MicDevice const& mic)
+    static void plot_fft_times(PlotProps& props, mic::MicFrame const& frame)
     {
         static f32 ms_max = 0.0f;
 
         ++props.index;
-        props.data[props.index] = (f32)mic.fft_ms;
+        props.data[props.index] = (f32)frame.fft_ms;
 
-        ms_max = num::max((f32)mic.fft_ms, ms_max);
+        ms_max = num::max((f32)frame.fft_ms, ms_max);
 
         auto plot_data = props.data;
         int data_count = props.count;
@@ -213,7 +213,7 @@ namespace internal
         auto plot_max = ms_max;
 
         char overlay[32] = { 0 };
-        stb::qsnprintf(overlay, 32, "%f", mic.fft_ms);
+        stb::qsnprintf(overlay, 32, "%f", frame.fft_ms);
 
         ImGui::PlotLines("FFT times", 
             plot_data, 
@@ -226,16 +226,16 @@ namespace internal
     }
 
 
-    static void plot_fft_bin(PlotProps& props, mic::MicDevice const& mic, u32 bin)
+    static void plot_fft_bin(PlotProps& props, mic::MicFrame const& frame, u32 bin)
     {
-        auto value = mic.fft_bins.data[bin];
+        auto value = frame.fft_bins[0].data[bin];
 
         static f32 value_max = 0.0f;
 
         value_max = num::max(value, value_max);
 
         ++props.index;
-        props.data[props.index] = (f32)mic.fft_ms;
+        props.data[props.index] = (f32)frame.fft_ms;
 
         auto plot_data = props.data;
         int data_count = props.count;
@@ -279,22 +279,22 @@ namespace internal
         static PlotProps buffer_time_props{};
         static PlotProps fft_time_props{};
 
-        plot_samples(sample_props, state.mic);
+        plot_samples(sample_props, state.mic.frame);
 
         if (state.mic.audio_proc == AP::InfoChunk)
         {
-            plot_chunk_samples(chunk_sample_props, state.mic);
-            plot_chunk_times(chunk_time_props, state.mic);
+            plot_chunk_samples(chunk_sample_props, state.mic.frame);
+            plot_chunk_times(chunk_time_props, state.mic.frame);
         }
 
         if (state.mic.audio_proc == AP::InfoBuffer)
         {
-            plot_buffer_times(buffer_time_props, state.mic);
+            plot_buffer_times(buffer_time_props, state.mic.frame);
         }
 
         if (state.mic.audio_proc == AP::InfoFFT)
         {
-            plot_fft_times(fft_time_props, state.mic);
+            plot_fft_times(fft_time_props, state.mic.frame);
         }
     }
 
@@ -308,14 +308,14 @@ namespace internal
 
         constexpr u32 N = 1024;
 
-        auto& bins = state.mic.fft_bins;
+        auto& bins = state.mic.frame.fft_bins[0];
         assert(bins.length <= N);
 
         static PlotProps props[N];
 
         for (u32 i = 0; i <bins.length; i++)
         {
-            plot_fft_bin(props[i], state.mic, i);
+            plot_fft_bin(props[i], state.mic.frame, i);
         }
     }
 }
@@ -332,6 +332,8 @@ namespace display
 
         ImGui::Begin("Mic");
 
+        mic::update(state.mic);
+
         if (start_disabled) { ImGui::BeginDisabled(); }
 
         if (ImGui::Button("Start"))
@@ -1,15 +1,22 @@
 #include "mic.hpp"
 #include "../../../libs/fft/fft.hpp"
 #include "../../../libs/util/stopwatch.hpp"
+#include "../../../libs/util/spsc_ring.hpp"
+#include "../../../libs/util/triple_buffer.hpp"
 
 #include <SDL2/SDL.h>
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <thread>
 
 
 namespace mic
 {
     static constexpr int SAMPLE_RATE = 44100;
-    static constexpr Uint8 CHANNELS = 1;    // Mono
+    static constexpr u32 CHANNELS = 1;    // Mono by default
 
     static constexpr int AUDIO_CAPTURE = 1;
     static constexpr int AUDIO_PLAYBACK = 0;
@@ -19,6 +26,12 @@ namespace mic
 
     static constexpr u32 FFT_EXP = 8;
 
+    // samples per channel between the callback and the analysis worker
+    static constexpr u32 RING_SAMPLES = 16 * 1024;
+
+    // sample frames (one sample of every channel) the worker takes from the ring at a time
+    static constexpr u32 WORK_FRAMES = 512;
+
 
     using FFT = fft::FFT<FFT_EXP>;
 
@@ -29,11 +42,61 @@ namespace mic
         SDL_AudioSpec spec;
         SDL_AudioDeviceID device;
 
-        FFT fft;
+        u32 n_channels = 0;
+
+        // one per channel
+        FFT fft[MAX_CHANNELS];
+
+        // interleaved sample frames
+        SPSCRing<f32> ring;
+
+        // callback bumps it after each write, worker waits on it
+        std::atomic<u32> n_writes = 0;
+        std::atomic<bool> running = false;
+
+        std::thread worker;
+
+        f32 work[WORK_FRAMES * MAX_CHANNELS];
+
+        // samples in each fft buffer toward the next frame
+        u32 n_buffered = 0;
+
+        // callback timing
+        Stopwatch cb_sw;
+        Stopwatch chunk_sw;
+
+        // worker timing
+        Stopwatch buffer_sw;
+        Stopwatch fft_sw;
+
+        // written by the callback, copied into each published frame
+        std::atomic<u32> chunk_samples = 0;
+        std::atomic<f64> chunk_ms = 0.0;
+        std::atomic<f64> cb_ms = 0.0;
+        std::atomic<u64> capture_ns = 0;
+        std::atomic<u64> dropped_samples = 0;
+
+        // worker side frame, published after each batch
+        MicFrame pending;
+        u64 sequence = 0;
 
-        static StateData* create() { return (StateData*)std::malloc(sizeof(StateData)); }
+        // bins of each published frame
+        TripleBuffer<MicFrame> frames;
+        alignas(fft::ALLOC_ALIGN) f32 frame_bins[3][MAX_CHANNELS][FFT::n_bins];
 
-        static void destroy(StateData* s) { std::free(s); }
+        // fft members are ALLOC_ALIGN aligned
+        static StateData* create()
+        {
+            auto p = fft::alloc_aligned(sizeof(StateData));
+
+            return p ? new (p) StateData() : 0;
+        }
+
+        static void destroy(StateData* s)
+        {
+            s->~StateData();
+            fft::free_aligned(s);
+        }
     };
 
 
@@ -57,148 +120,302 @@ namespace mic
     }
 
 
+    static void destroy_data(MicDevice& state)
+    {
+        StateData::destroy(&get_data(state));
+        state.handle = 0;
+    }
+
+
+    static u64 steady_ns()
+    {
+        using namespace std::chrono;
+
+        return (u64)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+
     static void chunk_info(MicDevice& state, int len_8)
     {
-        static Stopwatch sw;
+        auto& data = get_data(state);
+        auto& sw = data.chunk_sw;
 
-        auto len = len_8 / sizeof(f32);
+        // per channel, the stream is interleaved
+        auto len = len_8 / sizeof(f32) / data.n_channels;
 
-        state.chunk_samples = (u32)len;
+        data.chunk_samples.store((u32)len, std::memory_order_relaxed);
 
-        state.chunk_ms = sw.get_time_milli();
+        data.chunk_ms.store(sw.get_time_milli(), std::memory_order_relaxed);
         sw.start();
     }
 
 
-    static void buffer_info(MicDevice& state, Uint8* stream, int len_8)
-    {    
-        static Stopwatch sw;
+    static void forward_channels(StateData& data)
+    {
+        for (u32 c = 0; c < data.n_channels; c++)
+        {
+            auto& fft = data.fft[c];
+            fft.forward(fft.bins);
+        }
+    }
 
-        auto& data = get_data(state);
 
-        static u32 b = 0;
-        auto const push_sample = [&](f32 sample)
+    // splits interleaved samples into the per-channel frame buffers, on_frame runs each time they fill
+    template <class FN>
+    static void ingest(StateData& data, f32 const* samples, u32 len, FN const& on_frame)
+    {
+        constexpr auto size = FFT::size;
+
+        auto n_channels = data.n_channels;
+        auto n_frames = len / n_channels;
+
+        if (!n_frames)
+        {
+            return;
+        }
+
+        f32* dst[MAX_CHANNELS];
+
+        u32 i = 0;
+        while (i < n_frames)
         {
-            state.sample = sample;
-            data.fft.buffer[b++] = (f64)sample;
+            auto n = num::min(size - data.n_buffered, n_frames - i);
 
-            if (b >= data.fft.size)
+            for (u32 c = 0; c < n_channels; c++)
             {
-                b = 0;
-                state.fill_buffer_ms = sw.get_time_milli();
-                sw.start();
+                dst[c] = data.fft[c].buffer + data.n_buffered;
             }
-        };
 
-        f32* audio_data = (f32*)stream;
-        auto len = len_8 / sizeof(f32);
+            fft::deinterleave(samples + i * n_channels, dst, n, n_channels);
+
+            data.n_buffered += n;
+            i += n;
+
+            if (data.n_buffered == size)
+            {
+                data.n_buffered = 0;
+                on_frame();
+            }
+        }
 
-        for (u32 i = 0; i < len; i++)
+        auto last = samples + (n_frames - 1) * n_channels;
+        for (u32 c = 0; c < n_channels; c++)
         {
-            push_sample(audio_data[i]);
+            data.pending.sample[c] = last[c];
         }
     }
 
 
-    static void fft_info(MicDevice& state, Uint8* stream, int len_8)
+    static void buffer_info(MicDevice& state, f32 const* samples, u32 len)
+    {    
+        auto& data = get_data(state);
+        auto& sw = data.buffer_sw;
+
+        ingest(data, samples, len, [&]()
+        {
+            data.pending.fill_buffer_ms = sw.get_time_milli();
+            sw.start();
+        });
+    }
+
+
+    static void fft_info(MicDevice& state, f32 const* samples, u32 len)
     {
-        static Stopwatch sw;
+        auto& data = get_data(state);
+        auto& sw = data.fft_sw;
+
+        ingest(data, samples, len, [&]()
+        {
+            sw.start();
+            forward_channels(data);
+            data.pending.fft_ms = sw.get_time_milli();
+        });
+    }
+
 
+    static void process_audio_fft(MicDevice& state, f32 const* samples, u32 len)
+    {
         auto& data = get_data(state);
 
-        static u32 b = 0;
-        auto const push_sample = [&](f32 sample)
+        ingest(data, samples, len, [&]()
+        {
+            forward_channels(data);
+        });
+    }
+
+
+    static void process_samples(MicDevice& state, f32 const* samples, u32 len)
+    {
+        using AP = AudioProc;
+
+        switch (state.audio_proc)
         {
-            state.sample = sample;
-            data.fft.buffer[b++] = (f64)sample;
+        case AP::FFT:
+            process_audio_fft(state, samples, len);
+            break;
 
-            if (b >= data.fft.size)
+        case AP::InfoBuffer:
+            buffer_info(state, samples, len);
+            break;
+
+        case AP::InfoFFT:
+            fft_info(state, samples, len);
+            break;
+
+        default: break;
+        }
+    }
+
+
+    static void init_frames(StateData& data)
+    {
+        data.pending.n_channels = data.n_channels;
+
+        for (u32 i = 0; i < 3; i++)
+        {
+            auto& frame = data.frames.slot(i);
+            frame.n_channels = data.n_channels;
+
+            for (u32 c = 0; c < data.n_channels; c++)
             {
-                sw.start();
-                b = 0;
-                data.fft.forward(data.fft.bins);
-                state.fft_ms = sw.get_time_milli();                
+                frame.fft_bins[c].data = data.frame_bins[i][c];
+                frame.fft_bins[c].length = FFT::n_bins;
             }
-        };
+        }
+    }
+
+
+    static void publish_frame(StateData& data)
+    {
+        constexpr auto relaxed = std::memory_order_relaxed;
+
+        auto& frame = data.frames.write_slot();
+
+        Span bins[MAX_CHANNELS];
+        for (u32 c = 0; c < data.n_channels; c++)
+        {
+            bins[c] = frame.fft_bins[c];
+        }
 
-        f32* audio_data = (f32*)stream;
-        auto len = len_8 / sizeof(f32);
+        frame = data.pending;
 
-        for (u32 i = 0; i < len; i++)
+        frame.sequence = ++data.sequence;
+        frame.capture_ns = data.capture_ns.load(relaxed);
+        frame.chunk_samples = data.chunk_samples.load(relaxed);
+        frame.chunk_ms = data.chunk_ms.load(relaxed);
+        frame.cb_ms = data.cb_ms.load(relaxed);
+        frame.dropped_samples = data.dropped_samples.load(relaxed);
+
+        for (u32 c = 0; c < data.n_channels; c++)
         {
-            push_sample(audio_data[i]);
+            frame.fft_bins[c] = bins[c];
+            std::memcpy(bins[c].data, data.fft[c].bins, bins[c].length * sizeof(f32));
         }
+
+        data.frames.publish();
     }
 
 
-    static void process_audio_fft(MicDevice& state, Uint8* stream, int len_8)
+    static void analysis_proc(MicDevice& state)
     {
         auto& data = get_data(state);
 
-        static u32 b = 0;
-        auto const push_sample = [&](f32 sample)
+        u32 n_writes = 0;
+
+        while (data.running.load(std::memory_order_acquire))
         {
-            state.sample = sample;
-            data.fft.buffer[b++] = (f64)sample;
+            data.n_writes.wait(n_writes, std::memory_order_acquire);
+            n_writes = data.n_writes.load(std::memory_order_acquire);
 
-            if (b >= data.fft.size)
+            auto count = WORK_FRAMES * data.n_channels;
+
+            u32 len = 0;
+            while ((len = data.ring.read(data.work, count)))
             {
-                b = 0;
-                data.fft.forward(data.fft.bins);
+                process_samples(state, data.work, len);
+                publish_frame(data);
             }
-        };
+        }
+    }
+
+
+    static void start_worker(MicDevice& state)
+    {
+        auto& data = get_data(state);
+
+        data.running = true;
+        data.worker = std::thread(analysis_proc, std::ref(state));
+    }
 
-        f32* audio_data = (f32*)stream;
-        auto len = len_8 / sizeof(f32);
 
-        for (u32 i = 0; i < len; i++)
+    static void stop_worker(MicDevice& state)
+    {
+        auto& data = get_data(state);
+
+        data.running = false;
+        data.n_writes.fetch_add(1, std::memory_order_release);
+        data.n_writes.notify_one();
+
+        if (data.worker.joinable())
         {
-            push_sample(audio_data[i]);
+            data.worker.join();
         }
     }
 
 
+    // copies the chunk into the ring, the worker does the rest
     static void mic_audio_cb(void* userdata, Uint8* stream, int len_8)
     { 
-        static Stopwatch cb_sw;
-
-        using AP = AudioProc;
+        auto& state = *(MicDevice*)userdata;
+        auto& data = get_data(state);
 
+        auto& cb_sw = data.cb_sw;
         cb_sw.start();
 
-        auto& state = *(MicDevice*)userdata;
+        data.capture_ns.store(steady_ns(), std::memory_order_relaxed);
 
-        switch (state.audio_proc)
-        {
-        case AP::FFT:
-            process_audio_fft(state, stream, len_8);
-            break;
+        auto samples = (f32*)stream;
+        auto len = (u32)(len_8 / sizeof(f32));
 
-        case AP::InfoChunk:
+        if (state.audio_proc == AudioProc::InfoChunk)
+        {
             chunk_info(state, len_8);
-            break;
+        }
 
-        case AP::InfoBuffer:
-            buffer_info(state, stream, len_8);
-            break;
+        // whole sample frames only, keeps the channels in step when the ring is full
+        auto n = len;
 
-        case AP::InfoFFT:
-            fft_info(state, stream, len_8);
-            break;
+        auto space = data.ring.space();
+        if (space < len)
+        {
+            n = space - space % data.n_channels;
+        }
 
-        default: break;
+        n = data.ring.write(samples, n);
+        if (n < len)
+        {
+            data.dropped_samples.fetch_add((len - n) / data.n_channels, std::memory_order_relaxed);
         }
 
-        state.cb_ms = cb_sw.get_time_milli();
+        data.n_writes.fetch_add(1, std::memory_order_release);
+        data.n_writes.notify_one();
+
+        data.cb_ms.store(cb_sw.get_time_milli(), std::memory_order_relaxed);
     }
 }
 
 
 namespace mic
 {
-    bool init(MicDevice& state)
+    bool init(MicDevice& state, cstr device_name, u32 n_channels)
     {
         state.status = MicStatus::Closed;
+
+        if (!n_channels || n_channels > MAX_CHANNELS)
+        {
+            return false;
+        }
+
         state.audio_proc = AudioProc::FFT;
 
         if (SDL_Init(SDL_INIT_AUDIO) < 0)
@@ -213,36 +430,84 @@ namespace mic
 
         auto& data = get_data(state);
 
+        data.n_channels = n_channels;
+
+        for (u32 c = 0; c < n_channels; c++)
+        {
+            if (!data.fft[c].init())
+            {
+                destroy_data(state);
+                return false;
+            }
+        }
+
+        if (!data.ring.create(RING_SAMPLES * n_channels))
+        {
+            destroy_data(state);
+            return false;
+        }
+
+        init_frames(data);
+        state.frame = MicFrame{};
+
         SDL_AudioSpec desired;
 
         SDL_zero(desired);
         desired.freq = SAMPLE_RATE;
         desired.format = AUDIO_F32SYS; // 32-bit float, system endianness
-        desired.channels = 1;
-        desired.samples = 256; // Buffer size per callback
+        desired.channels = (Uint8)n_channels;
+        desired.samples = 256; // Sample frames per callback
         desired.callback = mic_audio_cb;
         desired.userdata = &state;
 
-        cstr device_name = 0;
-
         auto device = SDL_OpenAudioDevice(device_name, AUDIO_CAPTURE, &desired, &data.spec, 0);
         if (!device)
         {
+            destroy_data(state);
             return false;
         }
 
         data.device = device;
         state.status = MicStatus::Open;
 
-        data.fft.init();
-
-        state.fft_bins.data = data.fft.bins;
-        state.fft_bins.length = data.fft.n_bins;
+        start_worker(state);
 
         return true;
     }
 
 
+    bool init(MicDevice& state)
+    {
+        // system default capture device
+        return init(state, 0, CHANNELS);
+    }
+
+
+    bool init(MicDevice& state, cstr device_name)
+    {
+        return init(state, device_name, CHANNELS);
+    }
+
+
+    u32 device_count()
+    {
+        if (SDL_Init(SDL_INIT_AUDIO) < 0)
+        {
+            return 0;
+        }
+
+        auto count = SDL_GetNumAudioDevices(AUDIO_CAPTURE);
+
+        return count < 0 ? 0 : (u32)count;
+    }
+
+
+    cstr device_name(u32 index)
+    {
+        return SDL_GetAudioDeviceName((int)index, AUDIO_CAPTURE);
+    }
+
+
     void start(MicDevice& state)
     {
         if (state.status != MicStatus::Open)
@@ -283,7 +548,29 @@ namespace mic
         auto& data = get_data(state);
 
         SDL_CloseAudioDevice(data.device);
-        StateData::destroy(&data);
+        stop_worker(state);
+        destroy_data(state);
+        state.frame = MicFrame{};
         state.status = MicStatus::Closed;
     }
+
+
+    bool update(MicDevice& state)
+    {
+        if (state.status == MicStatus::Closed)
+        {
+            return false;
+        }
+
+        auto& data = get_data(state);
+
+        if (!data.frames.update())
+        {
+            return false;
+        }
+
+        state.frame = data.frames.read_slot();
+
+        return true;
+    }
 }
\ No newline at end of file
@@ -5,6 +5,9 @@
 
 namespace mic
 {
+    constexpr u32 MAX_CHANNELS = 32;
+
+
     enum class MicStatus : int
     {
         Closed = 0,
@@ -30,33 +33,68 @@ namespace mic
     };
 
 
-    class MicDevice
+    // consistent snapshot of the capture and analysis state
+    class MicFrame
     {
     public:
-        MicStatus status = MicStatus::Closed;
-        AudioProc audio_proc = AudioProc::FFT;
+        u64 sequence = 0; // 0 until the first frame is published
+        u64 capture_ns = 0; // steady clock, newest chunk in the frame
+
+        u32 n_channels = 0;
 
-        f32 sample = 0.0f;
+        // latest sample of each channel
+        f32 sample[MAX_CHANNELS] = {};
 
+        // samples per channel in the last callback chunk
         u32 chunk_samples = 0;
         f64 chunk_ms = 0.0;
 
         f64 fill_buffer_ms = 0;
         f64 fft_ms = 0.0;
 
-        f64 cb_ms;
+        f64 cb_ms = 0.0;
+
+        // samples per channel lost when the analysis worker falls behind
+        u64 dropped_samples = 0;
+
+        Span fft_bins[MAX_CHANNELS];
+    };
+
+
+    class MicDevice
+    {
+    public:
+        MicStatus status = MicStatus::Closed;
+        AudioProc audio_proc = AudioProc::FFT;
 
-        Span fft_bins;
+        // latest snapshot, refreshed by update()
+        MicFrame frame;
 
         u64 handle = 0;
     };
 
 
+    // each device runs its own callback, ring and analysis worker
+    // a MicDevice must stay at the same address until it is closed
+
     bool init(MicDevice& state);
 
+    bool init(MicDevice& state, cstr device_name);
+
+    // n_channels 1 to MAX_CHANNELS, each channel gets its own fft
+    bool init(MicDevice& state, cstr device_name, u32 n_channels);
+
+    // capture devices, names for init
+    u32 device_count();
+
+    cstr device_name(u32 index);
+
     void start(MicDevice& state);
 
     void pause(MicDevice& state);
 
     void close(MicDevice& state);
+
+    // takes the newest published frame, returns false when there is none
+    bool update(MicDevice& state);
 }
\ No newline at end of file
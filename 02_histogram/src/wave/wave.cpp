@@ -5,6 +5,7 @@
 
 #include <thread>
 #include <cstdlib>
+#include <new>
 
 
 namespace wave
@@ -34,9 +35,19 @@ namespace wave
         CBStatus cb_status;
 
 
-        static WaveData* create() { return (WaveData*)std::malloc(sizeof(WaveData)); }
+        // fft members are ALLOC_ALIGN aligned
+        static WaveData* create()
+        {
+            auto p = fft::alloc_aligned(sizeof(WaveData));
+
+            return p ? new (p) WaveData() : 0;
+        }
 
-        static void destroy(WaveData* w) { std::free(w); }
+        static void destroy(WaveData* w)
+        {
+            w->~WaveData();
+            fft::free_aligned(w);
+        }
     };
 
 
@@ -94,10 +105,9 @@ namespace wave
             auto s = (i / wavelength) % 2 ? 1.0 : -1.0;
 
             ctx.samples.data[i] = s;
-            fft.buffer[i] = s;
         }
 
-        fft.forward(fft.bins);
+        fft.forward(ctx.samples.data, fft.bins);
     }
 
 
@@ -112,10 +122,9 @@ namespace wave
             auto s = num::sin(i * f);
 
             ctx.samples.data[i] = s;
-            fft.buffer[i] = s;
         }
 
-        fft.forward(fft.bins);
+        fft.forward(ctx.samples.data, fft.bins);
     }
 
 
@@ -128,10 +137,9 @@ namespace wave
             auto s = 0.0f;
 
             ctx.samples.data[i] = s;
-            fft.buffer[i] = s;
         }
 
-        fft.forward(fft.bins);
+        fft.forward(ctx.samples.data, fft.bins);
     }
 
 
@@ -139,12 +147,7 @@ namespace wave
     {
         auto& fft = get_data(ctx).fft;
 
-        fft.inverse();
-
-        for (u32 i = 0; i < fft.size; i++)
-        {
-            ctx.fft_inverted.data[i] = fft.buffer[i];
-        }
+        fft.inverse(ctx.fft_inverted.data);
     }
 
 
@@ -225,7 +228,11 @@ namespace wave
 
         auto& data = get_data(ctx);
 
-        data.fft.init();
+        if (!data.fft.init())
+        {
+            destroy_data(ctx);
+            return false;
+        }
 
         ctx.fft_bins.data = data.fft.bins;
         ctx.fft_bins.length = data.fft.n_bins;
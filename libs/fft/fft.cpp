@@ -1,4 +1,32 @@
 #include "fft.hpp"
+#include "../util/thread_pool.hpp"
+#include "../util/stopwatch.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#define FFT_SIMD_128
+#endif
+
+// compiled with target attributes, selected at runtime
+#ifdef CPU_X86
+#define FFT_SIMD_256
+#define FFT_SIMD_512
+#endif
+
+#if defined(FFT_SIMD_128) || defined(FFT_SIMD_256)
+#include <immintrin.h>
+#endif
 
 namespace fft
 {
@@ -13,36 +41,3411 @@ namespace internal
 
     void rdft_inverse(int n, f32 *a, int *ip, f32 *w);
 
+    void rdft_forward_src(int n, f32 const* s, f32* a, int* ip, f32* w);
 
-    void init_ip_w(u32 n, i32* ip, f32* w)
+    void rdft_inverse_src(int n, f32 const* s, f32* a, int* ip, f32* w);
+
+    void cdft_forward(int n, f32* a, int* ip, f32* w);
+
+    void cdft_inverse_src(int n, f32 const* s, f32* a, int* ip, f32* w);
+
+    void ddct_forward(int n, f32* a, int* ip, f32* w, f32* c);
+
+    void ddct_inverse(int n, f32* a, int* ip, f32* w, f32* c);
+
+    void ddst_forward(int n, f32* a, int* ip, f32* w, f32* c);
+
+    void ddst_inverse(int n, f32* a, int* ip, f32* w, f32* c);
+
+    void dfct(int n, f32* a, f32* t, int* ip, f32* w, f32* c);
+
+    void dfst(int n, f32* a, f32* t, int* ip, f32* w, f32* c);
+
+    // fft_codelet.cpp
+    static bool codelet_forward(u32 n, f32 const* src, f32* dst);
+
+    static bool codelet_inverse(u32 n, f32 const* src, f32* dst);
+}
+}
+
+
+/* spectrum */
+
+namespace fft
+{
+namespace internal
+{
+    // 10 log10(p) = LN_TO_DB ln(p)
+    static constexpr f32 LN_TO_DB = (f32)(10.0 / 2.302585092994046);
+
+    static constexpr f32 HALF_PI = (f32)(num::PI / 2);
+    static constexpr f32 ONE_PI = (f32)num::PI;
+
+
+    class SpectrumParams
     {
-        rdft_ip_w((int)n, ip, w);
+    public:
+        Spectrum mode = Spectrum::Magnitude;
+
+        f32 scale = 1.0f;     // amplitude
+        f32 scale_sq = 1.0f;  // power
+        f32 db_offset = 0.0f; // 20 log10(scale)
+        f32 db_floor = 0.0f;
+    };
+
+
+    static SpectrumParams spectrum_params(u32 n, SpectrumOptions const& options)
+    {
+        SpectrumParams params{};
+
+        auto scale = 1.0f / options.window_gain;
+        if (options.mode == Spectrum::Normalized)
+        {
+            scale *= 2.0f / n;
+        }
+
+        params.mode = options.mode;
+        params.scale = scale;
+        params.scale_sq = scale * scale;
+        if (options.mode == Spectrum::Decibel)
+        {
+            params.db_offset = (f32)(20.0 * std::log10((f64)scale));
+        }
+        params.db_floor = options.db_floor;
+
+        return params;
     }
 
 
-    void forward(u32 n, f32* buffer, i32* ip, f32* w, f32* bins)
+    // src is the packed rdft output from bin 1: src[2i] = Re, src[2i + 1] = -Im
+    // dst[i] is bin i + 1 in the selected mode
+
+    // the sign comes from the sign bit of y like atan2, so Im = -0 with Re < 0 is -pi at every simd level
+    static f32 phase_scalar(f32 y, f32 x)
+    {
+        auto ax = num::abs(x);
+        auto ay = num::abs(y);
+
+        auto hi = num::max(ax, ay);
+        auto lo = num::min(ax, ay);
+
+        auto r = hi > 0.0f ? num::atan_approx(lo / hi) : 0.0f;
+
+        r = ay > ax ? HALF_PI - r : r;
+        r = x < 0.0f ? ONE_PI - r : r;
+
+        return std::signbit(y) ? -r : r;
+    }
+
+
+    template <Spectrum M>
+    static void spectrum_scalar(f32 const* src, f32* dst, u32 len, SpectrumParams const& p)
     {
-        rdft_forward((int)n, buffer, ip, w);
+        for (u32 i = 0; i < len; i++)
+        {
+            auto re = src[2 * i];
+            auto im = -src[2 * i + 1];
+            auto pw = re * re + im * im;
+
+            if constexpr (M == Spectrum::Power)
+            {
+                dst[i] = pw * p.scale_sq;
+            }
+            else if constexpr (M == Spectrum::Decibel)
+            {
+                dst[i] = num::max(LN_TO_DB * num::log(pw) + p.db_offset, p.db_floor);
+            }
+            else if constexpr (M == Spectrum::Phase)
+            {
+                dst[i] = phase_scalar(im, re);
+            }
+            else
+            {
+                dst[i] = num::sqrt(pw) * p.scale;
+            }
+        }
+    }
 
-        u32 b = 0;
-        for (u32 i = 2; i < n; i += 2)
+
+    static void spectrum_scalar(f32 const* src, f32* dst, u32 len, SpectrumParams const& p)
+    {
+        switch (p.mode)
         {
-            bins[b++] = num::hypot(buffer[i], buffer[i + 1]);
+        case Spectrum::Power: spectrum_scalar<Spectrum::Power>(src, dst, len, p); break;
+        case Spectrum::Decibel: spectrum_scalar<Spectrum::Decibel>(src, dst, len, p); break;
+        case Spectrum::Phase: spectrum_scalar<Spectrum::Phase>(src, dst, len, p); break;
+        default: spectrum_scalar<Spectrum::Magnitude>(src, dst, len, p); break;
         }
     }
 
 
-    void inverse(u32 n, f32* buffer, i32* ip, f32* w)
+#ifdef FFT_SIMD_128
+
+    // num::log, 4 at a time
+    static inline __m128 ln_128(__m128 x)
     {
-        rdft_inverse((int)n, buffer, ip, w);
+        auto bits = _mm_castps_si128(x);
+
+        auto e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+        auto m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+
+        auto r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.10969f), m), _mm_set1_ps(-0.729104f));
+        r = _mm_add_ps(_mm_mul_ps(r, m), _mm_set1_ps(2.11263f));
+        r = _mm_add_ps(_mm_mul_ps(r, m), _mm_set1_ps(-1.49278f));
+
+        return _mm_add_ps(r, _mm_mul_ps(e, _mm_set1_ps(0.6931471806f)));
     }
 
 
-    void forward(u32 n, f32* buffer, i32* ip, f32* w)
+    static inline __m128 select_128(__m128 mask, __m128 a, __m128 b)
     {
-        rdft_forward((int)n, buffer, ip, w);
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
     }
 
-    #include "fftsg_f32.cpp"
+
+    // phase_scalar, 4 at a time
+    static inline __m128 phase_128(__m128 y, __m128 x)
+    {
+        auto sign = _mm_set1_ps(-0.0f);
+
+        auto ax = _mm_andnot_ps(sign, x);
+        auto ay = _mm_andnot_ps(sign, y);
+
+        auto hi = _mm_max_ps(ax, ay);
+        auto lo = _mm_min_ps(ax, ay);
+
+        auto t = _mm_and_ps(_mm_div_ps(lo, hi), _mm_cmpgt_ps(hi, _mm_setzero_ps()));
+        auto sq = _mm_mul_ps(t, t);
+
+        auto r = _mm_add_ps(_mm_mul_ps(sq, _mm_set1_ps(-0.01172120f)), _mm_set1_ps(0.05265332f));
+        r = _mm_add_ps(_mm_mul_ps(sq, r), _mm_set1_ps(-0.11643287f));
+        r = _mm_add_ps(_mm_mul_ps(sq, r), _mm_set1_ps(0.19354346f));
+        r = _mm_add_ps(_mm_mul_ps(sq, r), _mm_set1_ps(-0.33262347f));
+        r = _mm_add_ps(_mm_mul_ps(sq, r), _mm_set1_ps(0.99997726f));
+        r = _mm_mul_ps(t, r);
+
+        r = select_128(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(HALF_PI), r), r);
+        r = select_128(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(ONE_PI), r), r);
+
+        return _mm_xor_ps(r, _mm_and_ps(y, sign));
+    }
+
+
+    template <Spectrum M>
+    static void spectrum_128(f32 const* src, f32* dst, u32 len, SpectrumParams const& p)
+    {
+        u32 i = 0;
+        for (; i + 4 <= len; i += 4)
+        {
+            auto a = _mm_loadu_ps(src + 2 * i);
+            auto b = _mm_loadu_ps(src + 2 * i + 4);
+
+            auto re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            auto im = _mm_xor_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)), _mm_set1_ps(-0.0f));
+
+            auto pw = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+
+            __m128 res;
+
+            if constexpr (M == Spectrum::Power)
+            {
+                res = _mm_mul_ps(pw, _mm_set1_ps(p.scale_sq));
+            }
+            else if constexpr (M == Spectrum::Decibel)
+            {
+                res = _mm_add_ps(_mm_mul_ps(ln_128(pw), _mm_set1_ps(LN_TO_DB)), _mm_set1_ps(p.db_offset));
+                res = _mm_max_ps(res, _mm_set1_ps(p.db_floor));
+            }
+            else if constexpr (M == Spectrum::Phase)
+            {
+                res = phase_128(im, re);
+            }
+            else
+            {
+                res = _mm_mul_ps(_mm_sqrt_ps(pw), _mm_set1_ps(p.scale));
+            }
+
+            _mm_storeu_ps(dst + i, res);
+        }
+
+        spectrum_scalar<M>(src + 2 * i, dst + i, len - i, p);
+    }
+
+
+    static void spectrum_128(f32 const* src, f32* dst, u32 len, SpectrumParams const& p)
+    {
+        switch (p.mode)
+        {
+        case Spectrum::Power: spectrum_128<Spectrum::Power>(src, dst, len, p); break;
+        case Spectrum::Decibel: spectrum_128<Spectrum::Decibel>(src, dst, len, p); break;
+        case Spectrum::Phase: spectrum_128<Spectrum::Phase>(src, dst, len, p); break;
+        default: spectrum_128<Spectrum::Magnitude>(src, dst, len, p); break;
+        }
+    }
+
+#endif
+
+
+#ifdef FFT_SIMD_256
+
+    CPU_TARGET_AVX2
+    static inline __m256 ln_256(__m256 x)
+    {
+        auto bits = _mm256_castps_si256(x);
+
+        auto e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+        auto m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000)));
+
+        auto r = _mm256_fmadd_ps(_mm256_set1_ps(0.10969f), m, _mm256_set1_ps(-0.729104f));
+        r = _mm256_fmadd_ps(r, m, _mm256_set1_ps(2.11263f));
+        r = _mm256_fmadd_ps(r, m, _mm256_set1_ps(-1.49278f));
+
+        return _mm256_fmadd_ps(e, _mm256_set1_ps(0.6931471806f), r);
+    }
+
+
+    CPU_TARGET_AVX2
+    static inline __m256 phase_256(__m256 y, __m256 x)
+    {
+        auto sign = _mm256_set1_ps(-0.0f);
+
+        auto ax = _mm256_andnot_ps(sign, x);
+        auto ay = _mm256_andnot_ps(sign, y);
+
+        auto hi = _mm256_max_ps(ax, ay);
+        auto lo = _mm256_min_ps(ax, ay);
+
+        auto t = _mm256_and_ps(_mm256_div_ps(lo, hi), _mm256_cmp_ps(hi, _mm256_setzero_ps(), _CMP_GT_OQ));
+        auto sq = _mm256_mul_ps(t, t);
+
+        auto r = _mm256_fmadd_ps(sq, _mm256_set1_ps(-0.01172120f), _mm256_set1_ps(0.05265332f));
+        r = _mm256_fmadd_ps(sq, r, _mm256_set1_ps(-0.11643287f));
+        r = _mm256_fmadd_ps(sq, r, _mm256_set1_ps(0.19354346f));
+        r = _mm256_fmadd_ps(sq, r, _mm256_set1_ps(-0.33262347f));
+        r = _mm256_fmadd_ps(sq, r, _mm256_set1_ps(0.99997726f));
+        r = _mm256_mul_ps(t, r);
+
+        r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(HALF_PI), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+        r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(ONE_PI), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+
+        return _mm256_xor_ps(r, _mm256_and_ps(y, sign));
+    }
+
+
+    template <Spectrum M>
+    CPU_TARGET_AVX2
+    static void spectrum_256(f32 const* src, f32* dst, u32 len, SpectrumParams const& p)
+    {
+        u32 i = 0;
+        for (; i + 8 <= len; i += 8)
+        {
+            auto a = _mm256_loadu_ps(src + 2 * i);
+            auto b = _mm256_loadu_ps(src + 2 * i + 8);
+
+            // (0 2 8 10 | 4 6 12 14)
+            auto re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            auto im = _mm256_xor_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)), _mm256_set1_ps(-0.0f));
+
+            auto pw = _mm256_fmadd_ps(re, re, _mm256_mul_ps(im, im));
+
+            __m256 res;
+
+            if constexpr (M == Spectrum::Power)
+            {
+                res = _mm256_mul_ps(pw, _mm256_set1_ps(p.scale_sq));
+            }
+            else if constexpr (M == Spectrum::Decibel)
+            {
+                res = _mm256_fmadd_ps(ln_256(pw), _mm256_set1_ps(LN_TO_DB), _mm256_set1_ps(p.db_offset));
+                res = _mm256_max_ps(res, _mm256_set1_ps(p.db_floor));
+            }
+            else if constexpr (M == Spectrum::Phase)
+            {
+                res = phase_256(im, re);
+            }
+            else
+            {
+                res = _mm256_mul_ps(_mm256_sqrt_ps(pw), _mm256_set1_ps(p.scale));
+            }
+
+            res = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(res), _MM_SHUFFLE(3, 1, 2, 0)));
+
+            _mm256_storeu_ps(dst + i, res);
+        }
+
+        _mm256_zeroupper();
+        spectrum_scalar<M>(src + 2 * i, dst + i, len - i, p);
+    }
+
+
+    CPU_TARGET_AVX2
+    static void spectrum_256(f32 const* src, f32* dst, u32 len, SpectrumParams const& p)
+    {
+        switch (p.mode)
+        {
+        case Spectrum::Power: spectrum_256<Spectrum::Power>(src, dst, len, p); break;
+        case Spectrum::Decibel: spectrum_256<Spectrum::Decibel>(src, dst, len, p); break;
+        case Spectrum::Phase: spectrum_256<Spectrum::Phase>(src, dst, len, p); break;
+        default: spectrum_256<Spectrum::Magnitude>(src, dst, len, p); break;
+        }
+    }
+
+#endif
+
+
+#ifdef FFT_SIMD_512
+
+    CPU_TARGET_AVX512
+    static inline __m512 ln_512(__m512 x)
+    {
+        auto bits = _mm512_castps_si512(x);
+
+        auto e = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(127)));
+        auto m = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007FFFFF)), _mm512_set1_epi32(0x3F800000)));
+
+        auto r = _mm512_fmadd_ps(_mm512_set1_ps(0.10969f), m, _mm512_set1_ps(-0.729104f));
+        r = _mm512_fmadd_ps(r, m, _mm512_set1_ps(2.11263f));
+        r = _mm512_fmadd_ps(r, m, _mm512_set1_ps(-1.49278f));
+
+        return _mm512_fmadd_ps(e, _mm512_set1_ps(0.6931471806f), r);
+    }
+
+
+    CPU_TARGET_AVX512
+    static inline __m512 phase_512(__m512 y, __m512 x)
+    {
+        auto sign = _mm512_set1_epi32((i32)0x80000000);
+
+        auto ax = _mm512_castsi512_ps(_mm512_andnot_si512(sign, _mm512_castps_si512(x)));
+        auto ay = _mm512_castsi512_ps(_mm512_andnot_si512(sign, _mm512_castps_si512(y)));
+
+        auto hi = _mm512_max_ps(ax, ay);
+        auto lo = _mm512_min_ps(ax, ay);
+
+        auto t = _mm512_maskz_div_ps(_mm512_cmp_ps_mask(hi, _mm512_setzero_ps(), _CMP_GT_OQ), lo, hi);
+        auto sq = _mm512_mul_ps(t, t);
+
+        auto r = _mm512_fmadd_ps(sq, _mm512_set1_ps(-0.01172120f), _mm512_set1_ps(0.05265332f));
+        r = _mm512_fmadd_ps(sq, r, _mm512_set1_ps(-0.11643287f));
+        r = _mm512_fmadd_ps(sq, r, _mm512_set1_ps(0.19354346f));
+        r = _mm512_fmadd_ps(sq, r, _mm512_set1_ps(-0.33262347f));
+        r = _mm512_fmadd_ps(sq, r, _mm512_set1_ps(0.99997726f));
+        r = _mm512_mul_ps(t, r);
+
+        r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(ay, ax, _CMP_GT_OQ), _mm512_set1_ps(HALF_PI), r);
+        r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ), _mm512_set1_ps(ONE_PI), r);
+
+        auto ys = _mm512_and_si512(_mm512_castps_si512(y), sign);
+
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(r), ys));
+    }
+
+
+    template <Spectrum M>
+    CPU_TARGET_AVX512
+    static void spectrum_512(f32 const* src, f32* dst, u32 len, SpectrumParams const& p)
+    {
+        auto even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        auto odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+        auto sign = _mm512_set1_epi32((i32)0x80000000);
+
+        u32 i = 0;
+        for (; i + 16 <= len; i += 16)
+        {
+            auto a = _mm512_loadu_ps(src + 2 * i);
+            auto b = _mm512_loadu_ps(src + 2 * i + 16);
+
+            // negated by the sign bit like the narrower kernels, 0 - x would turn -0 into +0
+            auto re = _mm512_permutex2var_ps(a, even, b);
+            auto im = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_permutex2var_ps(a, odd, b)), sign));
+
+            auto pw = _mm512_fmadd_ps(re, re, _mm512_mul_ps(im, im));
+
+            __m512 res;
+
+            if constexpr (M == Spectrum::Power)
+            {
+                res = _mm512_mul_ps(pw, _mm512_set1_ps(p.scale_sq));
+            }
+            else if constexpr (M == Spectrum::Decibel)
+            {
+                res = _mm512_fmadd_ps(ln_512(pw), _mm512_set1_ps(LN_TO_DB), _mm512_set1_ps(p.db_offset));
+                res = _mm512_max_ps(res, _mm512_set1_ps(p.db_floor));
+            }
+            else if constexpr (M == Spectrum::Phase)
+            {
+                res = phase_512(im, re);
+            }
+            else
+            {
+                res = _mm512_mul_ps(_mm512_sqrt_ps(pw), _mm512_set1_ps(p.scale));
+            }
+
+            _mm512_storeu_ps(dst + i, res);
+        }
+
+        spectrum_256<M>(src + 2 * i, dst + i, len - i, p);
+    }
+
+
+    CPU_TARGET_AVX512
+    static void spectrum_512(f32 const* src, f32* dst, u32 len, SpectrumParams const& p)
+    {
+        switch (p.mode)
+        {
+        case Spectrum::Power: spectrum_512<Spectrum::Power>(src, dst, len, p); break;
+        case Spectrum::Decibel: spectrum_512<Spectrum::Decibel>(src, dst, len, p); break;
+        case Spectrum::Phase: spectrum_512<Spectrum::Phase>(src, dst, len, p); break;
+        default: spectrum_512<Spectrum::Magnitude>(src, dst, len, p); break;
+        }
+    }
+
+#endif
+
+
+    static void (*spectrum_kernel)(f32 const* src, f32* dst, u32 len, SpectrumParams const& p) = spectrum_scalar;
+}
+}
+
+
+/* layout */
+
+namespace fft
+{
+namespace internal
+{
+    // src is the packed rdft output from bin 1: src[2i] = Re, src[2i + 1] = -Im
+    // complex: dst[2i] = Re, dst[2i + 1] = Im
+    // split: re[i] = Re, im[i] = Im
+
+    static void complex_scalar(f32 const* src, f32* dst, u32 len)
+    {
+        for (u32 i = 0; i < len; i++)
+        {
+            dst[2 * i] = src[2 * i];
+            dst[2 * i + 1] = -src[2 * i + 1];
+        }
+    }
+
+
+    static void split_scalar(f32 const* src, f32* re, f32* im, u32 len)
+    {
+        for (u32 i = 0; i < len; i++)
+        {
+            re[i] = src[2 * i];
+            im[i] = -src[2 * i + 1];
+        }
+    }
+
+
+#ifdef FFT_SIMD_128
+
+    static void complex_128(f32 const* src, f32* dst, u32 len)
+    {
+        auto conj = _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+
+        u32 i = 0;
+        for (; i + 2 <= len; i += 2)
+        {
+            _mm_storeu_ps(dst + 2 * i, _mm_xor_ps(_mm_loadu_ps(src + 2 * i), conj));
+        }
+
+        complex_scalar(src + 2 * i, dst + 2 * i, len - i);
+    }
+
+
+    static void split_128(f32 const* src, f32* re, f32* im, u32 len)
+    {
+        auto sign = _mm_set1_ps(-0.0f);
+
+        u32 i = 0;
+        for (; i + 4 <= len; i += 4)
+        {
+            auto a = _mm_loadu_ps(src + 2 * i);
+            auto b = _mm_loadu_ps(src + 2 * i + 4);
+
+            _mm_storeu_ps(re + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(im + i, _mm_xor_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)), sign));
+        }
+
+        split_scalar(src + 2 * i, re + i, im + i, len - i);
+    }
+
+#endif
+
+
+#ifdef FFT_SIMD_256
+
+    CPU_TARGET_AVX2
+    static void complex_256(f32 const* src, f32* dst, u32 len)
+    {
+        auto conj = _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f);
+
+        u32 i = 0;
+        for (; i + 4 <= len; i += 4)
+        {
+            _mm256_storeu_ps(dst + 2 * i, _mm256_xor_ps(_mm256_loadu_ps(src + 2 * i), conj));
+        }
+
+        _mm256_zeroupper();
+        complex_scalar(src + 2 * i, dst + 2 * i, len - i);
+    }
+
+
+    CPU_TARGET_AVX2
+    static void split_256(f32 const* src, f32* re, f32* im, u32 len)
+    {
+        auto sign = _mm256_set1_ps(-0.0f);
+
+        u32 i = 0;
+        for (; i + 8 <= len; i += 8)
+        {
+            auto a = _mm256_loadu_ps(src + 2 * i);
+            auto b = _mm256_loadu_ps(src + 2 * i + 8);
+
+            // (0 2 8 10 | 4 6 12 14)
+            auto r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            auto m = _mm256_xor_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)), sign);
+
+            r = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0)));
+            m = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(m), _MM_SHUFFLE(3, 1, 2, 0)));
+
+            _mm256_storeu_ps(re + i, r);
+            _mm256_storeu_ps(im + i, m);
+        }
+
+        _mm256_zeroupper();
+        split_scalar(src + 2 * i, re + i, im + i, len - i);
+    }
+
+#endif
+
+
+#ifdef FFT_SIMD_512
+
+    CPU_TARGET_AVX512
+    static void complex_512(f32 const* src, f32* dst, u32 len)
+    {
+        auto conj = _mm512_set1_epi64((i64)0x8000000000000000);
+
+        u32 i = 0;
+        for (; i + 8 <= len; i += 8)
+        {
+            auto a = _mm512_castps_si512(_mm512_loadu_ps(src + 2 * i));
+
+            _mm512_storeu_ps(dst + 2 * i, _mm512_castsi512_ps(_mm512_xor_si512(a, conj)));
+        }
+
+        complex_256(src + 2 * i, dst + 2 * i, len - i);
+    }
+
+
+    CPU_TARGET_AVX512
+    static void split_512(f32 const* src, f32* re, f32* im, u32 len)
+    {
+        auto even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        auto odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+
+        auto sign = _mm512_set1_epi32((i32)0x80000000);
+
+        u32 i = 0;
+        for (; i + 16 <= len; i += 16)
+        {
+            auto a = _mm512_loadu_ps(src + 2 * i);
+            auto b = _mm512_loadu_ps(src + 2 * i + 16);
+
+            auto m = _mm512_castps_si512(_mm512_permutex2var_ps(a, odd, b));
+
+            _mm512_storeu_ps(re + i, _mm512_permutex2var_ps(a, even, b));
+            _mm512_storeu_ps(im + i, _mm512_castsi512_ps(_mm512_xor_si512(m, sign)));
+        }
+
+        split_256(src + 2 * i, re + i, im + i, len - i);
+    }
+
+#endif
+
+
+    static void (*complex_kernel)(f32 const* src, f32* dst, u32 len) = complex_scalar;
+
+    static void (*split_kernel)(f32 const* src, f32* re, f32* im, u32 len) = split_scalar;
+}
+}
+
+
+namespace fft
+{
+namespace internal
+{
+
+    void init_ip_w(u32 n, i32* ip, f32* w)
+    {
+        rdft_ip_w((int)n, ip, w);
+    }
+
+
+    // codelets for the small sizes, fftsg for the rest
+    static void forward_to(u32 n, f32 const* src, f32* dst, i32* ip, f32* w)
+    {
+        if (n > CODELET_MAX_SIZE || !codelet_forward(n, src, dst))
+        {
+            rdft_forward_src((int)n, src, dst, ip, w);
+        }
+    }
+
+
+    static void inverse_to(u32 n, f32 const* src, f32* dst, i32* ip, f32* w)
+    {
+        if (n > CODELET_MAX_SIZE || !codelet_inverse(n, src, dst))
+        {
+            rdft_inverse_src((int)n, src, dst, ip, w);
+        }
+    }
+
+
+    void forward(u32 n, f32* buffer, i32* ip, f32* w, f32* bins)
+    {
+        forward_to(n, buffer, buffer, ip, w);
+
+        spectrum_kernel(buffer + 2, bins, fft_bin_size(n), SpectrumParams{});
+    }
+
+
+    void inverse(u32 n, f32* buffer, i32* ip, f32* w)
+    {
+        inverse_to(n, buffer, buffer, ip, w);
+    }
+
+
+    void forward(u32 n, f32* buffer, i32* ip, f32* w)
+    {
+        forward_to(n, buffer, buffer, ip, w);
+    }
+
+
+    void bins(u32 n, f32 const* buffer, f32* bins)
+    {
+        spectrum_kernel(buffer + 2, bins, fft_bin_size(n), SpectrumParams{});
+    }
+
+    #include "fftsg_f32.cpp"
+    #include "fftsg_f32_simd.cpp"
+    #include "fft4g_f32.cpp"
+    #include "fft8g_f32.cpp"
+    #include "fft_batch.cpp"
+    #include "fft_codelet.cpp"
+    #include "fft_stockham.cpp"
+    #include "fft_fourstep.cpp"
+    #include "fft_mixed.cpp"
+    #include "fft_fixed.cpp"
+}
+}
+
+
+/* simd dispatch */
+
+namespace fft
+{
+namespace internal
+{
+    static cpu::SIMD bind_kernels(cpu::SIMD simd)
+    {
+        switch (simd)
+        {
+    #ifdef FFT_SIMD_512
+        case cpu::SIMD::AVX512:
+            spectrum_kernel = spectrum_512;
+            complex_kernel = complex_512;
+            split_kernel = split_512;
+            break;
+    #endif
+    #ifdef FFT_SIMD_256
+        case cpu::SIMD::AVX2:
+            spectrum_kernel = spectrum_256;
+            complex_kernel = complex_256;
+            split_kernel = split_256;
+            break;
+    #endif
+    #ifdef FFT_SIMD_128
+        case cpu::SIMD::SSE2:
+            spectrum_kernel = spectrum_128;
+            complex_kernel = complex_128;
+            split_kernel = split_128;
+            break;
+    #endif
+        default:
+            spectrum_kernel = spectrum_scalar;
+            complex_kernel = complex_scalar;
+            split_kernel = split_scalar;
+        }
+
+        bind_fourstep_kernels(simd);
+        bind_fixed_kernels(simd);
+
+        return bind_stage_kernels(simd);
+    }
+
+
+    // bound at startup to the best level the cpu supports
+    static cpu::SIMD simd_bound = bind_kernels(cpu::simd_level());
+}
+}
+
+
+/* memory */
+
+namespace fft
+{
+namespace internal
+{
+    static constexpr u64 HUGE_PAGE_BYTES = 2u << 20;
+
+
+    // one ALLOC_ALIGN unit in front of every block
+    class AllocHeader
+    {
+    public:
+        u64 map_bytes; // 0 from aligned_alloc
+    };
+
+    static_assert(sizeof(AllocHeader) <= ALLOC_ALIGN);
+}
+
+
+    void* alloc_aligned(u64 bytes)
+    {
+        return alloc_aligned(bytes, bytes >= HUGE_PAGE_MIN_BYTES);
+    }
+
+
+    void* alloc_aligned(u64 bytes, bool huge_pages)
+    {
+        using namespace internal;
+
+        auto total = ALLOC_ALIGN + bytes;
+
+    #ifdef MAP_HUGETLB
+        if (huge_pages)
+        {
+            // fails unless huge pages are reserved
+            auto map_bytes = (total + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+            auto map = mmap(0, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (map != MAP_FAILED)
+            {
+                ((AllocHeader*)map)->map_bytes = map_bytes;
+                return (u8*)map + ALLOC_ALIGN;
+            }
+        }
+    #endif
+
+        auto align = huge_pages ? HUGE_PAGE_BYTES : ALLOC_ALIGN;
+        total = (total + align - 1) / align * align;
+
+        auto block = std::aligned_alloc(align, total);
+        if (!block)
+        {
+            return 0;
+        }
+
+    #ifdef MADV_HUGEPAGE
+        if (huge_pages)
+        {
+            madvise(block, total, MADV_HUGEPAGE);
+        }
+    #endif
+
+        ((AllocHeader*)block)->map_bytes = 0;
+
+        return (u8*)block + ALLOC_ALIGN;
+    }
+
+
+    void free_aligned(void* data)
+    {
+        if (!data)
+        {
+            return;
+        }
+
+        auto block = (u8*)data - ALLOC_ALIGN;
+        auto map_bytes = ((internal::AllocHeader*)block)->map_bytes;
+
+        if (map_bytes)
+        {
+            munmap(block, map_bytes);
+        }
+        else
+        {
+            std::free(block);
+        }
+    }
+}
+
+
+/* plan cache */
+
+namespace fft
+{
+namespace internal
+{
+    class PlanTables
+    {
+    public:
+        i32* ip = 0;
+        f32* w = 0;
+
+        // points into the table file mapping, not freed
+        bool mapped = false;
+    };
+
+
+    class BatchTables
+    {
+    public:
+        u32* rev = 0;
+        f32* tw = 0;
+        f32* ws = 0;
+    };
+
+
+    class StockhamTables
+    {
+    public:
+        f32* tw = 0;
+        f32* ws = 0;
+    };
+
+
+    static PlanTables plan_tables[PLAN_MAX_EXP + 1];
+
+    static BatchTables batch_tables[PLAN_MAX_EXP + 1];
+
+    class FourStepTables
+    {
+    public:
+        f32* ws = 0;
+        f32* lo = 0;
+        f32* hi = 0;
+    };
+
+
+    class DctTables
+    {
+    public:
+        f32* c = 0;
+    };
+
+
+    class FixedTables
+    {
+    public:
+        i16* tw = 0;
+    };
+
+
+    static StockhamTables stockham_tables[PLAN_MAX_EXP + 1];
+
+    static FourStepTables fourstep_tables[PLAN_MAX_EXP + 1];
+
+    static DctTables dct_tables[PLAN_MAX_EXP + 1];
+
+    static PlanTables fft4g_tables[PLAN_MAX_EXP + 1];
+
+    static PlanTables fft8g_tables[PLAN_MAX_EXP + 1];
+
+    static FixedTables fixed_tables[PLAN_MAX_EXP + 1];
+
+    static std::mutex plan_mutex;
+
+    // load_tables, unmapped by destroy_plans
+    static void* tables_map = 0;
+    static u64 tables_map_bytes = 0;
+
+
+    static u32 plan_exp(u32 size)
+    {
+        u32 exp = 0;
+        while ((1u << exp) < size)
+        {
+            exp++;
+        }
+
+        return exp;
+    }
+
+
+    static bool create_tables(PlanTables& tables, u32 size)
+    {
+        auto ip_bytes = fft_ip_size(size) * sizeof(i32);
+        auto w_bytes = fft_w_size(size) * sizeof(f32);
+
+        auto ip = (i32*)alloc_aligned(ip_bytes);
+        auto w = (f32*)alloc_aligned(w_bytes);
+        if (!ip || !w)
+        {
+            free_aligned(ip);
+            free_aligned(w);
+            return false;
+        }
+
+        init_ip_w(size, ip, w);
+
+        tables.ip = ip;
+        tables.w = w;
+
+        return true;
+    }
+
+
+    // the fft4g and fft8g bit reversal tables fit in fft_ip_size
+    static bool create_tables(PlanTables& tables, u32 size, Engine engine)
+    {
+        auto ip = (i32*)alloc_aligned(fft_ip_size(size) * sizeof(i32));
+        auto w = (f32*)alloc_aligned(fft_w_size(size) * sizeof(f32));
+        if (!ip || !w)
+        {
+            free_aligned(ip);
+            free_aligned(w);
+            return false;
+        }
+
+        if (engine == Engine::Fft8g)
+        {
+            fft8g::rdft_ip_w((int)size, ip, w);
+        }
+        else
+        {
+            fft4g::rdft_ip_w((int)size, ip, w);
+        }
+
+        tables.ip = ip;
+        tables.w = w;
+
+        return true;
+    }
+
+
+    static void destroy_tables(PlanTables& tables)
+    {
+        if (!tables.mapped)
+        {
+            free_aligned(tables.ip);
+            free_aligned(tables.w);
+        }
+
+        tables.ip = 0;
+        tables.w = 0;
+        tables.mapped = false;
+    }
+
+
+    static bool create_tables(BatchTables& tables, u32 size)
+    {
+        auto nc = size / 2;
+
+        auto rev = (u32*)alloc_aligned(nc * sizeof(u32));
+        auto tw = (f32*)alloc_aligned(nc * sizeof(f32));
+        auto ws = (f32*)alloc_aligned((nc + 2) * sizeof(f32));
+        if (!rev || !tw || !ws)
+        {
+            free_aligned(rev);
+            free_aligned(tw);
+            free_aligned(ws);
+            return false;
+        }
+
+        auto bits = plan_exp(nc);
+        for (u32 i = 0; i < nc; i++)
+        {
+            u32 r = 0;
+            for (u32 b = 0; b < bits; b++)
+            {
+                r |= ((i >> b) & 1u) << (bits - 1 - b);
+            }
+
+            rev[i] = r;
+        }
+
+        // exact angles, the batch engine has no error correcting stages
+        constexpr f64 TP = 2.0 * num::PI;
+
+        for (u32 j = 0; j < nc / 2; j++)
+        {
+            tw[2 * j] = (f32)std::cos(TP * j / nc);
+            tw[2 * j + 1] = (f32)-std::sin(TP * j / nc);
+        }
+
+        for (u32 k = 0; k <= nc / 2; k++)
+        {
+            ws[2 * k] = (f32)std::cos(TP * k / size);
+            ws[2 * k + 1] = (f32)std::sin(TP * k / size);
+        }
+
+        tables.rev = rev;
+        tables.tw = tw;
+        tables.ws = ws;
+
+        return true;
+    }
+
+
+    static void destroy_tables(BatchTables& tables)
+    {
+        free_aligned(tables.rev);
+        free_aligned(tables.tw);
+        free_aligned(tables.ws);
+
+        tables.rev = 0;
+        tables.tw = 0;
+        tables.ws = 0;
+    }
+
+
+    static bool create_tables(StockhamTables& tables, u32 size)
+    {
+        auto nc = size / 2;
+
+        auto tw = (f32*)alloc_aligned(2 * nc * sizeof(f32));
+        auto ws = (f32*)alloc_aligned((nc + 2) * sizeof(f32));
+        if (!tw || !ws)
+        {
+            free_aligned(tw);
+            free_aligned(ws);
+            return false;
+        }
+
+        // exact angles like the batch tables
+        constexpr f64 TP = 2.0 * num::PI;
+
+        for (u32 j = 0; j < nc; j++)
+        {
+            tw[2 * j] = (f32)std::cos(TP * j / nc);
+            tw[2 * j + 1] = (f32)-std::sin(TP * j / nc);
+        }
+
+        for (u32 k = 0; k <= nc / 2; k++)
+        {
+            ws[2 * k] = (f32)std::cos(TP * k / size);
+            ws[2 * k + 1] = (f32)std::sin(TP * k / size);
+        }
+
+        tables.tw = tw;
+        tables.ws = ws;
+
+        return true;
+    }
+
+
+    static void destroy_tables(StockhamTables& tables)
+    {
+        free_aligned(tables.tw);
+        free_aligned(tables.ws);
+
+        tables.tw = 0;
+        tables.ws = 0;
+    }
+
+
+    // n1 rows of n2, n1 = n2 or 2 n2
+    static void fourstep_shape(u32 nc, u32& n1, u32& n2)
+    {
+        n1 = 1u << ((plan_exp(nc) + 1) / 2);
+        n2 = nc / n1;
+    }
+
+
+    static bool create_tables(FourStepTables& tables, u32 size)
+    {
+        auto nc = size / 2;
+
+        u32 n_lo, n_hi;
+        fourstep_shape(nc, n_lo, n_hi);
+
+        auto ws = (f32*)alloc_aligned((nc + 2) * sizeof(f32));
+        auto lo = (f32*)alloc_aligned(2 * n_lo * sizeof(f32));
+        auto hi = (f32*)alloc_aligned(2 * n_hi * sizeof(f32));
+        if (!ws || !lo || !hi)
+        {
+            free_aligned(ws);
+            free_aligned(lo);
+            free_aligned(hi);
+            return false;
+        }
+
+        constexpr f64 TP = 2.0 * num::PI;
+
+        for (u32 k = 0; k <= nc / 2; k++)
+        {
+            ws[2 * k] = (f32)std::cos(TP * k / size);
+            ws[2 * k + 1] = (f32)std::sin(TP * k / size);
+        }
+
+        // exp(-2 pi i m / nc) = lo[m % n_lo] hi[m / n_lo]
+        for (u32 j = 0; j < n_lo; j++)
+        {
+            lo[2 * j] = (f32)std::cos(TP * j / nc);
+            lo[2 * j + 1] = (f32)-std::sin(TP * j / nc);
+        }
+
+        for (u32 j = 0; j < n_hi; j++)
+        {
+            hi[2 * j] = (f32)std::cos(TP * j * n_lo / nc);
+            hi[2 * j + 1] = (f32)-std::sin(TP * j * n_lo / nc);
+        }
+
+        tables.ws = ws;
+        tables.lo = lo;
+        tables.hi = hi;
+
+        return true;
+    }
+
+
+    static void destroy_tables(FourStepTables& tables)
+    {
+        free_aligned(tables.ws);
+        free_aligned(tables.lo);
+        free_aligned(tables.hi);
+
+        tables.ws = 0;
+        tables.lo = 0;
+        tables.hi = 0;
+    }
+
+
+    // the makect(size) layout, computed in f64
+    // c[0] = cos(pi / 4), c[j] = cos(pi j / (2 size)) / 2, c[size - j] = sin(pi j / (2 size)) / 2
+    static bool create_tables(DctTables& tables, u32 size)
+    {
+        auto c = (f32*)alloc_aligned(size * sizeof(f32));
+        if (!c)
+        {
+            return false;
+        }
+
+        auto h = size / 2;
+        auto delta = num::PI / (2.0 * size);
+
+        c[0] = (f32)std::cos(delta * h);
+        c[h] = 0.5f * c[0];
+        for (u32 j = 1; j < h; j++)
+        {
+            c[j] = (f32)(0.5 * std::cos(delta * j));
+            c[size - j] = (f32)(0.5 * std::sin(delta * j));
+        }
+
+        tables.c = c;
+
+        return true;
+    }
+
+
+    static void destroy_tables(DctTables& tables)
+    {
+        free_aligned(tables.c);
+
+        tables.c = 0;
+    }
+
+
+    static bool create_tables(FixedTables& tables, u32 size)
+    {
+        auto tw = (i16*)alloc_aligned(fixed_tw_size(size / 2) * sizeof(i16));
+        if (!tw)
+        {
+            return false;
+        }
+
+        fixed_create_twiddles(size / 2, tw);
+
+        tables.tw = tw;
+
+        return true;
+    }
+
+
+    static void destroy_tables(FixedTables& tables)
+    {
+        free_aligned(tables.tw);
+
+        tables.tw = 0;
+    }
+
+
+    // tw[j] = exp(-2 pi i j / n), j < n
+    static void create_twiddles(f32* tw, u32 n)
+    {
+        constexpr f64 TP = 2.0 * num::PI;
+
+        for (u32 j = 0; j < n; j++)
+        {
+            tw[2 * j] = (f32)std::cos(TP * j / n);
+            tw[2 * j + 1] = (f32)-std::sin(TP * j / n);
+        }
+    }
+
+
+    // not cached, one set per MixedRadix plan
+    static bool create_tables(MixedTables& tables, u32 size)
+    {
+        tables = MixedTables();
+
+        auto nc = size % 2 ? size : size / 2;
+        auto mixed = mixed_factors(nc, tables);
+
+        u32 nb = 0;
+        if (!mixed)
+        {
+            // linear convolution of 2 nc - 1 points
+            nb = 1;
+            while (nb < 2 * nc - 1)
+            {
+                nb *= 2;
+            }
+        }
+
+        // tw, ws, work, chirp, chirp_fft, tw_b, work_b
+        auto n_values = 2 * nc + (nc + 2) + 4 * nc + 2 * nc + 8 * (u64)nb;
+
+        auto values = (f32*)alloc_aligned(n_values * sizeof(f32));
+        if (!values)
+        {
+            return false;
+        }
+
+        tables.nc = nc;
+        tables.tw = values;
+        tables.ws = tables.tw + 2 * nc;
+        tables.work = tables.ws + nc + 2;
+
+        create_twiddles(tables.tw, nc);
+
+        constexpr f64 TP = 2.0 * num::PI;
+
+        for (u32 k = 0; k <= nc / 2; k++)
+        {
+            tables.ws[2 * k] = (f32)std::cos(TP * k / size);
+            tables.ws[2 * k + 1] = (f32)std::sin(TP * k / size);
+        }
+
+        if (mixed)
+        {
+            return true;
+        }
+
+        tables.nb = nb;
+        tables.chirp = tables.work + 4 * nc;
+        tables.chirp_fft = tables.chirp + 2 * nc;
+        tables.tw_b = tables.chirp_fft + 2 * nb;
+        tables.work_b = tables.tw_b + 2 * nb;
+
+        create_twiddles(tables.tw_b, nb);
+
+        // j^2 mod 2 nc keeps the angle small
+        auto b = tables.chirp;
+        for (u32 j = 0; j < nc; j++)
+        {
+            auto a = num::PI * (f64)(((u64)j * j) % (2 * nc)) / nc;
+            b[2 * j] = (f32)std::cos(a);
+            b[2 * j + 1] = (f32)std::sin(a);
+        }
+
+        // b_j at j and nb - j, the convolution wraps around
+        auto c = tables.work_b;
+        for (u32 j = 0; j < 2 * nb; j++)
+        {
+            c[j] = 0.0f;
+        }
+
+        for (u32 j = 0; j < nc; j++)
+        {
+            c[2 * j] = b[2 * j];
+            c[2 * j + 1] = b[2 * j + 1];
+
+            if (j)
+            {
+                c[2 * (nb - j)] = b[2 * j];
+                c[2 * (nb - j) + 1] = b[2 * j + 1];
+            }
+        }
+
+        auto cf = stockham_cft<4, false>(nb, c, tables.work_b + 2 * nb, c, tables.tw_b);
+
+        auto scale = 1.0f / nb;
+        for (u32 j = 0; j < 2 * nb; j++)
+        {
+            tables.chirp_fft[j] = cf[j] * scale;
+        }
+
+        return true;
+    }
+
+
+    static void destroy_tables(MixedTables& tables)
+    {
+        free_aligned(tables.tw);
+
+        tables = MixedTables();
+    }
+}
+}
+
+
+/* parallel */
+
+namespace fft
+{
+namespace internal
+{
+    static ThreadPool thread_pool;
+
+
+    // cftrec4/cfttree as an explicit tree
+    // a node of size n does its cftmdl1 (isplt 1) or cftmdl2 (isplt 0) pass, then its 4 quarters
+    // with isplt 1, 0, 1, isplt. Nodes of 512 or less finish in cftleaf
+    // The root pass is cftf1st/cftb1st and the root isplt is 1
+
+    static void cft_node_mdl(int n, f32* a, int isplt, int nw, f32* w)
+    {
+        if (isplt)
+        {
+            cftmdl1(n, a, &w[nw - (n >> 1)]);
+        }
+        else
+        {
+            cftmdl2(n, a, &w[nw - n]);
+        }
+    }
+
+
+    static void cft_node(int n, f32* a, int isplt, int nw, f32* w)
+    {
+        cft_node_mdl(n, a, isplt, nw, w);
+
+        if (n <= 512)
+        {
+            cftleaf(n, isplt, a, nw, w);
+            return;
+        }
+
+        auto m = n >> 2;
+
+        cft_node(m, a, 1, nw, w);
+        cft_node(m, a + m, 0, nw, w);
+        cft_node(m, a + 2 * m, 1, nw, w);
+        cft_node(m, a + 3 * m, isplt, nw, w);
+    }
+
+
+    // isplt of node id at depth, counting left to right
+    static int cft_node_isplt(u32 id, u32 depth)
+    {
+        int isplt = 1;
+
+        for (u32 d = depth; d > 0; d--)
+        {
+            auto q = (id >> (2 * (d - 1))) & 3;
+            isplt = (q == 1) ? 0 : (q == 3 ? isplt : 1);
+        }
+
+        return isplt;
+    }
+
+
+    // same result as cftrec4(n, a, nw, w)
+    // levels above split_depth run their cftmdl passes one level at a time, one task per node
+    // then every node at split_depth runs its whole subtree as one task
+    static void cftrec4_parallel(int n, f32* a, int nw, f32* w)
+    {
+        u32 split_depth = 1;
+        while ((1u << (2 * split_depth)) < 4 * thread_pool.n_threads() && (n >> (2 * (split_depth + 1))) >= 256)
+        {
+            split_depth++;
+        }
+
+        for (u32 d = 1; d < split_depth; d++)
+        {
+            auto m = n >> (2 * d);
+
+            thread_pool.for_each(1u << (2 * d), [&](u32 id)
+            {
+                cft_node_mdl(m, a + id * m, cft_node_isplt(id, d), nw, w);
+            });
+        }
+
+        auto m = n >> (2 * split_depth);
+
+        thread_pool.for_each(1u << (2 * split_depth), [&](u32 id)
+        {
+            cft_node(m, a + id * m, cft_node_isplt(id, split_depth), nw, w);
+        });
+    }
+
+
+    static void rdft_forward_parallel(int n, f32* a, int* ip, f32* w)
+    {
+        auto nw = ip[0];
+        auto nc = ip[1];
+
+        cftf1st(n, a, &w[nw - (n >> 2)]);
+        cftrec4_parallel(n, a, nw, w);
+        bitrv2(n, ip, a);
+
+        rftfsub(n, a, nc, w + nw);
+
+        auto xi = a[0] - a[1];
+        a[0] += a[1];
+        a[1] = xi;
+    }
+
+
+    static void rdft_inverse_parallel(int n, f32* a, int* ip, f32* w)
+    {
+        auto nw = ip[0];
+        auto nc = ip[1];
+
+        a[1] = 0.5f * (a[0] - a[1]);
+        a[0] -= a[1];
+
+        rftbsub(n, a, nc, w + nw);
+
+        cftb1st(n, a, &w[nw - (n >> 2)]);
+        cftrec4_parallel(n, a, nw, w);
+        bitrv2conj(n, ip, a);
+    }
+
+
+    static void spectrum_parallel(f32 const* src, f32* dst, u32 len, SpectrumParams const& params)
+    {
+        constexpr u32 block = 1u << 14;
+
+        auto n_blocks = (len + block - 1) / block;
+
+        thread_pool.for_each(n_blocks, [&](u32 id)
+        {
+            auto begin = id * block;
+            auto end = num::min(begin + block, len);
+
+            spectrum_kernel(src + 2 * begin, dst + begin, end - begin, params);
+        });
+    }
+
+
+    static void start_thread_pool()
+    {
+        std::lock_guard<std::mutex> lock(plan_mutex);
+
+        if (!thread_pool.is_running())
+        {
+            thread_pool.start(0);
+        }
+    }
+}
+}
+
+
+/* engine dispatch */
+
+namespace fft
+{
+namespace internal
+{
+    static bool use_fourstep(Plan const& plan)
+    {
+        return plan.engine == Engine::FourStep && plan.size >= FOURSTEP_MIN_SIZE;
+    }
+
+
+    static bool use_mixed(Plan const& plan)
+    {
+        return plan.engine == Engine::MixedRadix;
+    }
+
+
+    static bool use_fftg(Plan const& plan)
+    {
+        return (plan.engine == Engine::Fft4g || plan.engine == Engine::Fft8g) && plan.size > CODELET_MAX_SIZE;
+    }
+
+
+    static bool use_stockham(Plan const& plan)
+    {
+        return plan.engine != Engine::Ooura && plan.size > CODELET_MAX_SIZE && !use_fourstep(plan) && !use_mixed(plan) && !use_fftg(plan);
+    }
+
+
+    // only Ooura and FourStep have a parallel path, the other engines run their own serial transform
+    static bool use_parallel(Plan const& plan)
+    {
+        return plan.size >= PARALLEL_MIN_SIZE && (plan.engine == Engine::Ooura || use_fourstep(plan));
+    }
+
+
+    // func(begin, end) over n_items, split in a few tasks per thread
+    // tasks start at multiples of align
+    template <class FUNC>
+    static void fourstep_for_each(bool parallel, u32 n_items, FUNC const& func, u32 align = 1)
+    {
+        auto n_tasks = parallel ? num::min(n_items, 4 * thread_pool.n_threads()) : 1u;
+        auto per_task = (n_items + n_tasks - 1) / n_tasks;
+        per_task = (per_task + align - 1) / align * align;
+        n_tasks = (n_items + per_task - 1) / per_task;
+
+        auto task = [&](u32 id)
+        {
+            auto begin = id * per_task;
+            auto end = num::min(begin + per_task, n_items);
+            if (begin < end)
+            {
+                func(begin, end);
+            }
+        };
+
+        if (parallel)
+        {
+            thread_pool.for_each(n_tasks, task);
+        }
+        else
+        {
+            task(0);
+        }
+    }
+
+
+    static void fourstep_transpose(f32 const* src, f32* dst, u32 rows, u32 cols, bool parallel)
+    {
+        constexpr u32 T = FOURSTEP_TILE;
+
+        fourstep_for_each(parallel, rows / T, [&](u32 begin, u32 end)
+        {
+            fourstep_transpose(src, dst, rows, cols, begin * T, end * T);
+        });
+    }
+
+
+    // split and join tasks cover whole vector blocks, the results do not depend on the task count
+    static constexpr u32 SPLIT_ALIGN = 16;
+
+
+    static FourStepTwiddles fourstep_twiddles(Plan const& plan)
+    {
+        FourStepTwiddles tt;
+        tt.lo_bits = (plan_exp(plan.size / 2) + 1) / 2;
+        tt.lo = plan.tw_lo;
+        tt.hi = plan.tw_hi;
+
+        return tt;
+    }
+
+
+    static void fourstep_forward(Plan const& plan, f32 const* src, f32* dst, bool parallel)
+    {
+        auto& k = fourstep_kernels;
+
+        auto nc = plan.size / 2;
+        auto work = plan.work;
+        auto tt = fourstep_twiddles(plan);
+
+        u32 n1, n2;
+        fourstep_shape(nc, n1, n2);
+
+        fourstep_transpose(src, work, n1, n2, parallel);
+
+        fourstep_for_each(parallel, n2, [&](u32 begin, u32 end)
+        {
+            k.rows_forward(n1, work, begin, end, plan.tw, &tt);
+        });
+
+        fourstep_transpose(work, dst, n2, n1, parallel);
+
+        fourstep_for_each(parallel, n1, [&](u32 begin, u32 end)
+        {
+            k.rows_forward(n2, dst, begin, end, plan.tw2, 0);
+        });
+
+        fourstep_transpose(dst, work, n1, n2, parallel);
+
+        dst[0] = work[0] + work[1];
+        dst[1] = work[0] - work[1];
+
+        fourstep_for_each(parallel, nc / 2, [&](u32 begin, u32 end)
+        {
+            k.split(nc, work, dst, plan.ws, begin + 1, end + 1);
+        }, SPLIT_ALIGN);
+    }
+
+
+    static void fourstep_inverse(Plan const& plan, f32 const* src, f32* dst, bool parallel)
+    {
+        auto& k = fourstep_kernels;
+
+        auto nc = plan.size / 2;
+        auto work = plan.work;
+        auto tt = fourstep_twiddles(plan);
+
+        u32 n1, n2;
+        fourstep_shape(nc, n1, n2);
+
+        work[0] = 0.5f * (src[0] + src[1]);
+        work[1] = 0.5f * (src[0] - src[1]);
+
+        fourstep_for_each(parallel, nc / 2, [&](u32 begin, u32 end)
+        {
+            k.join(nc, src, work, plan.ws, begin + 1, end + 1);
+        }, SPLIT_ALIGN);
+
+        fourstep_transpose(work, dst, n1, n2, parallel);
+
+        fourstep_for_each(parallel, n2, [&](u32 begin, u32 end)
+        {
+            k.rows_inverse(n1, dst, begin, end, plan.tw, &tt);
+        });
+
+        fourstep_transpose(dst, work, n2, n1, parallel);
+
+        fourstep_for_each(parallel, n1, [&](u32 begin, u32 end)
+        {
+            k.rows_inverse(n2, work, begin, end, plan.tw2, 0);
+        });
+
+        fourstep_transpose(work, dst, n1, n2, parallel);
+    }
+
+
+    static void stockham_forward(Plan const& plan, f32 const* src, f32* dst)
+    {
+        auto f = stockham_forward_x4;
+
+    #ifdef FFT_SIMD_256
+        if (simd_bound >= cpu::SIMD::AVX2) { f = stockham_forward_x8_256; }
+    #endif
+    #ifdef FFT_SIMD_512
+        if (simd_bound >= cpu::SIMD::AVX512) { f = stockham_forward_x16_512; }
+    #endif
+
+        f(plan.size, src, dst, plan.work, plan.tw, plan.ws);
+    }
+
+
+    static void stockham_inverse(Plan const& plan, f32 const* src, f32* dst)
+    {
+        auto f = stockham_inverse_x4;
+
+    #ifdef FFT_SIMD_256
+        if (simd_bound >= cpu::SIMD::AVX2) { f = stockham_inverse_x8_256; }
+    #endif
+    #ifdef FFT_SIMD_512
+        if (simd_bound >= cpu::SIMD::AVX512) { f = stockham_inverse_x16_512; }
+    #endif
+
+        f(plan.size, src, dst, plan.work, plan.tw, plan.ws);
+    }
+
+
+    static void mixed_forward(Plan const& plan, f32 const* src, f32* dst)
+    {
+        auto f = mixed_forward_x4;
+
+    #ifdef FFT_SIMD_256
+        if (simd_bound >= cpu::SIMD::AVX2) { f = mixed_forward_x8_256; }
+    #endif
+    #ifdef FFT_SIMD_512
+        if (simd_bound >= cpu::SIMD::AVX512) { f = mixed_forward_x16_512; }
+    #endif
+
+        f(plan.size, *plan.mixed, src, dst);
+    }
+
+
+    static void mixed_inverse(Plan const& plan, f32 const* src, f32* dst)
+    {
+        auto f = mixed_inverse_x4;
+
+    #ifdef FFT_SIMD_256
+        if (simd_bound >= cpu::SIMD::AVX2) { f = mixed_inverse_x8_256; }
+    #endif
+    #ifdef FFT_SIMD_512
+        if (simd_bound >= cpu::SIMD::AVX512) { f = mixed_inverse_x16_512; }
+    #endif
+
+        f(plan.size, *plan.mixed, src, dst);
+    }
+
+
+    // in place only
+    static void fftg_forward(Plan const& plan, f32 const* src, f32* dst)
+    {
+        if (src != dst)
+        {
+            std::memcpy(dst, src, plan.size * sizeof(f32));
+        }
+
+        if (plan.engine == Engine::Fft8g)
+        {
+            fft8g::rdft_forward((int)plan.size, dst, plan.ip_g, plan.w_g);
+        }
+        else
+        {
+            fft4g::rdft_forward((int)plan.size, dst, plan.ip_g, plan.w_g);
+        }
+    }
+
+
+    static void fftg_inverse(Plan const& plan, f32 const* src, f32* dst)
+    {
+        if (src != dst)
+        {
+            std::memcpy(dst, src, plan.size * sizeof(f32));
+        }
+
+        if (plan.engine == Engine::Fft8g)
+        {
+            fft8g::rdft_inverse((int)plan.size, dst, plan.ip_g, plan.w_g);
+        }
+        else
+        {
+            fft4g::rdft_inverse((int)plan.size, dst, plan.ip_g, plan.w_g);
+        }
+    }
+
+
+    static void forward_to(Plan const& plan, f32 const* src, f32* dst)
+    {
+        if (use_mixed(plan))
+        {
+            mixed_forward(plan, src, dst);
+        }
+        else if (use_fourstep(plan))
+        {
+            fourstep_forward(plan, src, dst, false);
+        }
+        else if (use_fftg(plan))
+        {
+            fftg_forward(plan, src, dst);
+        }
+        else if (use_stockham(plan))
+        {
+            stockham_forward(plan, src, dst);
+        }
+        else
+        {
+            forward_to(plan.size, src, dst, plan.ip, plan.w);
+        }
+    }
+
+
+    static void inverse_to(Plan const& plan, f32 const* src, f32* dst)
+    {
+        if (use_mixed(plan))
+        {
+            mixed_inverse(plan, src, dst);
+        }
+        else if (use_fourstep(plan))
+        {
+            fourstep_inverse(plan, src, dst, false);
+        }
+        else if (use_fftg(plan))
+        {
+            fftg_inverse(plan, src, dst);
+        }
+        else if (use_stockham(plan))
+        {
+            stockham_inverse(plan, src, dst);
+        }
+        else
+        {
+            inverse_to(plan.size, src, dst, plan.ip, plan.w);
+        }
+    }
+
+
+    static void forward_parallel(Plan const& plan, f32* buffer)
+    {
+        if (use_fourstep(plan))
+        {
+            fourstep_forward(plan, buffer, buffer, true);
+        }
+        else
+        {
+            rdft_forward_parallel((int)plan.size, buffer, plan.ip, plan.w);
+        }
+    }
+
+
+    static void inverse_parallel(Plan const& plan, f32* buffer)
+    {
+        if (use_fourstep(plan))
+        {
+            fourstep_inverse(plan, buffer, buffer, true);
+        }
+        else
+        {
+            rdft_inverse_parallel((int)plan.size, buffer, plan.ip, plan.w);
+        }
+    }
+
+
+    // bins 1 to n_bins, the last bin of an odd size is split between buffer[size - 1] and buffer[1]
+    static void spectrum_bins(Plan const& plan, f32 const* buffer, f32* bins, SpectrumParams const& params)
+    {
+        auto n = plan.size;
+
+        if (n % 2 == 0)
+        {
+            spectrum_kernel(buffer + 2, bins, plan.n_bins, params);
+            return;
+        }
+
+        spectrum_kernel(buffer + 2, bins, plan.n_bins - 1, params);
+
+        f32 last[] = { buffer[n - 1], buffer[1] };
+        spectrum_scalar(last, bins + plan.n_bins - 1, 1, params);
+    }
+}
+}
+
+
+/* plan api */
+
+namespace fft
+{
+    bool create_plan(Plan& plan, u32 size)
+    {
+        // every field, the plan may be in memory that was never constructed
+        plan = Plan{};
+
+        if (size < PLAN_MIN_SIZE || size > PLAN_MAX_SIZE)
+        {
+            return false;
+        }
+
+        if (!num::is_power_of_2(size))
+        {
+            auto mixed = (internal::MixedTables*)alloc_aligned(sizeof(internal::MixedTables));
+            if (!mixed || !internal::create_tables(*mixed, size))
+            {
+                free_aligned(mixed);
+                return false;
+            }
+
+            plan.size = size;
+            plan.n_bins = internal::fft_bin_size(size);
+            plan.n_full_bins = internal::fft_full_bin_size(size);
+            plan.engine = Engine::MixedRadix;
+            plan.mixed = mixed;
+
+            return true;
+        }
+
+        auto& tables = internal::plan_tables[internal::plan_exp(size)];
+
+        {
+            std::lock_guard<std::mutex> lock(internal::plan_mutex);
+
+            if (!tables.ip && !internal::create_tables(tables, size))
+            {
+                return false;
+            }
+        }
+
+        plan.size = size;
+        plan.n_bins = internal::fft_bin_size(size);
+        plan.n_full_bins = internal::fft_full_bin_size(size);
+        plan.ip = tables.ip;
+        plan.w = tables.w;
+
+        return true;
+    }
+
+
+    bool create_plan(Plan& plan, u32 size, Engine engine)
+    {
+        if (!create_plan(plan, size))
+        {
+            return false;
+        }
+
+        if (engine == Engine::Ooura || plan.engine == Engine::MixedRadix)
+        {
+            return true;
+        }
+
+        using namespace internal;
+
+        if (engine == Engine::Fft4g || engine == Engine::Fft8g)
+        {
+            auto& tables = (engine == Engine::Fft8g ? fft8g_tables : fft4g_tables)[plan_exp(size)];
+
+            std::lock_guard<std::mutex> lock(plan_mutex);
+
+            if (!tables.ip && !create_tables(tables, size, engine))
+            {
+                return false;
+            }
+
+            plan.engine = engine;
+            plan.ip_g = tables.ip;
+            plan.w_g = tables.w;
+
+            return true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(plan_mutex);
+
+            if (engine == Engine::FourStep && size >= FOURSTEP_MIN_SIZE)
+            {
+                u32 n1, n2;
+                fourstep_shape(size / 2, n1, n2);
+
+                auto& tables = fourstep_tables[plan_exp(size)];
+                auto& rows1 = stockham_tables[plan_exp(2 * n1)];
+                auto& rows2 = stockham_tables[plan_exp(2 * n2)];
+
+                if ((!tables.ws && !create_tables(tables, size)) ||
+                    (!rows1.tw && !create_tables(rows1, 2 * n1)) ||
+                    (!rows2.tw && !create_tables(rows2, 2 * n2)))
+                {
+                    return false;
+                }
+
+                plan.tw = rows1.tw;
+                plan.tw2 = rows2.tw;
+                plan.ws = tables.ws;
+                plan.tw_lo = tables.lo;
+                plan.tw_hi = tables.hi;
+            }
+            else
+            {
+                auto& tables = stockham_tables[plan_exp(size)];
+
+                if (!tables.tw && !create_tables(tables, size))
+                {
+                    return false;
+                }
+
+                plan.tw = tables.tw;
+                plan.ws = tables.ws;
+            }
+        }
+
+        auto work = (f32*)alloc_aligned(size * sizeof(f32));
+        if (!work)
+        {
+            return false;
+        }
+
+        plan.engine = engine;
+        plan.work = work;
+
+        return true;
+    }
+
+
+    void destroy_plan(Plan& plan)
+    {
+        free_aligned(plan.work);
+
+        if (plan.mixed)
+        {
+            internal::destroy_tables(*plan.mixed);
+            free_aligned(plan.mixed);
+        }
+
+        plan.engine = Engine::Ooura;
+        plan.tw = 0;
+        plan.ws = 0;
+        plan.work = 0;
+        plan.tw2 = 0;
+        plan.tw_lo = 0;
+        plan.tw_hi = 0;
+        plan.mixed = 0;
+        plan.ip_g = 0;
+        plan.w_g = 0;
+    }
+
+
+    void destroy_plans()
+    {
+        std::lock_guard<std::mutex> lock(internal::plan_mutex);
+
+        for (auto& tables : internal::plan_tables)
+        {
+            internal::destroy_tables(tables);
+        }
+
+        for (auto& tables : internal::batch_tables)
+        {
+            internal::destroy_tables(tables);
+        }
+
+        for (auto& tables : internal::stockham_tables)
+        {
+            internal::destroy_tables(tables);
+        }
+
+        for (auto& tables : internal::fourstep_tables)
+        {
+            internal::destroy_tables(tables);
+        }
+
+        for (auto& tables : internal::dct_tables)
+        {
+            internal::destroy_tables(tables);
+        }
+
+        for (auto& tables : internal::fft4g_tables)
+        {
+            internal::destroy_tables(tables);
+        }
+
+        for (auto& tables : internal::fft8g_tables)
+        {
+            internal::destroy_tables(tables);
+        }
+
+        for (auto& tables : internal::fixed_tables)
+        {
+            internal::destroy_tables(tables);
+        }
+
+        if (internal::tables_map)
+        {
+            munmap(internal::tables_map, internal::tables_map_bytes);
+
+            internal::tables_map = 0;
+            internal::tables_map_bytes = 0;
+        }
+    }
+
+
+    cpu::SIMD simd()
+    {
+        return internal::simd_bound;
+    }
+
+
+    cpu::SIMD set_simd(cpu::SIMD simd)
+    {
+        if (simd > cpu::simd_level())
+        {
+            simd = cpu::simd_level();
+        }
+
+        internal::simd_bound = internal::bind_kernels(simd);
+
+        return internal::simd_bound;
+    }
+
+
+    void forward(Plan const& plan, f32* buffer, f32* bins)
+    {
+        internal::forward_to(plan, buffer, buffer);
+        internal::spectrum_bins(plan, buffer, bins, internal::SpectrumParams{});
+    }
+
+
+    void forward(Plan const& plan, f32* buffer, f32* bins, SpectrumOptions const& options)
+    {
+        internal::forward_to(plan, buffer, buffer);
+
+        spectrum(plan, buffer, bins, options);
+    }
+
+
+    void forward(Plan const& plan, f32* buffer)
+    {
+        internal::forward_to(plan, buffer, buffer);
+    }
+
+
+    void forward_to(Plan const& plan, f32 const* src, f32* dst)
+    {
+        internal::forward_to(plan, src, dst);
+    }
+
+
+    void forward_to(Plan const& plan, f32 const* src, f32* dst, f32* bins)
+    {
+        internal::forward_to(plan, src, dst);
+        internal::spectrum_bins(plan, dst, bins, internal::SpectrumParams{});
+    }
+
+
+    void inverse_to(Plan const& plan, f32 const* src, f32* dst)
+    {
+        internal::inverse_to(plan, src, dst);
+    }
+
+
+    void spectrum(Plan const& plan, f32 const* buffer, f32* bins, SpectrumOptions const& options)
+    {
+        auto params = internal::spectrum_params(plan.size, options);
+
+        internal::spectrum_bins(plan, buffer, bins, params);
+    }
+
+
+    void complex_bins(Plan const& plan, f32 const* buffer, f32* bins)
+    {
+        auto n = plan.size;
+
+        bins[0] = buffer[0];
+        bins[1] = 0.0f;
+
+        if (n % 2)
+        {
+            internal::complex_kernel(buffer + 2, bins + 2, plan.n_bins - 1);
+
+            bins[n - 1] = buffer[n - 1];
+            bins[n] = -buffer[1];
+            return;
+        }
+
+        internal::complex_kernel(buffer + 2, bins + 2, plan.n_bins);
+
+        bins[n] = buffer[1];
+        bins[n + 1] = 0.0f;
+    }
+
+
+    void split_bins(Plan const& plan, f32 const* buffer, f32* re, f32* im)
+    {
+        auto n = plan.size;
+
+        re[0] = buffer[0];
+        im[0] = 0.0f;
+
+        if (n % 2)
+        {
+            internal::split_kernel(buffer + 2, re + 1, im + 1, plan.n_bins - 1);
+
+            re[n / 2] = buffer[n - 1];
+            im[n / 2] = -buffer[1];
+            return;
+        }
+
+        internal::split_kernel(buffer + 2, re + 1, im + 1, plan.n_bins);
+
+        re[n / 2] = buffer[1];
+        im[n / 2] = 0.0f;
+    }
+
+
+    void full_spectrum(Plan const& plan, f32 const* buffer, f32* bins, SpectrumOptions const& options)
+    {
+        auto n = plan.size;
+
+        auto params = internal::spectrum_params(n, options);
+
+        internal::spectrum_bins(plan, buffer, bins + 1, params);
+
+        // DC and Nyquist have no mirror image to fold into the single sided spectrum
+        if (options.mode == Spectrum::Normalized)
+        {
+            params.scale *= 0.5f;
+        }
+
+        f32 dc[] = { buffer[0], 0.0f };
+        internal::spectrum_scalar(dc, bins, 1, params);
+
+        if (n % 2 == 0)
+        {
+            f32 ny[] = { buffer[1], 0.0f };
+            internal::spectrum_scalar(ny, bins + n / 2, 1, params);
+        }
+    }
+
+
+    void forward_complex(Plan const& plan, f32* buffer, f32* bins)
+    {
+        forward(plan, buffer);
+        complex_bins(plan, buffer, bins);
+    }
+
+
+    void forward_split(Plan const& plan, f32* buffer, f32* re, f32* im)
+    {
+        forward(plan, buffer);
+        split_bins(plan, buffer, re, im);
+    }
+
+
+    void forward_full(Plan const& plan, f32* buffer, f32* bins, SpectrumOptions const& options)
+    {
+        forward(plan, buffer);
+        full_spectrum(plan, buffer, bins, options);
+    }
+
+
+    f32 window_gain(f32 const* window, u32 size)
+    {
+        f64 sum = 0.0;
+        for (u32 i = 0; i < size; i++)
+        {
+            sum += window[i];
+        }
+
+        return (f32)(sum / size);
+    }
+
+
+    void inverse(Plan const& plan, f32* buffer)
+    {
+        internal::inverse_to(plan, buffer, buffer);
+    }
+
+
+    void start_threads(u32 n_threads)
+    {
+        std::lock_guard<std::mutex> lock(internal::plan_mutex);
+
+        internal::thread_pool.start(n_threads);
+    }
+
+
+    void stop_threads()
+    {
+        std::lock_guard<std::mutex> lock(internal::plan_mutex);
+
+        internal::thread_pool.stop();
+    }
+
+
+    void forward_parallel(Plan const& plan, f32* buffer, f32* bins)
+    {
+        if (!internal::use_parallel(plan))
+        {
+            forward(plan, buffer, bins);
+            return;
+        }
+
+        internal::start_thread_pool();
+
+        internal::forward_parallel(plan, buffer);
+        internal::spectrum_parallel(buffer + 2, bins, plan.n_bins, internal::SpectrumParams{});
+    }
+
+
+    void forward_parallel(Plan const& plan, f32* buffer, f32* bins, SpectrumOptions const& options)
+    {
+        if (!internal::use_parallel(plan))
+        {
+            forward(plan, buffer, bins, options);
+            return;
+        }
+
+        internal::start_thread_pool();
+
+        internal::forward_parallel(plan, buffer);
+        internal::spectrum_parallel(buffer + 2, bins, plan.n_bins, internal::spectrum_params(plan.size, options));
+    }
+
+
+    void forward_parallel(Plan const& plan, f32* buffer)
+    {
+        if (!internal::use_parallel(plan))
+        {
+            forward(plan, buffer);
+            return;
+        }
+
+        internal::start_thread_pool();
+
+        internal::forward_parallel(plan, buffer);
+    }
+
+
+    void inverse_parallel(Plan const& plan, f32* buffer)
+    {
+        if (!internal::use_parallel(plan))
+        {
+            inverse(plan, buffer);
+            return;
+        }
+
+        internal::start_thread_pool();
+
+        internal::inverse_parallel(plan, buffer);
+    }
+
+
+    bool create_buffer(WorkBuffer& work, u32 size)
+    {
+        work.buffer = 0;
+        work.bins = 0;
+
+        if (!create_plan(work.plan, size))
+        {
+            return false;
+        }
+
+        auto& plan = work.plan;
+
+        auto buffer = (f32*)alloc_aligned(plan.size * sizeof(f32));
+        auto bins = (f32*)alloc_aligned(plan.n_bins * sizeof(f32));
+        if (!buffer || !bins)
+        {
+            free_aligned(buffer);
+            free_aligned(bins);
+            return false;
+        }
+
+        for (u32 i = 0; i < plan.size; i++) { buffer[i] = 0.0f; }
+        for (u32 i = 0; i < plan.n_bins; i++) { bins[i] = 0.0f; }
+
+        work.buffer = buffer;
+        work.bins = bins;
+
+        return true;
+    }
+
+
+    void destroy_buffer(WorkBuffer& work)
+    {
+        destroy_plan(work.plan);
+
+        free_aligned(work.buffer);
+        free_aligned(work.bins);
+
+        work.buffer = 0;
+        work.bins = 0;
+    }
+}
+
+/* batch api */
+
+namespace fft
+{
+    bool create_batch_plan(BatchPlan& plan, u32 size, u32 n_channels)
+    {
+        plan.size = 0;
+        plan.n_bins = 0;
+        plan.n_channels = 0;
+        plan.rev = 0;
+        plan.tw = 0;
+        plan.ws = 0;
+
+        if (!num::is_power_of_2(size) || size < PLAN_MIN_SIZE || size > PLAN_MAX_SIZE)
+        {
+            return false;
+        }
+
+        if (n_channels != 4 && n_channels != 8 && n_channels != 16)
+        {
+            return false;
+        }
+
+        auto& tables = internal::batch_tables[internal::plan_exp(size)];
+
+        {
+            std::lock_guard<std::mutex> lock(internal::plan_mutex);
+
+            if (!tables.rev && !internal::create_tables(tables, size))
+            {
+                return false;
+            }
+        }
+
+        plan.size = size;
+        plan.n_bins = internal::fft_bin_size(size);
+        plan.n_channels = n_channels;
+        plan.rev = tables.rev;
+        plan.tw = tables.tw;
+        plan.ws = tables.ws;
+
+        return true;
+    }
+
+
+    void forward(BatchPlan const& plan, f32* buffer, f32* bins)
+    {
+        using namespace internal;
+
+        auto f = batch_forward_x4;
+
+        switch (plan.n_channels)
+        {
+        case 8:
+            f = batch_forward_x8;
+        #ifdef FFT_SIMD_256
+            if (simd_bound >= cpu::SIMD::AVX2) { f = batch_forward_x8_256; }
+        #endif
+            break;
+
+        case 16:
+            f = batch_forward_x16;
+        #ifdef FFT_SIMD_256
+            if (simd_bound >= cpu::SIMD::AVX2) { f = batch_forward_x16_256; }
+        #endif
+        #ifdef FFT_SIMD_512
+            if (simd_bound >= cpu::SIMD::AVX512) { f = batch_forward_x16_512; }
+        #endif
+            break;
+
+        default:
+            break;
+        }
+
+        f(plan.size, buffer, plan.rev, plan.tw, plan.ws, bins);
+    }
+
+
+    void forward(BatchPlan const& plan, f32* buffer)
+    {
+        forward(plan, buffer, (f32*)0);
+    }
+
+
+    void interleave(f32* const* frames, f32* buffer, u32 size, u32 n_channels)
+    {
+        for (u32 i = 0; i < size; i++)
+        {
+            for (u32 c = 0; c < n_channels; c++)
+            {
+                buffer[i * n_channels + c] = frames[c][i];
+            }
+        }
+    }
+
+
+    void deinterleave(f32 const* buffer, f32* const* frames, u32 size, u32 n_channels)
+    {
+        using namespace internal;
+
+        // an empty capture chunk may come with null pointers
+        if (!size)
+        {
+            return;
+        }
+
+        if (n_channels == 1)
+        {
+            std::memcpy(frames[0], buffer, size * sizeof(f32));
+            return;
+        }
+
+        auto f = deinterleave_scalar;
+
+    #ifdef FFT_SIMD_256
+        if (simd_bound >= cpu::SIMD::AVX2)
+        {
+            f = deinterleave_gather_256;
+
+            if (n_channels == 2) { f = deinterleave_x2_256; }
+            else if (n_channels % 8 == 0) { f = deinterleave_x8_256; }
+        }
+    #endif
+
+        f(buffer, frames, size, n_channels);
+    }
+}
+
+
+/* complex api */
+
+namespace fft
+{
+namespace internal
+{
+    static void stockham_cft_forward(ComplexPlan const& plan, f32 const* src, f32* dst)
+    {
+        auto f = stockham_cft_forward_x4;
+
+    #ifdef FFT_SIMD_256
+        if (simd_bound >= cpu::SIMD::AVX2) { f = stockham_cft_forward_x8_256; }
+    #endif
+    #ifdef FFT_SIMD_512
+        if (simd_bound >= cpu::SIMD::AVX512) { f = stockham_cft_forward_x16_512; }
+    #endif
+
+        f(plan.size, src, dst, plan.work, plan.tw);
+    }
+
+
+    static void stockham_cft_inverse(ComplexPlan const& plan, f32 const* src, f32* dst)
+    {
+        auto f = stockham_cft_inverse_x4;
+
+    #ifdef FFT_SIMD_256
+        if (simd_bound >= cpu::SIMD::AVX2) { f = stockham_cft_inverse_x8_256; }
+    #endif
+    #ifdef FFT_SIMD_512
+        if (simd_bound >= cpu::SIMD::AVX512) { f = stockham_cft_inverse_x16_512; }
+    #endif
+
+        f(plan.size, src, dst, plan.work, plan.tw);
+    }
+}
+
+
+    bool create_complex_plan(ComplexPlan& plan, u32 size)
+    {
+        plan.size = 0;
+        plan.engine = Engine::Ooura;
+        plan.ip = 0;
+        plan.w = 0;
+        plan.tw = 0;
+        plan.work = 0;
+
+        if (!num::is_power_of_2(size) || size < PLAN_MIN_SIZE / 2 || size > PLAN_MAX_SIZE / 2)
+        {
+            return false;
+        }
+
+        auto& tables = internal::plan_tables[internal::plan_exp(2 * size)];
+
+        {
+            std::lock_guard<std::mutex> lock(internal::plan_mutex);
+
+            if (!tables.ip && !internal::create_tables(tables, 2 * size))
+            {
+                return false;
+            }
+        }
+
+        plan.size = size;
+        plan.ip = tables.ip;
+        plan.w = tables.w;
+
+        return true;
+    }
+
+
+    bool create_complex_plan(ComplexPlan& plan, u32 size, Engine engine)
+    {
+        if (!create_complex_plan(plan, size))
+        {
+            return false;
+        }
+
+        if (engine == Engine::Ooura)
+        {
+            return true;
+        }
+
+        auto& tables = internal::stockham_tables[internal::plan_exp(2 * size)];
+
+        {
+            std::lock_guard<std::mutex> lock(internal::plan_mutex);
+
+            if (!tables.tw && !internal::create_tables(tables, 2 * size))
+            {
+                return false;
+            }
+        }
+
+        auto work = (f32*)alloc_aligned(2 * size * sizeof(f32));
+        if (!work)
+        {
+            return false;
+        }
+
+        plan.engine = Engine::Stockham;
+        plan.tw = tables.tw;
+        plan.work = work;
+
+        return true;
+    }
+
+
+    void destroy_complex_plan(ComplexPlan& plan)
+    {
+        free_aligned(plan.work);
+
+        plan.engine = Engine::Ooura;
+        plan.tw = 0;
+        plan.work = 0;
+    }
+
+
+    void forward(ComplexPlan const& plan, f32* buffer)
+    {
+        forward_to(plan, buffer, buffer);
+    }
+
+
+    void inverse(ComplexPlan const& plan, f32* buffer)
+    {
+        inverse_to(plan, buffer, buffer);
+    }
+
+
+    void forward_to(ComplexPlan const& plan, f32 const* src, f32* dst)
+    {
+        if (plan.engine == Engine::Stockham)
+        {
+            internal::stockham_cft_forward(plan, src, dst);
+            return;
+        }
+
+        // cftbsub has no out-of-place first pass
+        if (src != dst)
+        {
+            std::memcpy(dst, src, 2 * plan.size * sizeof(f32));
+        }
+
+        internal::cdft_forward((int)(2 * plan.size), dst, plan.ip, plan.w);
+    }
+
+
+    void inverse_to(ComplexPlan const& plan, f32 const* src, f32* dst)
+    {
+        if (plan.engine == Engine::Stockham)
+        {
+            internal::stockham_cft_inverse(plan, src, dst);
+            return;
+        }
+
+        internal::cdft_inverse_src((int)(2 * plan.size), src, dst, plan.ip, plan.w);
+    }
+}
+
+
+/* dct api */
+
+namespace fft
+{
+    bool create_dct_plan(DctPlan& plan, u32 size)
+    {
+        plan.size = 0;
+        plan.ip = 0;
+        plan.w = 0;
+        plan.c = 0;
+        plan.work = 0;
+
+        if (!num::is_power_of_2(size) || size < PLAN_MIN_SIZE || size > PLAN_MAX_SIZE)
+        {
+            return false;
+        }
+
+        auto exp = internal::plan_exp(size);
+        auto& tables = internal::plan_tables[exp];
+        auto& dct = internal::dct_tables[exp];
+
+        {
+            std::lock_guard<std::mutex> lock(internal::plan_mutex);
+
+            if (!tables.ip && !internal::create_tables(tables, size))
+            {
+                return false;
+            }
+
+            if (!dct.c && !internal::create_tables(dct, size))
+            {
+                return false;
+            }
+        }
+
+        auto work = (f32*)alloc_aligned((size / 2 + 1) * sizeof(f32));
+        if (!work)
+        {
+            return false;
+        }
+
+        plan.size = size;
+        plan.ip = tables.ip;
+        plan.w = tables.w;
+        plan.c = dct.c;
+        plan.work = work;
+
+        return true;
+    }
+
+
+    void destroy_dct_plan(DctPlan& plan)
+    {
+        free_aligned(plan.work);
+
+        plan.size = 0;
+        plan.work = 0;
+    }
+
+
+    void dct2(DctPlan const& plan, f32* buffer)
+    {
+        internal::ddct_forward((int)plan.size, buffer, plan.ip, plan.w, plan.c);
+    }
+
+
+    void dct3(DctPlan const& plan, f32* buffer)
+    {
+        internal::ddct_inverse((int)plan.size, buffer, plan.ip, plan.w, plan.c);
+    }
+
+
+    void dst2(DctPlan const& plan, f32* buffer)
+    {
+        internal::ddst_forward((int)plan.size, buffer, plan.ip, plan.w, plan.c);
+    }
+
+
+    void dst3(DctPlan const& plan, f32* buffer)
+    {
+        internal::ddst_inverse((int)plan.size, buffer, plan.ip, plan.w, plan.c);
+    }
+
+
+    void dct1(DctPlan const& plan, f32* buffer)
+    {
+        internal::dfct((int)plan.size, buffer, plan.work, plan.ip, plan.w, plan.c);
+    }
+
+
+    void dst1(DctPlan const& plan, f32* buffer)
+    {
+        internal::dfst((int)plan.size, buffer, plan.work, plan.ip, plan.w, plan.c);
+    }
+}
+
+
+/* fixed point api */
+
+namespace fft
+{
+    bool create_fixed_plan(FixedPlan& plan, u32 size)
+    {
+        plan.size = 0;
+        plan.n_bins = 0;
+        plan.tw = 0;
+        plan.ws = 0;
+        plan.work = 0;
+
+        if (!num::is_power_of_2(size) || size < PLAN_MIN_SIZE || size > PLAN_MAX_SIZE)
+        {
+            return false;
+        }
+
+        auto exp = internal::plan_exp(size);
+
+        auto& tables = internal::fixed_tables[exp];
+        auto& split = internal::stockham_tables[exp];
+
+        {
+            std::lock_guard<std::mutex> lock(internal::plan_mutex);
+
+            if ((!tables.tw && !internal::create_tables(tables, size)) ||
+                (!split.ws && !internal::create_tables(split, size)))
+            {
+                return false;
+            }
+        }
+
+        auto work = (i16*)alloc_aligned(2 * size * sizeof(i16));
+        if (!work)
+        {
+            return false;
+        }
+
+        plan.size = size;
+        plan.n_bins = internal::fft_bin_size(size);
+        plan.tw = tables.tw;
+        plan.ws = split.ws;
+        plan.work = work;
+
+        return true;
+    }
+
+
+    void destroy_fixed_plan(FixedPlan& plan)
+    {
+        free_aligned(plan.work);
+
+        plan.size = 0;
+        plan.work = 0;
+    }
+
+
+    void forward_to(FixedPlan const& plan, i16 const* src, f32* dst)
+    {
+        auto nc = plan.size / 2;
+
+        internal::fixed_cft_kernel(nc, src, dst, plan.work, plan.tw);
+
+        auto z0 = dst[0];
+        auto z1 = dst[1];
+
+        dst[0] = z0 + z1;
+        dst[1] = z0 - z1;
+
+        internal::fourstep_kernels.split(nc, dst, dst, plan.ws, 1, nc / 2 + 1);
+    }
+
+
+    void forward_to(FixedPlan const& plan, i16 const* src, f32* dst, f32* bins)
+    {
+        forward_to(plan, src, dst);
+
+        internal::spectrum_kernel(dst + 2, bins, plan.n_bins, internal::SpectrumParams{});
+    }
+}
+
+
+/* wisdom */
+
+namespace fft
+{
+namespace internal
+{
+    static constexpr u32 WISDOM_VERSION = 1;
+
+    static constexpr Engine TUNE_ENGINES[] = { Engine::Ooura, Engine::Stockham, Engine::FourStep, Engine::Fft4g, Engine::Fft8g };
+
+    // per plan_exp
+    static Engine wisdom_engines[PLAN_MAX_EXP + 1];
+    static bool wisdom_tuned[PLAN_MAX_EXP + 1];
+
+
+    static cstr engine_name(Engine engine)
+    {
+        switch (engine)
+        {
+        case Engine::Stockham: return "Stockham";
+        case Engine::FourStep: return "FourStep";
+        case Engine::MixedRadix: return "MixedRadix";
+        case Engine::Fft4g: return "Fft4g";
+        case Engine::Fft8g: return "Fft8g";
+        default: return "Ooura";
+        }
+    }
+
+
+    static bool engine_from_name(cstr name, Engine& engine)
+    {
+        for (auto e : TUNE_ENGINES)
+        {
+            if (std::strcmp(name, engine_name(e)) == 0)
+            {
+                engine = e;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    static bool simd_from_name(cstr name, cpu::SIMD& simd)
+    {
+        for (int i = 0; i <= (int)cpu::simd_level(); i++)
+        {
+            if (std::strcmp(name, cpu::simd_name((cpu::SIMD)i)) == 0)
+            {
+                simd = (cpu::SIMD)i;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    // engines that run their own code at this size, the others would time the same passes
+    static bool tune_candidate(u32 size, Engine engine)
+    {
+        if (size <= CODELET_MAX_SIZE)
+        {
+            return engine == Engine::Ooura;
+        }
+
+        return engine != Engine::FourStep || size >= FOURSTEP_MIN_SIZE;
+    }
+
+
+    // nanoseconds per forward transform, best of a few runs, negative if the plan fails
+    static f64 time_engine(u32 size, Engine engine, f32 const* src, f32* dst)
+    {
+        Plan plan;
+        if (!fft::create_plan(plan, size, engine))
+        {
+            fft::destroy_plan(plan);
+            return -1.0;
+        }
+
+        auto n_reps = num::max((1u << 20) / size, 4u);
+
+        fft::forward_to(plan, src, dst);
+
+        Stopwatch sw;
+        f64 best = -1.0;
+
+        for (u32 run = 0; run < 3; run++)
+        {
+            sw.start();
+            for (u32 i = 0; i < n_reps; i++)
+            {
+                fft::forward_to(plan, src, dst);
+            }
+            sw.stop();
+
+            auto t = sw.get_time_nano() / n_reps;
+            if (best < 0.0 || t < best)
+            {
+                best = t;
+            }
+        }
+
+        destroy_plan(plan);
+
+        return best;
+    }
+}
+
+
+    bool tune(u32 min_size, u32 max_size)
+    {
+        using namespace internal;
+
+        min_size = num::max(min_size, PLAN_MIN_SIZE);
+        max_size = num::min(max_size, PLAN_MAX_SIZE);
+
+        auto src = (f32*)alloc_aligned(max_size * sizeof(f32));
+        auto dst = (f32*)alloc_aligned(max_size * sizeof(f32));
+        if (!src || !dst)
+        {
+            free_aligned(src);
+            free_aligned(dst);
+            return false;
+        }
+
+        u32 r = 1;
+        for (u32 i = 0; i < max_size; i++)
+        {
+            r = r * 1664525u + 1013904223u;
+            src[i] = (f32)(r >> 8) / (f32)(1u << 23) - 1.0f;
+        }
+
+        auto exp_begin = plan_exp(min_size);
+        auto exp_end = exp_begin;
+        while (exp_end <= PLAN_MAX_EXP && (1u << exp_end) <= max_size)
+        {
+            exp_end++;
+        }
+
+        Engine best_engines[PLAN_MAX_EXP + 1] = {};
+        f64 best_total = -1.0;
+        auto best_simd = simd_bound;
+
+        for (int i = 0; i <= (int)cpu::simd_level(); i++)
+        {
+            auto level = set_simd((cpu::SIMD)i);
+
+            Engine engines[PLAN_MAX_EXP + 1] = {};
+            f64 total = 0.0;
+
+            for (auto exp = exp_begin; exp < exp_end; exp++)
+            {
+                f64 t_min = -1.0;
+
+                for (auto engine : TUNE_ENGINES)
+                {
+                    if (!tune_candidate(1u << exp, engine))
+                    {
+                        continue;
+                    }
+
+                    auto t = time_engine(1u << exp, engine, src, dst);
+                    if (t >= 0.0 && (t_min < 0.0 || t < t_min))
+                    {
+                        t_min = t;
+                        engines[exp] = engine;
+                    }
+                }
+
+                total += t_min;
+            }
+
+            if (best_total < 0.0 || total < best_total)
+            {
+                best_total = total;
+                best_simd = level;
+                std::memcpy(best_engines, engines, sizeof(engines));
+            }
+        }
+
+        set_simd(best_simd);
+
+        for (auto exp = exp_begin; exp < exp_end; exp++)
+        {
+            wisdom_engines[exp] = best_engines[exp];
+            wisdom_tuned[exp] = true;
+        }
+
+        free_aligned(src);
+        free_aligned(dst);
+
+        return true;
+    }
+
+
+    bool save_wisdom(cstr path)
+    {
+        using namespace internal;
+
+        auto file = std::fopen(path, "w");
+        if (!file)
+        {
+            return false;
+        }
+
+        std::fprintf(file, "fft wisdom %u\n", WISDOM_VERSION);
+        std::fprintf(file, "cpu %s\n", cpu::simd_name(cpu::simd_level()));
+        std::fprintf(file, "simd %s\n", cpu::simd_name(simd_bound));
+
+        for (u32 exp = 0; exp <= PLAN_MAX_EXP; exp++)
+        {
+            if (wisdom_tuned[exp])
+            {
+                std::fprintf(file, "%u %s\n", 1u << exp, engine_name(wisdom_engines[exp]));
+            }
+        }
+
+        return std::fclose(file) == 0;
+    }
+
+
+    bool load_wisdom(cstr path)
+    {
+        using namespace internal;
+
+        auto file = std::fopen(path, "r");
+        if (!file)
+        {
+            return false;
+        }
+
+        Engine engines[PLAN_MAX_EXP + 1] = {};
+        bool tuned[PLAN_MAX_EXP + 1] = {};
+
+        u32 version = 0;
+        char name[32];
+        auto simd = cpu::SIMD::None;
+
+        auto ok =
+            std::fscanf(file, " fft wisdom %u", &version) == 1 && version == WISDOM_VERSION &&
+            std::fscanf(file, " cpu %31s", name) == 1 && std::strcmp(name, cpu::simd_name(cpu::simd_level())) == 0 &&
+            std::fscanf(file, " simd %31s", name) == 1 && simd_from_name(name, simd);
+
+        u32 size = 0;
+        while (ok)
+        {
+            auto n = std::fscanf(file, " %u %31s", &size, name);
+            if (n == EOF)
+            {
+                break;
+            }
+
+            // the size indexes the tables, reject the file before using it
+            ok = n == 2 && size >= PLAN_MIN_SIZE && size <= PLAN_MAX_SIZE && num::is_power_of_2(size);
+            if (!ok)
+            {
+                break;
+            }
+
+            auto exp = plan_exp(size);
+
+            ok = engine_from_name(name, engines[exp]);
+            tuned[exp] = ok;
+        }
+
+        ok = ok && std::feof(file);
+
+        std::fclose(file);
+
+        if (!ok)
+        {
+            return false;
+        }
+
+        set_simd(simd);
+
+        std::memcpy(wisdom_engines, engines, sizeof(engines));
+        std::memcpy(wisdom_tuned, tuned, sizeof(tuned));
+
+        return true;
+    }
+
+
+    Engine tuned_engine(u32 size)
+    {
+        using namespace internal;
+
+        if (size < PLAN_MIN_SIZE || size > PLAN_MAX_SIZE || !num::is_power_of_2(size) || !wisdom_tuned[plan_exp(size)])
+        {
+            return Engine::Ooura;
+        }
+
+        return wisdom_engines[plan_exp(size)];
+    }
+
+
+    bool create_tuned_plan(Plan& plan, u32 size)
+    {
+        return create_plan(plan, size, tuned_engine(size));
+    }
+}
+
+
+/* table file */
+
+namespace fft
+{
+namespace internal
+{
+    static constexpr u32 TABLE_FILE_VERSION = 1;
+
+    static constexpr u32 TABLE_FILE_ORDER = 0x01020304;
+
+    static constexpr u64 TABLE_FILE_ALIGN = 64;
+
+    static constexpr char TABLE_FILE_MAGIC[8] = { 'f', 'f', 't', 't', 'a', 'b', 'l', 'e' };
+
+
+    class TableFileHeader
+    {
+    public:
+        char magic[8];
+        u32 version;
+        u32 byte_order;
+        u32 n_entries;
+        u32 reserved;
+        u64 file_bytes;
+        u64 checksum; // everything after the header
+    };
+
+
+    // fft_ip_size(size) ints at ip_offset, fft_w_size(size) floats at w_offset
+    class TableFileEntry
+    {
+    public:
+        u32 size;
+        u32 reserved;
+        u64 ip_offset;
+        u64 w_offset;
+    };
+
+
+    static u64 table_file_align(u64 offset)
+    {
+        return (offset + TABLE_FILE_ALIGN - 1) / TABLE_FILE_ALIGN * TABLE_FILE_ALIGN;
+    }
+
+
+    // FNV-1a steps on 8 byte words, 4 independent lanes
+    static u64 table_file_checksum(u8 const* data, u64 bytes)
+    {
+        constexpr u64 PRIME = 0x100000001b3;
+
+        u64 h[4] = { 0xcbf29ce484222325, 0x84222325cbf29ce4, 0xcbf29ce4cbf29ce4, 0x8422232584222325 };
+
+        u64 i = 0;
+        for (; i + 32 <= bytes; i += 32)
+        {
+            for (u32 k = 0; k < 4; k++)
+            {
+                u64 v;
+                std::memcpy(&v, data + i + 8 * k, sizeof(v));
+                h[k] = (h[k] ^ v) * PRIME;
+            }
+        }
+
+        for (; i < bytes; i++)
+        {
+            h[0] = (h[0] ^ data[i]) * PRIME;
+        }
+
+        return ((h[0] * PRIME ^ h[1]) * PRIME ^ h[2]) * PRIME ^ h[3];
+    }
+
+
+    static bool table_file_valid(u8 const* data, u64 bytes)
+    {
+        TableFileHeader header;
+        if (bytes < sizeof(header))
+        {
+            return false;
+        }
+
+        std::memcpy(&header, data, sizeof(header));
+
+        auto entries_end = sizeof(header) + (u64)header.n_entries * sizeof(TableFileEntry);
+
+        if (std::memcmp(header.magic, TABLE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != TABLE_FILE_VERSION ||
+            header.byte_order != TABLE_FILE_ORDER ||
+            header.file_bytes != bytes ||
+            header.n_entries > PLAN_MAX_EXP + 1 ||
+            entries_end > bytes)
+        {
+            return false;
+        }
+
+        for (u32 i = 0; i < header.n_entries; i++)
+        {
+            TableFileEntry entry;
+            std::memcpy(&entry, data + sizeof(header) + i * sizeof(entry), sizeof(entry));
+
+            auto size = entry.size;
+            if (size < PLAN_MIN_SIZE || size > PLAN_MAX_SIZE || !num::is_power_of_2(size) ||
+                entry.ip_offset % TABLE_FILE_ALIGN || entry.w_offset % TABLE_FILE_ALIGN ||
+                entry.ip_offset < entries_end || entry.w_offset < entries_end ||
+                entry.ip_offset > bytes || entry.w_offset > bytes ||
+                fft_ip_size(size) * sizeof(i32) > bytes - entry.ip_offset ||
+                fft_w_size(size) * sizeof(f32) > bytes - entry.w_offset)
+            {
+                return false;
+            }
+        }
+
+        return table_file_checksum(data + sizeof(header), bytes - sizeof(header)) == header.checksum;
+    }
+}
+
+
+    bool save_tables(cstr path)
+    {
+        using namespace internal;
+
+        std::lock_guard<std::mutex> lock(plan_mutex);
+
+        TableFileHeader header;
+        TableFileEntry entries[PLAN_MAX_EXP + 1];
+
+        std::memcpy(header.magic, TABLE_FILE_MAGIC, sizeof(header.magic));
+        header.version = TABLE_FILE_VERSION;
+        header.byte_order = TABLE_FILE_ORDER;
+        header.n_entries = 0;
+        header.reserved = 0;
+
+        for (u32 exp = 0; exp <= PLAN_MAX_EXP; exp++)
+        {
+            if (plan_tables[exp].ip)
+            {
+                auto& entry = entries[header.n_entries++];
+                entry.size = 1u << exp;
+                entry.reserved = 0;
+            }
+        }
+
+        u64 offset = sizeof(header) + header.n_entries * sizeof(TableFileEntry);
+        for (u32 i = 0; i < header.n_entries; i++)
+        {
+            auto& entry = entries[i];
+
+            entry.ip_offset = table_file_align(offset);
+            entry.w_offset = table_file_align(entry.ip_offset + fft_ip_size(entry.size) * sizeof(i32));
+            offset = entry.w_offset + fft_w_size(entry.size) * sizeof(f32);
+        }
+
+        header.file_bytes = offset;
+
+        auto data = (u8*)std::calloc(offset, 1);
+        if (!data)
+        {
+            return false;
+        }
+
+        std::memcpy(data + sizeof(header), entries, header.n_entries * sizeof(TableFileEntry));
+
+        for (u32 i = 0; i < header.n_entries; i++)
+        {
+            auto& entry = entries[i];
+            auto& tables = plan_tables[plan_exp(entry.size)];
+
+            std::memcpy(data + entry.ip_offset, tables.ip, fft_ip_size(entry.size) * sizeof(i32));
+            std::memcpy(data + entry.w_offset, tables.w, fft_w_size(entry.size) * sizeof(f32));
+        }
+
+        header.checksum = table_file_checksum(data + sizeof(header), offset - sizeof(header));
+        std::memcpy(data, &header, sizeof(header));
+
+        // written next to path and renamed, a reader never maps a partial file
+        char tmp_path[4096];
+        auto n = std::snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+        auto file = n > 0 && n < (int)sizeof(tmp_path) ? std::fopen(tmp_path, "wb") : 0;
+        if (!file)
+        {
+            std::free(data);
+            return false;
+        }
+
+        auto ok = std::fwrite(data, 1, offset, file) == offset;
+        ok = std::fclose(file) == 0 && ok;
+        ok = ok && std::rename(tmp_path, path) == 0;
+
+        if (!ok)
+        {
+            std::remove(tmp_path);
+        }
+
+        std::free(data);
+
+        return ok;
+    }
+
+
+    bool load_tables(cstr path)
+    {
+        using namespace internal;
+
+        std::lock_guard<std::mutex> lock(plan_mutex);
+
+        if (tables_map)
+        {
+            return false;
+        }
+
+        auto fd = open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        auto bytes = (u64)st.st_size;
+        auto map = mmap(0, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (map == MAP_FAILED)
+        {
+            return false;
+        }
+
+        auto data = (u8 const*)map;
+        if (!table_file_valid(data, bytes))
+        {
+            munmap(map, bytes);
+            return false;
+        }
+
+        TableFileHeader header;
+        std::memcpy(&header, data, sizeof(header));
+
+        // sizes already created keep their tables
+        for (u32 i = 0; i < header.n_entries; i++)
+        {
+            TableFileEntry entry;
+            std::memcpy(&entry, data + sizeof(header) + i * sizeof(entry), sizeof(entry));
+
+            auto& tables = plan_tables[plan_exp(entry.size)];
+            if (!tables.ip)
+            {
+                tables.ip = (i32*)(data + entry.ip_offset);
+                tables.w = (f32*)(data + entry.w_offset);
+                tables.mapped = true;
+            }
+        }
+
+        tables_map = map;
+        tables_map_bytes = bytes;
+
+        return true;
+    }
 }
-}
\ No newline at end of file
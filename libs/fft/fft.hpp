@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../util/numeric.hpp"
+#include "../util/cpu.hpp"
 
 namespace num = numeric;
 
@@ -11,15 +12,13 @@ namespace internal
 {
     static constexpr u32 sqrt_approx(u32 val)
     {
-        for (u32 i = 0; i < 50; i++)
+        u32 i = 0;
+        while ((u64)(i + 1) * (i + 1) <= val)
         {
-            if (i * i > val)
-            {
-                return i - 1;
-            }
+            i++;
         }
 
-        return 0;
+        return i;
     }
 
 
@@ -41,9 +40,16 @@ namespace internal
     }
 
 
+    // 1 to size / 2 - 1, odd sizes have no Nyquist bin: 1 to (size - 1) / 2
     static constexpr u32 fft_bin_size(u32 size)
     {
-        return (size - 2) / 2;
+        return (size - 1) / 2;
+    }
+
+
+    static constexpr u32 fft_full_bin_size(u32 size)
+    {
+        return size / 2 + 1;
     }
 
 
@@ -55,6 +61,655 @@ namespace internal
 
     void forward(u32 n, f32* buffer, i32* ip, f32* w);
 
+    // magnitude of bins 1 to n / 2 - 1 from a transformed buffer
+    void bins(u32 n, f32 const* buffer, f32* bins);
+
+
+    // fft_codelet.cpp, unrolled transforms for the small sizes
+    // same layout and scaling as forward/inverse, src == dst is allowed
+    static constexpr u32 CODELET_MAX_SIZE = 64;
+
+    template <u32 N>
+    void codelet_forward(f32 const* src, f32* dst);
+
+    template <u32 N>
+    void codelet_inverse(f32 const* src, f32* dst);
+
+
+    // fft_mixed.cpp, the tables of a MixedRadix plan
+    class MixedTables;
+}
+}
+
+
+/* memory */
+
+namespace fft
+{
+    // every table and work buffer, one cache line and one AVX-512 vector
+    static constexpr u64 ALLOC_ALIGN = 64;
+
+    // alloc_aligned(bytes) uses huge pages from this size
+    static constexpr u64 HUGE_PAGE_MIN_BYTES = 2u << 20;
+
+    // ALLOC_ALIGN aligned and not initialized, free with free_aligned
+    void* alloc_aligned(u64 bytes);
+
+    // huge_pages: MAP_HUGETLB pages when the system has them reserved,
+    // otherwise 2 MB aligned and advised for transparent huge pages
+    void* alloc_aligned(u64 bytes, bool huge_pages);
+
+    void free_aligned(void* data);
+}
+
+
+/* plan */
+
+namespace fft
+{
+    static constexpr u32 PLAN_MIN_EXP = 2;
+    static constexpr u32 PLAN_MAX_EXP = 24;
+
+    static constexpr u32 PLAN_MIN_SIZE = 1u << PLAN_MIN_EXP;
+    static constexpr u32 PLAN_MAX_SIZE = 1u << PLAN_MAX_EXP;
+
+
+    enum class Engine : u32
+    {
+        // fftsg split-radix, in place with a bit reversal pass
+        Ooura = 0,
+
+        // autosort passes between the buffer and a work buffer owned by the plan, no bit reversal
+        // a plan and its copies run one transform at a time
+        Stockham,
+
+        // six-step, row transforms that fit in L1 between transposes in cache sized tiles
+        // threaded by the parallel transforms. Sizes below FOURSTEP_MIN_SIZE run the Stockham engine
+        // a plan and its copies run one transform at a time
+        FourStep,
+
+        // set by create_plan for the sizes that are not a power of 2
+        // radix 4, 3, 5, 7 and 2 passes, any other factor by a Bluestein convolution
+        // the plan owns its tables, a plan and its copies run one transform at a time
+        MixedRadix,
+
+        // the fft4g (radix 4, 2) and fft8g (radix 8, 4, 2) packages, scalar, in place
+        // tables shared by every plan of the same size and engine
+        Fft4g,
+        Fft8g
+    };
+
+
+    static constexpr u32 FOURSTEP_MIN_SIZE = 1u << 16;
+
+
+    class Plan
+    {
+    public:
+        u32 size = 0;
+        u32 n_bins = 0;      // 1 to size / 2 - 1
+        u32 n_full_bins = 0; // 0 to size / 2
+
+        Engine engine = Engine::Ooura;
+
+        // shared by every plan of the same size, read-only
+        i32* ip = 0;
+        f32* w = 0;
+
+        // Stockham and FourStep only
+        f32* tw = 0; // Stockham: size / 2 points, FourStep: the first row transforms
+        f32* ws = 0;
+        f32* work = 0;
+
+        // FourStep only
+        f32* tw2 = 0; // the second row transforms
+        f32* tw_lo = 0;
+        f32* tw_hi = 0;
+
+        // MixedRadix only
+        internal::MixedTables* mixed = 0;
+
+        // Fft4g and Fft8g only, the tables of that package
+        i32* ip_g = 0;
+        f32* w_g = 0;
+    };
+
+
+    // size from PLAN_MIN_SIZE to PLAN_MAX_SIZE
+    // powers of 2: tables are created on the first request for a size and reused after that
+    // other sizes: a MixedRadix plan with its own tables, free them with destroy_plan
+    //   same layout and scaling as the power of 2 sizes. Odd sizes have no Nyquist bin,
+    //   buffer[size - 1] is Re X[(size - 1) / 2] and buffer[1] its -Im
+    //   the parallel transforms run on the calling thread
+    bool create_plan(Plan& plan, u32 size);
+
+    // same results as an Ooura plan to within rounding
+    // sizes up to internal::CODELET_MAX_SIZE use the codelets whatever the engine
+    // sizes that are not a power of 2 are MixedRadix whatever the engine
+    // the parallel transforms run the Ooura engine unless the plan is FourStep
+    // Fft4g and Fft8g have no work buffer
+    bool create_plan(Plan& plan, u32 size, Engine engine);
+
+    // frees the work buffer of a Stockham or FourStep plan, the tables of a MixedRadix plan
+    void destroy_plan(Plan& plan);
+
+    // frees all cached tables, existing plans are no longer valid
+    void destroy_plans();
+
+    void forward(Plan const& plan, f32* buffer, f32* bins);
+
+    void forward(Plan const& plan, f32* buffer);
+
+    void inverse(Plan const& plan, f32* buffer);
+
+    // out-of-place, src is read by the first pass and not modified, the result is in dst
+    // same results as forward/inverse on a copy of src, src == dst is allowed
+    void forward_to(Plan const& plan, f32 const* src, f32* dst);
+
+    void forward_to(Plan const& plan, f32 const* src, f32* dst, f32* bins);
+
+    void inverse_to(Plan const& plan, f32 const* src, f32* dst);
+
+
+    class WorkBuffer
+    {
+    public:
+        Plan plan;
+
+        f32* buffer = 0;
+        f32* bins = 0;
+    };
+
+
+    bool create_buffer(WorkBuffer& work, u32 size);
+
+    void destroy_buffer(WorkBuffer& work);
+
+
+    inline void forward(WorkBuffer const& work) { forward(work.plan, work.buffer, work.bins); }
+
+    inline void inverse(WorkBuffer const& work) { inverse(work.plan, work.buffer); }
+}
+
+
+/* spectrum */
+
+namespace fft
+{
+    enum class Spectrum : u32
+    {
+        Magnitude = 0, // |X[k]|
+        Power,         // |X[k]|^2
+        Decibel,       // 20 log10 |X[k]|, no lower than db_floor
+        Phase,         // arg X[k] in radians, -pi to pi
+        Normalized     // 2 |X[k]| / size, a full scale sine reads 1
+    };
+
+
+    class SpectrumOptions
+    {
+    public:
+        Spectrum mode = Spectrum::Magnitude;
+
+        // coherent gain of the analysis window, see window_gain()
+        // amplitudes are divided by it, power by its square. Not applied to Phase
+        f32 window_gain = 1.0f;
+
+        f32 db_floor = -120.0f;
+    };
+
+
+    // bins in the selected mode, computed in one pass over the transform
+    void forward(Plan const& plan, f32* buffer, f32* bins, SpectrumOptions const& options);
+
+    // bins from a buffer already transformed with forward(plan, buffer)
+    void spectrum(Plan const& plan, f32 const* buffer, f32* bins, SpectrumOptions const& options);
+
+    // sum(window) / size
+    f32 window_gain(f32 const* window, u32 size);
+}
+
+
+/* full spectrum */
+
+namespace fft
+{
+    // n_full_bins bins from DC to Nyquist, from a buffer already transformed with forward(plan, buffer)
+    // X[k] = sum x[j] exp(-2 pi i j k / size), Im of DC and Nyquist is 0
+
+    // bins[2k] = Re X[k], bins[2k + 1] = Im X[k], 2 * n_full_bins values
+    void complex_bins(Plan const& plan, f32 const* buffer, f32* bins);
+
+    // re[k] = Re X[k], im[k] = Im X[k]
+    void split_bins(Plan const& plan, f32 const* buffer, f32* re, f32* im);
+
+    // like spectrum(), DC and Nyquist included
+    void full_spectrum(Plan const& plan, f32 const* buffer, f32* bins, SpectrumOptions const& options);
+
+
+    void forward_complex(Plan const& plan, f32* buffer, f32* bins);
+
+    void forward_split(Plan const& plan, f32* buffer, f32* re, f32* im);
+
+    void forward_full(Plan const& plan, f32* buffer, f32* bins, SpectrumOptions const& options);
+}
+
+
+/* parallel */
+
+namespace fft
+{
+    // sizes from here on split the transform across a thread pool, smaller sizes run on the calling thread
+    static constexpr u32 PARALLEL_MIN_SIZE = 1u << 17;
+
+
+    // n_threads including the calling thread, 0: one per hardware thread
+    // optional, the parallel transforms start a pool of the default size on first use
+    void start_threads(u32 n_threads);
+
+    void stop_threads();
+
+    // same results as forward/inverse
+    // Ooura: the cftrec4 tree is parallel, the first butterfly pass, bit reversal and real split are not
+    // FourStep: every pass is split across the pool
+    // Stockham, Fft4g, Fft8g and MixedRadix plans run forward/inverse on the calling thread
+    void forward_parallel(Plan const& plan, f32* buffer, f32* bins);
+
+    void forward_parallel(Plan const& plan, f32* buffer, f32* bins, SpectrumOptions const& options);
+
+    void forward_parallel(Plan const& plan, f32* buffer);
+
+    void inverse_parallel(Plan const& plan, f32* buffer);
+}
+
+
+/* batch */
+
+namespace fft
+{
+    // transforms 4, 8 or 16 same size frames at once, one channel per SIMD lane
+    // buffer is channel interleaved: sample i of channel c is at buffer[i * n_channels + c]
+    // e.g. a multi-channel capture stream, or frames passed through interleave()
+    class BatchPlan
+    {
+    public:
+        u32 size = 0;
+        u32 n_bins = 0;
+        u32 n_channels = 0;
+
+        // shared by every batch plan of the same size, read-only
+        u32* rev = 0;
+        f32* tw = 0;
+        f32* ws = 0;
+    };
+
+
+    bool create_batch_plan(BatchPlan& plan, u32 size, u32 n_channels);
+
+    // buffer is transformed in place, each channel to the forward(Plan) layout
+    // bins of channel c are written to bins + c * n_bins
+    void forward(BatchPlan const& plan, f32* buffer, f32* bins);
+
+    void forward(BatchPlan const& plan, f32* buffer);
+
+    void interleave(f32* const* frames, f32* buffer, u32 size, u32 n_channels);
+
+    // the inverse of interleave(), frames[c][i] = buffer[i * n_channels + c]
+    // splits a multi-channel capture stream into per-channel frames
+    void deinterleave(f32 const* buffer, f32* const* frames, u32 size, u32 n_channels);
+}
+
+
+/* complex */
+
+namespace fft
+{
+    // complex FFT of size points, buffer[2j] = Re x[j], buffer[2j + 1] = Im x[j]
+    // forward: X[k] = sum x[j] exp(-2 pi i j k / size), inverse with exp(+2 pi i j k / size)
+    // both unscaled, inverse(forward(x)) = size x
+    class ComplexPlan
+    {
+    public:
+        u32 size = 0;
+
+        Engine engine = Engine::Ooura;
+
+        // the tables of the real plans of 2 * size, read-only
+        i32* ip = 0;
+        f32* w = 0;
+
+        // Stockham only
+        f32* tw = 0;
+        f32* work = 0;
+    };
+
+
+    // size must be a power of 2 from PLAN_MIN_SIZE / 2 to PLAN_MAX_SIZE / 2
+    // tables are shared with create_plan(2 * size)
+    bool create_complex_plan(ComplexPlan& plan, u32 size);
+
+    // Ooura runs the fftsg cdft passes. Every other engine runs the Stockham passes,
+    // exact twiddles and a work buffer, a plan and its copies run one transform at a time
+    bool create_complex_plan(ComplexPlan& plan, u32 size, Engine engine);
+
+    void destroy_complex_plan(ComplexPlan& plan);
+
+    void forward(ComplexPlan const& plan, f32* buffer);
+
+    void inverse(ComplexPlan const& plan, f32* buffer);
+
+    // src == dst is allowed
+    void forward_to(ComplexPlan const& plan, f32 const* src, f32* dst);
+
+    void inverse_to(ComplexPlan const& plan, f32 const* src, f32* dst);
+}
+
+
+/* dct */
+
+namespace fft
+{
+    // DCT and DST of n = size real points, in place, the fftsg ddct/ddst/dfct/dfst transforms
+    // all unscaled, the inverse of each is listed with it
+    class DctPlan
+    {
+    public:
+        u32 size = 0;
+
+        // the tables of the real plans of size, read-only
+        i32* ip = 0;
+        f32* w = 0;
+
+        // the dctsub/dstsub table of size, read-only
+        f32* c = 0;
+
+        // dct1 and dst1 only, a plan and its copies run one of them at a time
+        f32* work = 0;
+    };
+
+
+    // size must be a power of 2 from PLAN_MIN_SIZE to PLAN_MAX_SIZE
+    bool create_dct_plan(DctPlan& plan, u32 size);
+
+    void destroy_dct_plan(DctPlan& plan);
+
+    // DCT-II: C[k] = sum x[j] cos(pi (j + 1/2) k / n), 0 <= j, k < n
+    // inverse: buffer[0] *= 0.5, dct3, then scale by 2 / n
+    void dct2(DctPlan const& plan, f32* buffer);
+
+    // DCT-III: x[k] = sum C[j] cos(pi j (k + 1/2) / n), 0 <= j, k < n
+    void dct3(DctPlan const& plan, f32* buffer);
+
+    // DST-II: S[k] = sum x[j] sin(pi (j + 1/2) k / n), 0 <= j < n, 0 < k <= n
+    // S[n] is written to buffer[0]
+    // inverse: buffer[0] *= 0.5, dst3, then scale by 2 / n
+    void dst2(DctPlan const& plan, f32* buffer);
+
+    // DST-III: x[k] = sum S[j] sin(pi j (k + 1/2) / n), 0 < j <= n, 0 <= k < n
+    // S[n] is read from buffer[0]
+    void dst3(DctPlan const& plan, f32* buffer);
+
+    // DCT-I of n + 1 points: C[k] = sum x[j] cos(pi j k / n), 0 <= j, k <= n
+    // buffer holds size + 1 values
+    // inverse of buffer[0] *= 0.5, buffer[n] *= 0.5, dct1: the same three steps, then scale by 2 / n
+    void dct1(DctPlan const& plan, f32* buffer);
+
+    // DST-I: S[k] = sum x[j] sin(pi j k / n), 0 < j, k < n, buffer[0] is set to 0
+    // inverse: dst1, then scale by 2 / n
+    void dst1(DctPlan const& plan, f32* buffer);
+}
+
+
+/* fixed point */
+
+namespace fft
+{
+    // S16 samples straight from capture, int16 block floating point passes, f32 results
+    class FixedPlan
+    {
+    public:
+        u32 size = 0;
+        u32 n_bins = 0;
+
+        // shared by every fixed plan of the same size, read-only
+        i16* tw = 0; // Q15 twiddles
+        f32* ws = 0; // the real split, shared with the Stockham plans
+
+        // 2 * size values, a plan and its copies run one transform at a time
+        i16* work = 0;
+    };
+
+
+    // size must be a power of 2 from PLAN_MIN_SIZE to PLAN_MAX_SIZE
+    bool create_fixed_plan(FixedPlan& plan, u32 size);
+
+    void destroy_fixed_plan(FixedPlan& plan);
+
+    // size samples from src, the forward(Plan) layout and scaling in dst for the samples s / 32768
+    // SNR about 65 dB for a tone at 256 points falling to 52 dB at 4096, better for broadband input
+    // the block exponent follows the signal level, quiet input keeps its precision
+    void forward_to(FixedPlan const& plan, i16 const* src, f32* dst);
+
+    // bins as forward(Plan, buffer, bins)
+    void forward_to(FixedPlan const& plan, i16 const* src, f32* dst, f32* bins);
+}
+
+
+/* simd */
+
+namespace fft
+{
+    // kernel set in use, bound at startup to the best the cpu supports
+    cpu::SIMD simd();
+
+    // forces a lower level for testing/benchmarks, returns the level bound
+    // not thread safe, call while no transforms are running
+    cpu::SIMD set_simd(cpu::SIMD simd);
+}
+
+
+/* wisdom */
+
+namespace fft
+{
+    // times Ooura, Stockham, FourStep, Fft4g and Fft8g for the powers of 2 from min_size to max_size
+    // at every simd level the cpu supports. The kernel set is global, so the level with the lowest
+    // total is bound (set_simd) and the fastest engine at that level is kept for each size
+    // false if the test buffers cannot be allocated
+    // not thread safe, call while no transforms are running
+    bool tune(u32 min_size, u32 max_size);
+
+    // text file, "fft wisdom 1", the cpu and simd levels, then one "<size> <engine>" line per size
+    bool save_wisdom(cstr path);
+
+    // rejected if written on a cpu with another simd level, binds the simd level of the file
+    // not thread safe, call while no transforms are running
+    bool load_wisdom(cstr path);
+
+    // Ooura for the sizes not tuned
+    Engine tuned_engine(u32 size);
+
+    // create_plan with tuned_engine(size), free with destroy_plan
+    bool create_tuned_plan(Plan& plan, u32 size);
+}
+
+
+/* table file */
+
+namespace fft
+{
+    // writes the Ooura tables (ip, w) of every power of 2 size created so far
+    // binary, versioned, with a checksum, for this build and byte order only
+    bool save_tables(cstr path);
+
+    // maps a save_tables file read-only, the sizes not created yet use its tables
+    // false if the file is missing, corrupt or from another version, or a file is already mapped
+    // destroy_plans unmaps it
+    bool load_tables(cstr path);
+}
+
+
+/* static tables */
+
+namespace fft
+{
+namespace internal
+{
+    // rdft_ip_w (makewt, makeipt, makect) evaluated at compile time with num::cxpr::sin/cos
+    // for sizes known at compile time, the tables end up in .rodata
+
+    static constexpr u32 STATIC_TABLES_MAX_EXP = 16;
+
+
+    template <u32 N>
+    class StaticTables
+    {
+    public:
+        alignas(ALLOC_ALIGN) i32 ip[fft_ip_size(N)] = {};
+        alignas(ALLOC_ALIGN) f32 w[fft_w_size(N)] = {};
+    };
+
+
+    static constexpr void cxpr_makeipt(int nw, i32* ip)
+    {
+        ip[2] = 0;
+        ip[3] = 16;
+
+        int m = 2;
+        for (int l = nw; l > 32; l >>= 2)
+        {
+            int m2 = m << 1;
+            int q = m2 << 3;
+            for (int j = m; j < m2; j++)
+            {
+                int p = ip[j] << 2;
+                ip[m + j] = p;
+                ip[m2 + j] = p + q;
+            }
+
+            m = m2;
+        }
+    }
+
+
+    static constexpr void cxpr_makewt(int nw, i32* ip, f32* w)
+    {
+        namespace cx = num::cxpr;
+
+        ip[0] = nw;
+        ip[1] = 1;
+
+        if (nw <= 2)
+        {
+            return;
+        }
+
+        int nwh = nw >> 1;
+        f32 delta = (f32)(num::PI / 4) / nwh;
+        f32 wn4r = cx::cos(delta * nwh);
+
+        w[0] = 1;
+        w[1] = wn4r;
+
+        if (nwh == 4)
+        {
+            w[2] = cx::cos(delta * 2);
+            w[3] = cx::sin(delta * 2);
+        }
+        else if (nwh > 4)
+        {
+            cxpr_makeipt(nw, ip);
+
+            w[2] = 0.5 / cx::cos(delta * 2);
+            w[3] = 0.5 / cx::cos(delta * 6);
+            for (int j = 4; j < nwh; j += 4)
+            {
+                w[j] = cx::cos(delta * j);
+                w[j + 1] = cx::sin(delta * j);
+                w[j + 2] = cx::cos(3 * delta * j);
+                w[j + 3] = -cx::sin(3 * delta * j);
+            }
+        }
+
+        int nw0 = 0;
+        while (nwh > 2)
+        {
+            int nw1 = nw0 + nwh;
+            nwh >>= 1;
+
+            w[nw1] = 1;
+            w[nw1 + 1] = wn4r;
+
+            if (nwh == 4)
+            {
+                w[nw1 + 2] = w[nw0 + 4];
+                w[nw1 + 3] = w[nw0 + 5];
+            }
+            else if (nwh > 4)
+            {
+                w[nw1 + 2] = 0.5 / w[nw0 + 4];
+                w[nw1 + 3] = 0.5 / w[nw0 + 6];
+                for (int j = 4; j < nwh; j += 4)
+                {
+                    w[nw1 + j] = w[nw0 + 2 * j];
+                    w[nw1 + j + 1] = w[nw0 + 2 * j + 1];
+                    w[nw1 + j + 2] = w[nw0 + 2 * j + 2];
+                    w[nw1 + j + 3] = w[nw0 + 2 * j + 3];
+                }
+            }
+
+            nw0 = nw1;
+        }
+    }
+
+
+    static constexpr void cxpr_makect(int nc, i32* ip, f32* c)
+    {
+        namespace cx = num::cxpr;
+
+        ip[1] = nc;
+
+        if (nc <= 1)
+        {
+            return;
+        }
+
+        int nch = nc >> 1;
+        f32 delta = (f32)(num::PI / 4) / nch;
+
+        c[0] = cx::cos(delta * nch);
+        c[nch] = 0.5 * c[0];
+        for (int j = 1; j < nch; j++)
+        {
+            c[j] = 0.5 * cx::cos(delta * j);
+            c[nc - j] = 0.5 * cx::sin(delta * j);
+        }
+    }
+
+
+    template <u32 N>
+    static constexpr StaticTables<N> make_static_tables()
+    {
+        StaticTables<N> tables{};
+
+        int n = (int)N;
+        int nw = n >> 2;
+
+        cxpr_makewt(nw, tables.ip, tables.w);
+
+        int nc = tables.ip[1];
+        if (n > (nc << 2))
+        {
+            nc = n >> 2;
+            cxpr_makect(nc, tables.ip, tables.w + nw);
+        }
+
+        return tables;
+    }
+
+
+    template <u32 N>
+    inline constexpr StaticTables<N> static_tables = make_static_tables<N>();
 }
 }
 
@@ -69,26 +724,133 @@ namespace fft
         static constexpr u32 exp = B2EXP;
         static constexpr u32 size = internal::fft_size(exp);
         static constexpr u32 n_bins = internal::fft_bin_size(size);
+        static constexpr u32 n_full_bins = internal::fft_full_bin_size(size);
 
-        f32 buffer[size];
+        alignas(ALLOC_ALIGN) f32 buffer[size];
 
-        i32 ip[internal::fft_ip_size(size)];
-        f32 w[internal::fft_w_size(size)];
+        alignas(ALLOC_ALIGN) f32 bins[n_bins];
 
-        f32 bins[n_bins];
+        Plan plan;
 
 
-        void init() 
+        bool init() 
         { 
             static_assert(num::is_power_of_2(size));
-            static_assert(size >= 4);
+            static_assert(size >= PLAN_MIN_SIZE);
+            static_assert(size <= PLAN_MAX_SIZE);
 
-            internal::init_ip_w(size, ip, w); 
             for (u32 i = 0; i < n_bins; i++) { bins[i] = 0.0f; } 
+
+            if constexpr (exp <= internal::STATIC_TABLES_MAX_EXP)
+            {
+                // read-only, same values as the cached tables of create_plan
+                auto& tables = internal::static_tables<size>;
+
+                // the fields not set here keep their defaults, not what was in memory before
+                plan = Plan{};
+
+                plan.size = size;
+                plan.n_bins = n_bins;
+                plan.n_full_bins = n_full_bins;
+                plan.ip = (i32*)tables.ip;
+                plan.w = (f32*)tables.w;
+
+                return true;
+            }
+            else
+            {
+                return create_plan(plan, size);
+            }
+        }
+
+        void forward(f32* bins)
+        {
+            if constexpr (size <= internal::CODELET_MAX_SIZE)
+            {
+                internal::codelet_forward<size>(buffer, buffer);
+                internal::bins(size, buffer, bins);
+            }
+            else
+            {
+                fft::forward(plan, buffer, bins);
+            }
         }
 
-        void forward(f32* bins) { internal::forward(size, buffer, ip, w, bins);  }
+        void forward(f32* bins, SpectrumOptions const& options) { fft::forward(plan, buffer, bins, options); }
+
+        void inverse() { inverse(buffer); }
+
+        // transforms src into buffer
+        void forward(f32 const* src, f32* bins)
+        {
+            if constexpr (size <= internal::CODELET_MAX_SIZE)
+            {
+                internal::codelet_forward<size>(src, buffer);
+                internal::bins(size, buffer, bins);
+            }
+            else
+            {
+                fft::forward_to(plan, src, buffer, bins);
+            }
+        }
 
-        void inverse() { internal::inverse(size, buffer, ip, w); }
+        // inverse of buffer into dst, buffer is not modified
+        void inverse(f32* dst)
+        {
+            if constexpr (size <= internal::CODELET_MAX_SIZE)
+            {
+                internal::codelet_inverse<size>(buffer, dst);
+            }
+            else
+            {
+                fft::inverse_to(plan, buffer, dst);
+            }
+        }
     };
-}
\ No newline at end of file
+}
+
+namespace fft
+{
+    // FFT<B2EXP> for any frame size, e.g. 441, 480 or 960 samples for 10 and 20 ms hops
+    // sizes that are not a power of 2 run a MixedRadix plan, destroy() frees its tables
+    template <u32 SIZE>
+    class FrameFFT
+    {
+    public:
+
+        static constexpr u32 size = SIZE;
+        static constexpr u32 n_bins = internal::fft_bin_size(size);
+        static constexpr u32 n_full_bins = internal::fft_full_bin_size(size);
+
+        alignas(ALLOC_ALIGN) f32 buffer[size];
+
+        alignas(ALLOC_ALIGN) f32 bins[n_bins];
+
+        Plan plan;
+
+
+        bool init()
+        {
+            static_assert(size >= PLAN_MIN_SIZE);
+            static_assert(size <= PLAN_MAX_SIZE);
+
+            for (u32 i = 0; i < n_bins; i++) { bins[i] = 0.0f; }
+
+            return create_plan(plan, size);
+        }
+
+        void destroy() { destroy_plan(plan); }
+
+        void forward(f32* bins) { fft::forward(plan, buffer, bins); }
+
+        void forward(f32* bins, SpectrumOptions const& options) { fft::forward(plan, buffer, bins, options); }
+
+        void inverse() { fft::inverse(plan, buffer); }
+
+        // transforms src into buffer
+        void forward(f32 const* src, f32* bins) { fft::forward_to(plan, src, buffer, bins); }
+
+        // inverse of buffer into dst, buffer is not modified
+        void inverse(f32* dst) { fft::inverse_to(plan, buffer, dst); }
+    };
+}
@@ -0,0 +1,400 @@
+// Batched real FFT, one channel per SIMD lane
+// Sample i of lane l is at a[i * L + l] and every step is done on all L lanes at once
+// Radix-2 complex FFT of n / 2 points followed by the real split
+// Output per lane is in the rdft_forward layout: a[2k] = Re, a[2k + 1] = Im (+i sign), a[1] = R[n / 2]
+// The engine is written once with GCC vector extensions and inlined into an entry point per target
+
+
+#define BATCH_INLINE inline __attribute__((always_inline))
+
+
+template <u32 L> class Lanes;
+
+template <> class Lanes<4> { public: typedef f32 type __attribute__((vector_size(16))); };
+
+template <> class Lanes<8> { public: typedef f32 type __attribute__((vector_size(32))); };
+
+template <> class Lanes<16> { public: typedef f32 type __attribute__((vector_size(64))); };
+
+
+// buffers are only f32 aligned
+// by reference, vectors passed by value change the ABI with the target
+
+template <class V>
+static BATCH_INLINE void load(V& v, f32 const* src) { __builtin_memcpy(&v, src, sizeof(V)); }
+
+template <class V>
+static BATCH_INLINE void store(f32* dst, V const& v) { __builtin_memcpy(dst, &v, sizeof(V)); }
+
+
+// nc complex values, bit reversed order
+template <u32 L>
+static BATCH_INLINE void batch_bitrv(u32 nc, f32* a, u32 const* rev)
+{
+    using V = typename Lanes<L>::type;
+
+    constexpr u32 C = 2 * L;
+
+    for (u32 i = 0; i < nc; i++)
+    {
+        auto j = rev[i];
+        if (i < j)
+        {
+            V ir, ii, jr, ji;
+            load(ir, a + i * C);
+            load(ii, a + i * C + L);
+            load(jr, a + j * C);
+            load(ji, a + j * C + L);
+
+            store(a + i * C, jr);
+            store(a + i * C + L, ji);
+            store(a + j * C, ir);
+            store(a + j * C + L, ii);
+        }
+    }
+}
+
+
+// tw[j] = exp(-2 pi i j / nc), j < nc / 2
+template <u32 L>
+static BATCH_INLINE void batch_cft(u32 nc, f32* a, f32 const* tw)
+{
+    using V = typename Lanes<L>::type;
+
+    constexpr u32 C = 2 * L;
+
+    for (u32 k = 0; k < nc; k += 2)
+    {
+        auto p = a + k * C;
+
+        V r0, i0, r1, i1;
+        load(r0, p);
+        load(i0, p + L);
+        load(r1, p + C);
+        load(i1, p + C + L);
+
+        store(p, r0 + r1);
+        store(p + L, i0 + i1);
+        store(p + C, r0 - r1);
+        store(p + C + L, i0 - i1);
+    }
+
+    for (u32 len = 4; len <= nc; len <<= 1)
+    {
+        auto half = len / 2;
+        auto step = nc / len;
+
+        for (u32 s = 0; s < nc; s += len)
+        {
+            for (u32 j = 0; j < half; j++)
+            {
+                auto wr = tw[2 * j * step];
+                auto wi = tw[2 * j * step + 1];
+
+                auto u = a + (s + j) * C;
+                auto v = u + half * C;
+
+                V ur, ui, br, bi;
+                load(ur, u);
+                load(ui, u + L);
+                load(br, v);
+                load(bi, v + L);
+
+                V tr = wr * br - wi * bi;
+                V ti = wr * bi + wi * br;
+
+                store(u, ur + tr);
+                store(u + L, ui + ti);
+                store(v, ur - tr);
+                store(v + L, ui - ti);
+            }
+        }
+    }
+}
+
+
+// complex spectrum of the even/odd samples to the real spectrum
+// ws[k] = (cos, sin)(2 pi k / n), k <= nc / 2
+template <u32 L>
+static BATCH_INLINE void batch_rft_split(u32 nc, f32* a, f32 const* ws)
+{
+    using V = typename Lanes<L>::type;
+
+    constexpr u32 C = 2 * L;
+
+    V r0, i0;
+    load(r0, a);
+    load(i0, a + L);
+
+    store(a, r0 + i0);
+    store(a + L, r0 - i0);
+
+    for (u32 k = 1; k <= nc / 2; k++)
+    {
+        auto c = ws[2 * k];
+        auto s = ws[2 * k + 1];
+
+        auto zk = a + k * C;
+        auto zm = a + (nc - k) * C;
+
+        V zr, zi, mr, mi;
+        load(zr, zk);
+        load(zi, zk + L);
+        load(mr, zm);
+        load(mi, zm + L);
+
+        V er = 0.5f * (zr + mr);
+        V ei = 0.5f * (zi - mi);
+        V or_ = 0.5f * (zr - mr);
+        V oi = 0.5f * (zi + mi);
+
+        // -i * exp(-2 pi i k / n) * O
+        V pr = c * oi - s * or_;
+        V pi = -(c * or_ + s * oi);
+
+        // X[k] = E + P, X[nc - k] = conj(E - P), stored with the imaginary part negated
+        store(zm, er - pr);
+        store(zm + L, ei - pi);
+        store(zk, er + pr);
+        store(zk + L, -(ei + pi));
+    }
+}
+
+
+template <u32 L>
+static BATCH_INLINE void batch_magnitude(u32 n, f32* a, f32* bins, u32 n_bins)
+{
+    using V = typename Lanes<L>::type;
+
+    constexpr u32 C = 2 * L;
+
+    for (u32 k = 1; k < n / 2; k++)
+    {
+        V re, im;
+        load(re, a + k * C);
+        load(im, a + k * C + L);
+
+        f32 mag[L];
+        store(mag, re * re + im * im);
+
+#ifdef FFT_SIMD_128
+        for (u32 q = 0; q < L; q += 4)
+        {
+            _mm_storeu_ps(mag + q, _mm_sqrt_ps(_mm_loadu_ps(mag + q)));
+        }
+#else
+        for (u32 l = 0; l < L; l++)
+        {
+            mag[l] = num::sqrt(mag[l]);
+        }
+#endif
+
+        for (u32 l = 0; l < L; l++)
+        {
+            bins[l * n_bins + k - 1] = mag[l];
+        }
+    }
+}
+
+
+template <u32 L>
+static BATCH_INLINE void batch_forward(u32 n, f32* a, u32 const* rev, f32 const* tw, f32 const* ws, f32* bins)
+{
+    auto nc = n / 2;
+
+    batch_bitrv<L>(nc, a, rev);
+    batch_cft<L>(nc, a, tw);
+    batch_rft_split<L>(nc, a, ws);
+
+    if (bins)
+    {
+        batch_magnitude<L>(n, a, bins, nc - 1);
+    }
+}
+
+
+/* entry points */
+
+static void batch_forward_x4(u32 n, f32* a, u32 const* rev, f32 const* tw, f32 const* ws, f32* bins)
+{
+    batch_forward<4>(n, a, rev, tw, ws, bins);
+}
+
+
+static void batch_forward_x8(u32 n, f32* a, u32 const* rev, f32 const* tw, f32 const* ws, f32* bins)
+{
+    batch_forward<8>(n, a, rev, tw, ws, bins);
+}
+
+
+static void batch_forward_x16(u32 n, f32* a, u32 const* rev, f32 const* tw, f32 const* ws, f32* bins)
+{
+    batch_forward<16>(n, a, rev, tw, ws, bins);
+}
+
+
+#ifdef FFT_SIMD_256
+
+CPU_TARGET_AVX2
+static void batch_forward_x8_256(u32 n, f32* a, u32 const* rev, f32 const* tw, f32 const* ws, f32* bins)
+{
+    batch_forward<8>(n, a, rev, tw, ws, bins);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX2
+static void batch_forward_x16_256(u32 n, f32* a, u32 const* rev, f32 const* tw, f32 const* ws, f32* bins)
+{
+    batch_forward<16>(n, a, rev, tw, ws, bins);
+
+    _mm256_zeroupper();
+}
+
+#endif
+
+
+#ifdef FFT_SIMD_512
+
+CPU_TARGET_AVX512
+static void batch_forward_x16_512(u32 n, f32* a, u32 const* rev, f32 const* tw, f32 const* ws, f32* bins)
+{
+    batch_forward<16>(n, a, rev, tw, ws, bins);
+
+    _mm256_zeroupper();
+}
+
+#endif
+
+
+#undef BATCH_INLINE
+
+
+/* deinterleave */
+
+// frames[c][i] = src[i * n_channels + c], begin <= i < end
+static void deinterleave_range(f32 const* src, f32* const* frames, u32 begin, u32 end, u32 n_channels)
+{
+    for (u32 i = begin; i < end; i++)
+    {
+        for (u32 c = 0; c < n_channels; c++)
+        {
+            frames[c][i] = src[i * n_channels + c];
+        }
+    }
+}
+
+
+static void deinterleave_scalar(f32 const* src, f32* const* frames, u32 n, u32 n_channels)
+{
+    deinterleave_range(src, frames, 0, n, n_channels);
+}
+
+
+#ifdef FFT_SIMD_256
+
+CPU_TARGET_AVX2
+static void deinterleave_x2_256(f32 const* src, f32* const* frames, u32 n, u32 n_channels)
+{
+    auto left = frames[0];
+    auto right = frames[1];
+
+    u32 i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto a = _mm256_loadu_ps(src + 2 * i);
+        auto b = _mm256_loadu_ps(src + 2 * i + 8);
+
+        // (0 1 4 5 | 2 3 6 7)
+        auto l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        auto r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+        l = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0)));
+        r = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0)));
+
+        _mm256_storeu_ps(left + i, l);
+        _mm256_storeu_ps(right + i, r);
+    }
+
+    _mm256_zeroupper();
+    deinterleave_range(src, frames, i, n, n_channels);
+}
+
+
+// n_channels a multiple of 8, 8 x 8 blocks transposed in registers
+CPU_TARGET_AVX2
+static void deinterleave_x8_256(f32 const* src, f32* const* frames, u32 n, u32 n_channels)
+{
+    u32 i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        for (u32 c = 0; c < n_channels; c += 8)
+        {
+            auto p = src + i * n_channels + c;
+
+            auto r0 = _mm256_loadu_ps(p);
+            auto r1 = _mm256_loadu_ps(p + n_channels);
+            auto r2 = _mm256_loadu_ps(p + 2 * n_channels);
+            auto r3 = _mm256_loadu_ps(p + 3 * n_channels);
+            auto r4 = _mm256_loadu_ps(p + 4 * n_channels);
+            auto r5 = _mm256_loadu_ps(p + 5 * n_channels);
+            auto r6 = _mm256_loadu_ps(p + 6 * n_channels);
+            auto r7 = _mm256_loadu_ps(p + 7 * n_channels);
+
+            auto t0 = _mm256_unpacklo_ps(r0, r1);
+            auto t1 = _mm256_unpackhi_ps(r0, r1);
+            auto t2 = _mm256_unpacklo_ps(r2, r3);
+            auto t3 = _mm256_unpackhi_ps(r2, r3);
+            auto t4 = _mm256_unpacklo_ps(r4, r5);
+            auto t5 = _mm256_unpackhi_ps(r4, r5);
+            auto t6 = _mm256_unpacklo_ps(r6, r7);
+            auto t7 = _mm256_unpackhi_ps(r6, r7);
+
+            auto s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            auto s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            auto s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            auto s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            auto s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+            auto s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+            auto s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+            auto s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+            _mm256_storeu_ps(frames[c] + i, _mm256_permute2f128_ps(s0, s4, 0x20));
+            _mm256_storeu_ps(frames[c + 1] + i, _mm256_permute2f128_ps(s1, s5, 0x20));
+            _mm256_storeu_ps(frames[c + 2] + i, _mm256_permute2f128_ps(s2, s6, 0x20));
+            _mm256_storeu_ps(frames[c + 3] + i, _mm256_permute2f128_ps(s3, s7, 0x20));
+            _mm256_storeu_ps(frames[c + 4] + i, _mm256_permute2f128_ps(s0, s4, 0x31));
+            _mm256_storeu_ps(frames[c + 5] + i, _mm256_permute2f128_ps(s1, s5, 0x31));
+            _mm256_storeu_ps(frames[c + 6] + i, _mm256_permute2f128_ps(s2, s6, 0x31));
+            _mm256_storeu_ps(frames[c + 7] + i, _mm256_permute2f128_ps(s3, s7, 0x31));
+        }
+    }
+
+    _mm256_zeroupper();
+    deinterleave_range(src, frames, i, n, n_channels);
+}
+
+
+// any channel count, 8 samples of a channel per gather
+CPU_TARGET_AVX2
+static void deinterleave_gather_256(f32 const* src, f32* const* frames, u32 n, u32 n_channels)
+{
+    auto idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)n_channels));
+
+    u32 i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto p = src + i * n_channels;
+
+        for (u32 c = 0; c < n_channels; c++)
+        {
+            _mm256_storeu_ps(frames[c] + i, _mm256_i32gather_ps(p + c, idx, 4));
+        }
+    }
+
+    _mm256_zeroupper();
+    deinterleave_range(src, frames, i, n, n_channels);
+}
+
+#endif
@@ -0,0 +1,301 @@
+// Straight-line real FFTs for the small sizes, N = 4 to CODELET_MAX_SIZE
+// Same layout and scaling as rdft_forward/rdft_inverse
+// A complex FFT of N / 2 points on the even/odd sample pairs followed by the real split
+// The complex FFT is recursive radix-2, every butterfly is its own template instance with
+// its twiddle as a compile time constant, so the whole transform inlines to straight-line code
+
+
+#define CODELET_INLINE inline __attribute__((always_inline))
+
+
+static constexpr f64 codelet_sin(f64 x)
+{
+    // |x| <= pi
+    f64 term = x;
+    f64 sum = x;
+    for (int i = 1; i < 16; i++)
+    {
+        term *= -x * x / ((2 * i) * (2 * i + 1));
+        sum += term;
+    }
+
+    return sum;
+}
+
+
+static constexpr f64 codelet_cos(f64 x)
+{
+    f64 term = 1.0;
+    f64 sum = 1.0;
+    for (int i = 1; i < 16; i++)
+    {
+        term *= -x * x / ((2 * i - 1) * (2 * i));
+        sum += term;
+    }
+
+    return sum;
+}
+
+
+// exp(-2 pi i k / M), k < M / 2
+template <u32 M>
+class CodeletTwiddles
+{
+public:
+    f32 re[M / 2] = {};
+    f32 im[M / 2] = {};
+};
+
+
+template <u32 M>
+static constexpr CodeletTwiddles<M> make_codelet_twiddles()
+{
+    CodeletTwiddles<M> tw{};
+
+    for (u32 k = 0; k < M / 2; k++)
+    {
+        auto t = 2.0 * num::PI * k / M;
+        tw.re[k] = (f32)codelet_cos(t);
+        tw.im[k] = (f32)-codelet_sin(t);
+    }
+
+    return tw;
+}
+
+
+template <u32 M>
+static constexpr CodeletTwiddles<M> codelet_twiddles = make_codelet_twiddles<M>();
+
+
+// out[K] and out[K + M / 2] from the half size transforms in place
+template <u32 M, u32 K, bool INV>
+static CODELET_INLINE void codelet_bfly(f32* out)
+{
+    constexpr u32 H = M / 2;
+
+    auto er = out[2 * K];
+    auto ei = out[2 * K + 1];
+    auto br = out[2 * (K + H)];
+    auto bi = out[2 * (K + H) + 1];
+
+    f32 tr = br;
+    f32 ti = bi;
+
+    if constexpr (K == 0)
+    {
+    }
+    else if constexpr (4 * K == M)
+    {
+        // -i forward, +i inverse
+        tr = INV ? -bi : bi;
+        ti = INV ? br : -br;
+    }
+    else
+    {
+        constexpr f32 wr = codelet_twiddles<M>.re[K];
+        constexpr f32 wi = INV ? -codelet_twiddles<M>.im[K] : codelet_twiddles<M>.im[K];
+
+        tr = wr * br - wi * bi;
+        ti = wr * bi + wi * br;
+    }
+
+    out[2 * K] = er + tr;
+    out[2 * K + 1] = ei + ti;
+    out[2 * (K + H)] = er - tr;
+    out[2 * (K + H) + 1] = ei - ti;
+}
+
+
+template <u32 M, bool INV, u32... K>
+static CODELET_INLINE void codelet_bflys(f32* out, std::integer_sequence<u32, K...>)
+{
+    (codelet_bfly<M, K, INV>(out), ...);
+}
+
+
+// out[k] = sum_j in[j * S] exp(-+2 pi i j k / M), complex interleaved, unscaled
+template <u32 M, u32 S, bool INV>
+static CODELET_INLINE void codelet_cft(f32 const* in, f32* out)
+{
+    if constexpr (M == 1)
+    {
+        out[0] = in[0];
+        out[1] = in[1];
+    }
+    else
+    {
+        constexpr u32 H = M / 2;
+
+        codelet_cft<H, 2 * S, INV>(in, out);
+        codelet_cft<H, 2 * S, INV>(in + 2 * S, out + 2 * H);
+
+        codelet_bflys<M, INV>(out, std::make_integer_sequence<u32, H>{});
+    }
+}
+
+
+// X[K] and X[M - K] from Z[K] and Z[M - K], N = 2M
+template <u32 N, u32 K>
+static CODELET_INLINE void codelet_rft_split(f32 const* z, f32* a)
+{
+    constexpr u32 M = N / 2;
+    constexpr u32 J = M - K;
+
+    constexpr f32 c = codelet_twiddles<N>.re[K];
+    constexpr f32 s = -codelet_twiddles<N>.im[K];
+
+    auto zkr = z[2 * K];
+    auto zki = z[2 * K + 1];
+    auto zjr = z[2 * J];
+    auto zji = z[2 * J + 1];
+
+    // E = (Z[K] + conj Z[J]) / 2, O = (Z[K] - conj Z[J]) / 2i
+    auto er = 0.5f * (zkr + zjr);
+    auto ei = 0.5f * (zki - zji);
+    auto or_ = 0.5f * (zki + zji);
+    auto oi = 0.5f * (zjr - zkr);
+
+    // P = exp(-2 pi i K / N) O
+    auto pr = c * or_ + s * oi;
+    auto pi = c * oi - s * or_;
+
+    // X[K] = E + P, X[J] = conj(E - P), stored with the imaginary part negated
+    a[2 * K] = er + pr;
+    a[2 * K + 1] = -(ei + pi);
+
+    if constexpr (J != K)
+    {
+        a[2 * J] = er - pr;
+        a[2 * J + 1] = ei - pi;
+    }
+}
+
+
+// Z[K] and Z[M - K] from X[K] and X[M - K], inverse of codelet_rft_split
+template <u32 N, u32 K>
+static CODELET_INLINE void codelet_rft_join(f32 const* a, f32* z)
+{
+    constexpr u32 M = N / 2;
+    constexpr u32 J = M - K;
+
+    constexpr f32 c = codelet_twiddles<N>.re[K];
+    constexpr f32 s = -codelet_twiddles<N>.im[K];
+
+    auto xkr = a[2 * K];
+    auto xki = -a[2 * K + 1];
+    auto xjr = a[2 * J];
+    auto xji = -a[2 * J + 1];
+
+    // E = (X[K] + conj X[J]) / 2, D = (X[K] - conj X[J]) / 2
+    auto er = 0.5f * (xkr + xjr);
+    auto ei = 0.5f * (xki - xji);
+    auto dr = 0.5f * (xkr - xjr);
+    auto di = 0.5f * (xki + xji);
+
+    // O = exp(2 pi i K / N) D
+    auto or_ = c * dr - s * di;
+    auto oi = c * di + s * dr;
+
+    // Z[K] = E + iO, Z[J] = conj E + i conj O
+    z[2 * K] = er - oi;
+    z[2 * K + 1] = ei + or_;
+
+    if constexpr (J != K)
+    {
+        z[2 * J] = er + oi;
+        z[2 * J + 1] = or_ - ei;
+    }
+}
+
+
+template <u32 N, u32... K>
+static CODELET_INLINE void codelet_rft_splits(f32 const* z, f32* a, std::integer_sequence<u32, K...>)
+{
+    (codelet_rft_split<N, K + 1>(z, a), ...);
+}
+
+
+template <u32 N, u32... K>
+static CODELET_INLINE void codelet_rft_joins(f32 const* a, f32* z, std::integer_sequence<u32, K...>)
+{
+    (codelet_rft_join<N, K + 1>(a, z), ...);
+}
+
+
+template <u32 N>
+void codelet_forward(f32 const* src, f32* dst)
+{
+    static_assert(N >= 4 && N <= CODELET_MAX_SIZE && num::is_power_of_2(N));
+
+    constexpr u32 M = N / 2;
+
+    f32 z[N];
+    codelet_cft<M, 1, false>(src, z);
+
+    dst[0] = z[0] + z[1];
+    dst[1] = z[0] - z[1];
+
+    codelet_rft_splits<N>(z, dst, std::make_integer_sequence<u32, M / 2>{});
+}
+
+
+template <u32 N>
+void codelet_inverse(f32 const* src, f32* dst)
+{
+    static_assert(N >= 4 && N <= CODELET_MAX_SIZE && num::is_power_of_2(N));
+
+    constexpr u32 M = N / 2;
+
+    f32 z[N];
+    z[0] = 0.5f * (src[0] + src[1]);
+    z[1] = 0.5f * (src[0] - src[1]);
+
+    codelet_rft_joins<N>(src, z, std::make_integer_sequence<u32, M / 2>{});
+
+    codelet_cft<M, 1, true>(z, dst);
+}
+
+
+template void codelet_forward<4>(f32 const* src, f32* dst);
+template void codelet_forward<8>(f32 const* src, f32* dst);
+template void codelet_forward<16>(f32 const* src, f32* dst);
+template void codelet_forward<32>(f32 const* src, f32* dst);
+template void codelet_forward<64>(f32 const* src, f32* dst);
+
+template void codelet_inverse<4>(f32 const* src, f32* dst);
+template void codelet_inverse<8>(f32 const* src, f32* dst);
+template void codelet_inverse<16>(f32 const* src, f32* dst);
+template void codelet_inverse<32>(f32 const* src, f32* dst);
+template void codelet_inverse<64>(f32 const* src, f32* dst);
+
+
+// runtime selection by size, false if n has no codelet
+static bool codelet_forward(u32 n, f32 const* src, f32* dst)
+{
+    switch (n)
+    {
+    case 4: codelet_forward<4>(src, dst); return true;
+    case 8: codelet_forward<8>(src, dst); return true;
+    case 16: codelet_forward<16>(src, dst); return true;
+    case 32: codelet_forward<32>(src, dst); return true;
+    case 64: codelet_forward<64>(src, dst); return true;
+    default: return false;
+    }
+}
+
+
+static bool codelet_inverse(u32 n, f32 const* src, f32* dst)
+{
+    switch (n)
+    {
+    case 4: codelet_inverse<4>(src, dst); return true;
+    case 8: codelet_inverse<8>(src, dst); return true;
+    case 16: codelet_inverse<16>(src, dst); return true;
+    case 32: codelet_inverse<32>(src, dst); return true;
+    case 64: codelet_inverse<64>(src, dst); return true;
+    default: return false;
+    }
+}
+
+
+#undef CODELET_INLINE
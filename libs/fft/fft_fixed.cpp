@@ -0,0 +1,418 @@
+// Block floating point real FFT of S16 samples, same layout and scaling as rdft_forward
+// with the samples taken as s / 32768
+// The sample pairs are read as they were captured as n / 2 complex Q15 points. Radix-2 Stockham
+// passes run on int16, every pass shifts its input so that no component exceeds FIXED_MAX,
+// a pass grows a component by at most 2 sqrt(2) so its output stays in range.
+// The shifts add up to the block exponent, the last pass is scaled to f32 for the real split
+// tw: for s = 1, 2, 4, nc / 2 entries (re, re) then nc / 2 entries (-im, im) of exp(-2 pi i t / nc)
+// in Q15, t = (j / s) s for entry j. The passes with s >= 8 read entry p s of the s = 1 tables
+
+
+#define FIXED_INLINE inline __attribute__((always_inline))
+
+
+// largest component a pass takes as input, 32767 / (2 sqrt(2))
+static constexpr i32 FIXED_MAX = 11584;
+
+
+static constexpr u32 fixed_tw_size(u32 nc)
+{
+    return 6 * nc;
+}
+
+
+// k > 0: right shift by k with rounding, k < 0: left shift by -k
+// the largest component after the shift is at most FIXED_MAX
+static int fixed_block_shift(i32 max)
+{
+    if (max == 0)
+    {
+        return 0;
+    }
+
+    int k = 0;
+    while (((max + (1 << k) - 1) >> k) > FIXED_MAX)
+    {
+        k++;
+    }
+
+    if (k)
+    {
+        return k;
+    }
+
+    while ((max << (1 - k)) <= FIXED_MAX)
+    {
+        k--;
+    }
+
+    return k;
+}
+
+
+static void fixed_create_twiddles(u32 nc, i16* tw)
+{
+    constexpr f64 TP = 2.0 * num::PI;
+
+    auto half = num::max(nc / 2, 1u);
+
+    for (u32 g = 0; g < 3; g++)
+    {
+        auto s = 1u << g;
+
+        auto wrr = tw + 2 * g * nc;
+        auto wii = wrr + nc;
+
+        for (u32 j = 0; j < half; j++)
+        {
+            auto t = j / s * s;
+            auto wr = (i16)std::lround(32767.0 * std::cos(TP * t / nc));
+            auto wi = (i16)std::lround(-32767.0 * std::sin(TP * t / nc));
+
+            wrr[2 * j] = wr;
+            wrr[2 * j + 1] = wr;
+            wii[2 * j] = (i16)-wi;
+            wii[2 * j + 1] = wi;
+        }
+    }
+}
+
+
+/* scalar */
+
+static FIXED_INLINE i32 fixed_mulhrs(i32 a, i32 b)
+{
+    return (a * b + 0x4000) >> 15;
+}
+
+
+static FIXED_INLINE i32 fixed_scale(i32 v, int k)
+{
+    if (k > 0)
+    {
+        return fixed_mulhrs(v, 1 << (15 - k));
+    }
+
+    return v * (1 << -k);
+}
+
+
+static FIXED_INLINE i32 fixed_abs(i32 v)
+{
+    return v < 0 ? -v : v;
+}
+
+
+// one radix-2 pass, returns the largest component written
+static i32 fixed_pass_scalar(u32 nc, u32 s, i16 const* x, i16* y, i16 const* tw, int k)
+{
+    auto half = nc / 2;
+    auto wrr = tw + (s < 8 ? 2 * __builtin_ctz(s) * nc : 0);
+    auto wii = wrr + nc;
+
+    i32 max = 0;
+
+    for (u32 j = 0; j < half; j++)
+    {
+        auto p = j / s;
+        auto e = s < 8 ? j : p * s;
+        auto o = j + p * s;
+
+        auto ar = fixed_scale(x[2 * j], k);
+        auto ai = fixed_scale(x[2 * j + 1], k);
+        auto br = fixed_scale(x[2 * (j + half)], k);
+        auto bi = fixed_scale(x[2 * (j + half) + 1], k);
+
+        auto dr = ar - br;
+        auto di = ai - bi;
+
+        auto sr = ar + br;
+        auto si = ai + bi;
+        auto pr = fixed_mulhrs(dr, wrr[2 * e]) + fixed_mulhrs(di, wii[2 * e]);
+        auto pi = fixed_mulhrs(di, wrr[2 * e + 1]) + fixed_mulhrs(dr, wii[2 * e + 1]);
+
+        y[2 * o] = (i16)sr;
+        y[2 * o + 1] = (i16)si;
+        y[2 * (o + s)] = (i16)pr;
+        y[2 * (o + s) + 1] = (i16)pi;
+
+        max = num::max(max, num::max(num::max(fixed_abs(sr), fixed_abs(si)), num::max(fixed_abs(pr), fixed_abs(pi))));
+    }
+
+    return max;
+}
+
+
+static i32 fixed_max_scalar(i16 const* x, u32 len)
+{
+    i32 max = 0;
+    for (u32 i = 0; i < len; i++)
+    {
+        max = num::max(max, fixed_abs(x[i]));
+    }
+
+    return max;
+}
+
+
+static void fixed_to_f32_scalar(i16 const* x, f32* dst, u32 len, f32 scale)
+{
+    for (u32 i = 0; i < len; i++)
+    {
+        dst[i] = scale * x[i];
+    }
+}
+
+
+/* avx2 */
+
+#ifdef FFT_SIMD_256
+
+CPU_TARGET_AVX2
+static FIXED_INLINE i32 fixed_hmax_256(__m256i v)
+{
+    auto m = _mm_max_epu16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    m = _mm_max_epu16(m, _mm_srli_si128(m, 8));
+    m = _mm_max_epu16(m, _mm_srli_si128(m, 4));
+    m = _mm_max_epu16(m, _mm_srli_si128(m, 2));
+
+    return _mm_extract_epi16(m, 0);
+}
+
+
+CPU_TARGET_AVX2
+static FIXED_INLINE __m256i fixed_scale_256(__m256i v, int k, __m256i mul, __m128i sll)
+{
+    if (k > 0)
+    {
+        return _mm256_mulhrs_epi16(v, mul);
+    }
+
+    return _mm256_sll_epi16(v, sll);
+}
+
+
+// a + b, (a - b) w
+CPU_TARGET_AVX2
+static FIXED_INLINE void fixed_butterfly_256(__m256i a, __m256i b, __m256i wrr, __m256i wii, __m256i& sum, __m256i& prod)
+{
+    auto d = _mm256_sub_epi16(a, b);
+    auto d_sw = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(d, 0xB1), 0xB1);
+
+    sum = _mm256_add_epi16(a, b);
+    prod = _mm256_add_epi16(_mm256_mulhrs_epi16(d, wrr), _mm256_mulhrs_epi16(d_sw, wii));
+}
+
+
+CPU_TARGET_AVX2
+static i32 fixed_pass_256(u32 nc, u32 s, i16 const* x, i16* y, i16 const* tw, int k)
+{
+    auto half = nc / 2;
+
+    auto mul = _mm256_set1_epi16((i16)(k > 0 ? 1 << (15 - k) : 0));
+    auto sll = _mm_cvtsi32_si128(k < 0 ? -k : 0);
+
+    auto max = _mm256_setzero_si256();
+
+    if (s >= 8)
+    {
+        auto m = half / s;
+
+        for (u32 p = 0; p < m; p++)
+        {
+            i32 wr, wi;
+            __builtin_memcpy(&wr, tw + 2 * p * s, sizeof(wr));
+            __builtin_memcpy(&wi, tw + nc + 2 * p * s, sizeof(wi));
+
+            auto wrr = _mm256_set1_epi32(wr);
+            auto wii = _mm256_set1_epi32(wi);
+
+            for (u32 q = 0; q < s; q += 8)
+            {
+                auto j = p * s + q;
+
+                auto a = _mm256_loadu_si256((__m256i const*)(x + 2 * j));
+                auto b = _mm256_loadu_si256((__m256i const*)(x + 2 * (j + half)));
+                if (k)
+                {
+                    a = fixed_scale_256(a, k, mul, sll);
+                    b = fixed_scale_256(b, k, mul, sll);
+                }
+
+                __m256i sum, prod;
+                fixed_butterfly_256(a, b, wrr, wii, sum, prod);
+
+                _mm256_storeu_si256((__m256i*)(y + 2 * (j + p * s)), sum);
+                _mm256_storeu_si256((__m256i*)(y + 2 * (j + p * s + s)), prod);
+
+                max = _mm256_max_epu16(max, _mm256_abs_epi16(sum));
+                max = _mm256_max_epu16(max, _mm256_abs_epi16(prod));
+            }
+        }
+    }
+    else
+    {
+        auto wrr_s = tw + 2 * __builtin_ctz(s) * nc;
+        auto wii_s = wrr_s + nc;
+
+        for (u32 j = 0; j < half; j += 8)
+        {
+            auto a = _mm256_loadu_si256((__m256i const*)(x + 2 * j));
+            auto b = _mm256_loadu_si256((__m256i const*)(x + 2 * (j + half)));
+            if (k)
+            {
+                a = fixed_scale_256(a, k, mul, sll);
+                b = fixed_scale_256(b, k, mul, sll);
+            }
+
+            auto wrr = _mm256_loadu_si256((__m256i const*)(wrr_s + 2 * j));
+            auto wii = _mm256_loadu_si256((__m256i const*)(wii_s + 2 * j));
+
+            __m256i sum, prod;
+            fixed_butterfly_256(a, b, wrr, wii, sum, prod);
+
+            max = _mm256_max_epu16(max, _mm256_abs_epi16(sum));
+            max = _mm256_max_epu16(max, _mm256_abs_epi16(prod));
+
+            // s sums then s products for each p
+            __m256i lo, hi;
+            if (s == 1)
+            {
+                lo = _mm256_unpacklo_epi32(sum, prod);
+                hi = _mm256_unpackhi_epi32(sum, prod);
+            }
+            else if (s == 2)
+            {
+                lo = _mm256_unpacklo_epi64(sum, prod);
+                hi = _mm256_unpackhi_epi64(sum, prod);
+            }
+            else
+            {
+                lo = sum;
+                hi = prod;
+            }
+
+            _mm256_storeu_si256((__m256i*)(y + 4 * j), _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256((__m256i*)(y + 4 * j + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+    }
+
+    return fixed_hmax_256(max);
+}
+
+
+// len a multiple of 16
+CPU_TARGET_AVX2
+static i32 fixed_max_256(i16 const* x, u32 len)
+{
+    auto max = _mm256_setzero_si256();
+    for (u32 i = 0; i < len; i += 16)
+    {
+        max = _mm256_max_epu16(max, _mm256_abs_epi16(_mm256_loadu_si256((__m256i const*)(x + i))));
+    }
+
+    return fixed_hmax_256(max);
+}
+
+
+// len a multiple of 16
+CPU_TARGET_AVX2
+static void fixed_to_f32_256(i16 const* x, f32* dst, u32 len, f32 scale)
+{
+    auto sc = _mm256_set1_ps(scale);
+
+    for (u32 i = 0; i < len; i += 16)
+    {
+        auto v = _mm256_loadu_si256((__m256i const*)(x + i));
+
+        auto lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v)));
+        auto hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1)));
+
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(lo, sc));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(hi, sc));
+    }
+}
+
+#endif
+
+
+/* entry points */
+
+// the complex FFT of the nc sample pairs of src to dst as f32 (re, im), scaled to s / 32768
+// work holds 4 nc values
+template <class PASS, class MAX, class TO_F32>
+static FIXED_INLINE void fixed_cft(u32 nc, i16 const* src, f32* dst, i16* work, i16 const* tw, PASS const& pass, MAX const& block_max, TO_F32 const& to_f32)
+{
+    auto x = src;
+    auto y = work;
+    auto z = work + 2 * nc;
+
+    auto k = fixed_block_shift(block_max(src, 2 * nc));
+    auto exp = k;
+
+    for (u32 s = 1; s < nc; s *= 2)
+    {
+        auto max = pass(nc, s, x, y, tw, k);
+
+        x = y;
+        y = z;
+        z = (i16*)x;
+
+        k = fixed_block_shift(max);
+        exp += k;
+    }
+
+    // the last pass is not shifted
+    exp -= k;
+
+    to_f32(x, dst, 2 * nc, std::ldexp(1.0f, exp - 15));
+}
+
+
+static void fixed_cft_scalar(u32 nc, i16 const* src, f32* dst, i16* work, i16 const* tw)
+{
+    fixed_cft(nc, src, dst, work, tw, fixed_pass_scalar, fixed_max_scalar, fixed_to_f32_scalar);
+}
+
+
+#ifdef FFT_SIMD_256
+
+CPU_TARGET_AVX2
+static void fixed_cft_256(u32 nc, i16 const* src, f32* dst, i16* work, i16 const* tw)
+{
+    if (nc < 16)
+    {
+        fixed_cft_scalar(nc, src, dst, work, tw);
+        return;
+    }
+
+    fixed_cft(nc, src, dst, work, tw, fixed_pass_256, fixed_max_256, fixed_to_f32_256);
+
+    _mm256_zeroupper();
+}
+
+#endif
+
+
+/* dispatch */
+
+// the scalar kernel until bind_fixed_kernels runs
+static void (*fixed_cft_kernel)(u32 nc, i16 const* src, f32* dst, i16* work, i16 const* tw) = fixed_cft_scalar;
+
+
+// no 128 bit kernel, mulhrs is SSSE3. AVX512F has no 16 bit lanes, the AVX2 kernel runs there
+static void bind_fixed_kernels(cpu::SIMD simd)
+{
+#ifdef FFT_SIMD_256
+    if (simd >= cpu::SIMD::AVX2)
+    {
+        fixed_cft_kernel = fixed_cft_256;
+        return;
+    }
+#endif
+
+    fixed_cft_kernel = fixed_cft_scalar;
+}
+
+
+#undef FIXED_INLINE
@@ -0,0 +1,311 @@
+// Six-step complex FFT for the transforms larger than the caches, the real split on top
+// nc = n1 * n2 complex points, z[j1 * n2 + j2] viewed as n1 rows of n2
+//   transpose to n2 rows of n1, FFT each row, multiply row j2 by exp(-2 pi i j2 k1 / nc)
+//   transpose to n1 rows of n2, FFT each row, transpose to the output order
+// Every row transform works on a row in L1 with the Stockham passes, transposes go tile by tile
+// The driver in fft.cpp splits the rows and tiles across the thread pool
+
+
+#define FOURSTEP_INLINE inline __attribute__((always_inline))
+
+
+// longest row, n1 for the largest plan
+static constexpr u32 FOURSTEP_MAX_ROW = 1u << (PLAN_MAX_EXP / 2);
+
+// complex values per side of a transpose tile
+static constexpr u32 FOURSTEP_TILE = 16;
+
+
+// exp(-2 pi i m / nc) = lo[m % n_lo] hi[m / n_lo], both tables exact
+class FourStepTwiddles
+{
+public:
+    u32 lo_bits = 0;
+
+    f32 const* lo = 0;
+    f32 const* hi = 0;
+};
+
+
+static FOURSTEP_INLINE void fourstep_twiddle(u32 m, FourStepTwiddles const& tt, f32& re, f32& im)
+{
+    auto l = tt.lo + 2 * (m & ((1u << tt.lo_bits) - 1));
+    auto h = tt.hi + 2 * (m >> tt.lo_bits);
+
+    re = l[0] * h[0] - l[1] * h[1];
+    im = l[0] * h[1] + l[1] * h[0];
+}
+
+
+// row j2 of len values times exp(-+2 pi i j2 k1 / nc)
+// exact every RESYNC vectors, stepped by complex multiplication in between
+template <u32 L, bool INV>
+static FOURSTEP_INLINE void fourstep_twiddle_row(u32 len, f32* row, u32 j2, FourStepTwiddles const& tt)
+{
+    using V = typename Lanes<L>::type;
+
+    constexpr u32 QV = L / 2;
+    constexpr u32 RESYNC = 16;
+
+    ComplexLanes<L> cl;
+
+    // r = w^j2 for the lanes 0 to QV - 1, step = w^(j2 QV)
+    V r, step;
+    for (u32 i = 0; i < QV; i++)
+    {
+        f32 re, im;
+        fourstep_twiddle(j2 * i, tt, re, im);
+        r[2 * i] = re;
+        r[2 * i + 1] = im;
+
+        fourstep_twiddle(j2 * QV, tt, re, im);
+        step[2 * i] = re;
+        step[2 * i + 1] = im;
+    }
+
+    V w = r;
+
+    for (u32 k = 0; k < len; k += QV)
+    {
+        if (k % (RESYNC * QV) == 0)
+        {
+            f32 br, bi;
+            fourstep_twiddle(j2 * k, tt, br, bi);
+
+            V base;
+            for (u32 i = 0; i < QV; i++)
+            {
+                base[2 * i] = br;
+                base[2 * i + 1] = bi;
+            }
+
+            cmul(w, r, base, cl);
+        }
+
+        V v, t;
+        load(v, row + 2 * k);
+
+        if constexpr (INV)
+        {
+            cmul(t, v, w * cl.conj, cl);
+        }
+        else
+        {
+            cmul(t, v, w, cl);
+        }
+
+        store(row + 2 * k, t);
+
+        V next;
+        cmul(next, w, step, cl);
+        w = next;
+    }
+}
+
+
+// rows r_begin to r_end - 1 of len complex values, transformed in place
+// tt is 0 for the second set of rows, no twiddles
+template <u32 L, bool INV>
+static FOURSTEP_INLINE void fourstep_rows(u32 len, f32* a, u32 r_begin, u32 r_end, f32 const* tw, FourStepTwiddles const* tt)
+{
+    f32 scratch[2 * FOURSTEP_MAX_ROW];
+
+    for (u32 r = r_begin; r < r_end; r++)
+    {
+        auto row = a + 2 * len * r;
+
+        auto res = stockham_cft<L, INV>(len, row, scratch, row, tw);
+        if (res != row)
+        {
+            __builtin_memcpy(row, res, 2 * len * sizeof(f32));
+        }
+
+        if (tt)
+        {
+            fourstep_twiddle_row<L, INV>(len, row, r, *tt);
+        }
+    }
+}
+
+
+// src rows r_begin to r_end - 1 of rows x cols complex values to dst columns
+// one complex value is one 8 byte move, the inner loop writes a tile column contiguously
+static void fourstep_transpose(f32 const* src, f32* dst, u32 rows, u32 cols, u32 r_begin, u32 r_end)
+{
+    constexpr u32 T = FOURSTEP_TILE;
+
+    for (u32 r0 = r_begin; r0 < r_end; r0 += T)
+    {
+        auto r1 = num::min(r0 + T, r_end);
+
+        for (u32 c0 = 0; c0 < cols; c0 += T)
+        {
+            auto c1 = num::min(c0 + T, cols);
+
+            for (u32 c = c0; c < c1; c++)
+            {
+                auto s = src + 2 * c;
+                auto d = dst + 2 * ((u64)c * rows);
+                for (u32 r = r0; r < r1; r++)
+                {
+                    __builtin_memcpy(d + 2 * r, s + 2 * ((u64)r * cols), 2 * sizeof(f32));
+                }
+            }
+        }
+    }
+}
+
+
+/* entry points */
+
+static void fourstep_rows_forward_x4(u32 len, f32* a, u32 r_begin, u32 r_end, f32 const* tw, FourStepTwiddles const* tt)
+{
+    fourstep_rows<4, false>(len, a, r_begin, r_end, tw, tt);
+}
+
+
+static void fourstep_rows_inverse_x4(u32 len, f32* a, u32 r_begin, u32 r_end, f32 const* tw, FourStepTwiddles const* tt)
+{
+    fourstep_rows<4, true>(len, a, r_begin, r_end, tw, tt);
+}
+
+
+static void fourstep_split_x4(u32 nc, f32 const* z, f32* a, f32 const* ws, u32 k_begin, u32 k_end)
+{
+    stockham_rft_split<4>(nc, z, a, ws, k_begin, k_end);
+}
+
+
+static void fourstep_join_x4(u32 nc, f32 const* a, f32* z, f32 const* ws, u32 k_begin, u32 k_end)
+{
+    stockham_rft_join<4>(nc, a, z, ws, k_begin, k_end);
+}
+
+
+#ifdef FFT_SIMD_256
+
+CPU_TARGET_AVX2
+static void fourstep_rows_forward_x8_256(u32 len, f32* a, u32 r_begin, u32 r_end, f32 const* tw, FourStepTwiddles const* tt)
+{
+    fourstep_rows<8, false>(len, a, r_begin, r_end, tw, tt);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX2
+static void fourstep_rows_inverse_x8_256(u32 len, f32* a, u32 r_begin, u32 r_end, f32 const* tw, FourStepTwiddles const* tt)
+{
+    fourstep_rows<8, true>(len, a, r_begin, r_end, tw, tt);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX2
+static void fourstep_split_x8_256(u32 nc, f32 const* z, f32* a, f32 const* ws, u32 k_begin, u32 k_end)
+{
+    stockham_rft_split<8>(nc, z, a, ws, k_begin, k_end);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX2
+static void fourstep_join_x8_256(u32 nc, f32 const* a, f32* z, f32 const* ws, u32 k_begin, u32 k_end)
+{
+    stockham_rft_join<8>(nc, a, z, ws, k_begin, k_end);
+
+    _mm256_zeroupper();
+}
+
+#endif
+
+
+#ifdef FFT_SIMD_512
+
+CPU_TARGET_AVX512
+static void fourstep_rows_forward_x16_512(u32 len, f32* a, u32 r_begin, u32 r_end, f32 const* tw, FourStepTwiddles const* tt)
+{
+    fourstep_rows<16, false>(len, a, r_begin, r_end, tw, tt);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX512
+static void fourstep_rows_inverse_x16_512(u32 len, f32* a, u32 r_begin, u32 r_end, f32 const* tw, FourStepTwiddles const* tt)
+{
+    fourstep_rows<16, true>(len, a, r_begin, r_end, tw, tt);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX512
+static void fourstep_split_x16_512(u32 nc, f32 const* z, f32* a, f32 const* ws, u32 k_begin, u32 k_end)
+{
+    stockham_rft_split<16>(nc, z, a, ws, k_begin, k_end);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX512
+static void fourstep_join_x16_512(u32 nc, f32 const* a, f32* z, f32 const* ws, u32 k_begin, u32 k_end)
+{
+    stockham_rft_join<16>(nc, a, z, ws, k_begin, k_end);
+
+    _mm256_zeroupper();
+}
+
+#endif
+
+
+/* dispatch */
+
+// the scalar kernels until bind_fourstep_kernels runs
+class FourStepKernels
+{
+public:
+    void (*rows_forward)(u32 len, f32* a, u32 r_begin, u32 r_end, f32 const* tw, FourStepTwiddles const* tt) = fourstep_rows_forward_x4;
+    void (*rows_inverse)(u32 len, f32* a, u32 r_begin, u32 r_end, f32 const* tw, FourStepTwiddles const* tt) = fourstep_rows_inverse_x4;
+    void (*split)(u32 nc, f32 const* z, f32* a, f32 const* ws, u32 k_begin, u32 k_end) = fourstep_split_x4;
+    void (*join)(u32 nc, f32 const* a, f32* z, f32 const* ws, u32 k_begin, u32 k_end) = fourstep_join_x4;
+};
+
+
+static FourStepKernels fourstep_kernels;
+
+
+static void bind_fourstep_kernels(cpu::SIMD simd)
+{
+    auto& k = fourstep_kernels;
+
+#ifdef FFT_SIMD_512
+    if (simd >= cpu::SIMD::AVX512)
+    {
+        k.rows_forward = fourstep_rows_forward_x16_512;
+        k.rows_inverse = fourstep_rows_inverse_x16_512;
+        k.split = fourstep_split_x16_512;
+        k.join = fourstep_join_x16_512;
+        return;
+    }
+#endif
+
+#ifdef FFT_SIMD_256
+    if (simd >= cpu::SIMD::AVX2)
+    {
+        k.rows_forward = fourstep_rows_forward_x8_256;
+        k.rows_inverse = fourstep_rows_inverse_x8_256;
+        k.split = fourstep_split_x8_256;
+        k.join = fourstep_join_x8_256;
+        return;
+    }
+#endif
+
+    k = FourStepKernels{};
+}
+
+
+#undef FOURSTEP_INLINE
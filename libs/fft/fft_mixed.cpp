@@ -0,0 +1,522 @@
+// Mixed-radix real FFT for the sizes that are not a power of 2
+// Even sizes: a complex FFT of n / 2 points on the even/odd sample pairs followed by the real split
+// Odd sizes: a complex FFT of n points on the samples, the upper half of the spectrum is dropped
+// Stockham passes of radix 4, 3, 5, 7 and a last radix-2 pass, the radix-4 and radix-2
+// passes are the ones of the Stockham engine. Any other factor runs the whole complex FFT as
+// a Bluestein convolution on top of a power of 2 Stockham FFT
+// tw[j] = exp(-2 pi i j / nc), j < nc. ws[k] = (cos, sin)(2 pi k / n), k <= nc / 2
+
+
+#define MIXED_INLINE inline __attribute__((always_inline))
+
+
+static constexpr u32 MIXED_MAX_FACTORS = 32;
+
+
+class MixedTables
+{
+public:
+    u32 nc = 0; // complex points, n / 2, or n when odd
+    u32 n_factors = 0;
+    u32 factors[MIXED_MAX_FACTORS] = {};
+
+    f32* tw = 0;
+    f32* ws = 0;   // even sizes only
+    f32* work = 0; // 4 nc values
+
+    // Bluestein, nb = 0 when nc factors into 2, 3, 5 and 7
+    // chirp[j] = exp(i pi j^2 / nc), j < nc. chirp_fft = FFT of the chirp over nb points / nb
+    u32 nb = 0;
+    f32* chirp = 0;
+    f32* chirp_fft = 0;
+    f32* tw_b = 0;
+    f32* work_b = 0; // 4 nb values
+};
+
+
+// radices in pass order, false if a factor is not 2, 3, 5 or 7
+static bool mixed_factors(u32 nc, MixedTables& t)
+{
+    t.n_factors = 0;
+
+    for (; nc % 4 == 0; nc /= 4)
+    {
+        t.factors[t.n_factors++] = 4;
+    }
+
+    constexpr u32 odd[] = { 3, 5, 7 };
+
+    for (auto r : odd)
+    {
+        for (; nc % r == 0; nc /= r)
+        {
+            t.factors[t.n_factors++] = r;
+        }
+    }
+
+    // radix-2 last, its twiddles are all 1
+    if (nc % 2 == 0)
+    {
+        t.factors[t.n_factors++] = 2;
+        nc /= 2;
+    }
+
+    return nc == 1;
+}
+
+
+// cos and sin of 2 pi t / R, t < R
+template <u32 R>
+class MixedRotations
+{
+public:
+    f32 c[R] = {};
+    f32 s[R] = {};
+};
+
+
+template <u32 R>
+static constexpr MixedRotations<R> make_mixed_rotations()
+{
+    MixedRotations<R> rot{};
+
+    for (u32 t = 0; t < R; t++)
+    {
+        // codelet_sin needs |x| <= pi
+        auto x = 2.0 * num::PI * (2 * t <= R ? t : R - t) / R;
+        rot.c[t] = (f32)codelet_cos(x);
+        rot.s[t] = (f32)(2 * t <= R ? codelet_sin(x) : -codelet_sin(x));
+    }
+
+    return rot;
+}
+
+
+template <u32 R>
+static constexpr MixedRotations<R> mixed_rotations = make_mixed_rotations<R>();
+
+
+// y[m * 2s] = w^m sum_k a_k exp(-+2 pi i k m / R), a_k = x[k * step], odd prime R
+// pairs a_k, a_(R - k): y_m = A - iB, y_(R - m) = A + iB forward, the signs swap for the inverse
+template <u32 R, bool INV>
+static MIXED_INLINE void mixed_bfly(f32 const* x, u32 step, f32* y, u32 s, f32 const* w)
+{
+    constexpr u32 H = R / 2;
+    constexpr auto& rot = mixed_rotations<R>;
+
+    f32 tr[H + 1], ti[H + 1], ur[H + 1], ui[H + 1];
+
+    auto a0r = x[0];
+    auto a0i = x[1];
+
+    auto y0r = a0r;
+    auto y0i = a0i;
+
+    for (u32 k = 1; k <= H; k++)
+    {
+        auto a = x + k * step;
+        auto b = x + (R - k) * step;
+
+        tr[k] = a[0] + b[0];
+        ti[k] = a[1] + b[1];
+        ur[k] = a[0] - b[0];
+        ui[k] = a[1] - b[1];
+
+        y0r += tr[k];
+        y0i += ti[k];
+    }
+
+    y[0] = y0r;
+    y[1] = y0i;
+
+    for (u32 m = 1; m <= H; m++)
+    {
+        auto ar = a0r;
+        auto ai = a0i;
+        f32 br = 0.0f;
+        f32 bi = 0.0f;
+
+        for (u32 k = 1; k <= H; k++)
+        {
+            auto c = rot.c[(k * m) % R];
+            auto sn = rot.s[(k * m) % R];
+
+            ar += c * tr[k];
+            ai += c * ti[k];
+            br += sn * ur[k];
+            bi += sn * ui[k];
+        }
+
+        auto pr = INV ? ar - bi : ar + bi;
+        auto pi = INV ? ai + br : ai - br;
+        auto qr = INV ? ar + bi : ar - bi;
+        auto qi = INV ? ai - br : ai + br;
+
+        auto wp = w + 2 * (m - 1);
+        auto wq = w + 2 * (R - m - 1);
+
+        y[2 * s * m] = wp[0] * pr - wp[1] * pi;
+        y[2 * s * m + 1] = wp[0] * pi + wp[1] * pr;
+
+        y[2 * s * (R - m)] = wq[0] * qr - wq[1] * qi;
+        y[2 * s * (R - m) + 1] = wq[0] * qi + wq[1] * qr;
+    }
+}
+
+
+// one radix-R pass like stockham_pass4, odd prime R
+// y[q + s (R p + k)] from x[q + s (p + k n / R)], q < s, p < n / R
+template <u32 L, u32 R, bool INV>
+static MIXED_INLINE void mixed_pass(u32 n, u32 s, f32 const* x, f32* y, f32 const* tw)
+{
+    using V = typename Lanes<L>::type;
+
+    constexpr u32 QV = L / 2;
+    constexpr u32 H = R / 2;
+    constexpr auto& rot = mixed_rotations<R>;
+
+    if constexpr (L > 4)
+    {
+        if (s % QV)
+        {
+            mixed_pass<L / 2, R, INV>(n, s, x, y, tw);
+            return;
+        }
+    }
+
+    auto n1 = n / R;
+    auto step = 2 * s * n1;
+
+    ComplexLanes<L> cl;
+
+    // -i v forward, +i v inverse = swap(v) * js
+    V js = INV ? cl.alt : -cl.alt;
+
+    for (u32 p = 0; p < n1; p++)
+    {
+        // w^k, k = 1 to R - 1, w = exp(-+2 pi i p / n)
+        f32 w[2 * (R - 1)];
+        for (u32 k = 1; k < R; k++)
+        {
+            auto i = 2 * p * k * s;
+            w[2 * (k - 1)] = tw[i];
+            w[2 * (k - 1) + 1] = INV ? -tw[i + 1] : tw[i + 1];
+        }
+
+        auto xa = x + 2 * s * p;
+        auto ya = y + 2 * R * s * p;
+
+        if (s % QV)
+        {
+            for (u32 q = 0; q < s; q++)
+            {
+                mixed_bfly<R, INV>(xa + 2 * q, step, ya + 2 * q, s, w);
+            }
+
+            continue;
+        }
+
+        V wr[R - 1], wi[R - 1];
+        for (u32 k = 0; k < R - 1; k++)
+        {
+            wr[k] = w[2 * k] + V{};
+            wi[k] = w[2 * k + 1] * cl.alt;
+        }
+
+        for (u32 q = 0; q < s; q += QV)
+        {
+            auto xq = xa + 2 * q;
+            auto yq = ya + 2 * q;
+
+            V a0, t[H + 1], u[H + 1];
+            load(a0, xq);
+
+            V y0 = a0;
+            for (u32 k = 1; k <= H; k++)
+            {
+                V a, b;
+                load(a, xq + k * step);
+                load(b, xq + (R - k) * step);
+
+                t[k] = a + b;
+                u[k] = a - b;
+                y0 += t[k];
+            }
+
+            store(yq, y0);
+
+            for (u32 m = 1; m <= H; m++)
+            {
+                V av = a0;
+                V bv = {};
+                for (u32 k = 1; k <= H; k++)
+                {
+                    av += rot.c[(k * m) % R] * t[k];
+                    bv += rot.s[(k * m) % R] * u[k];
+                }
+
+                V jb = __builtin_shuffle(bv, cl.swap) * js;
+                V pv = av + jb;
+                V qv = av - jb;
+
+                auto kp = m - 1;
+                auto kq = R - m - 1;
+
+                store(yq + 2 * s * m, pv * wr[kp] + __builtin_shuffle(pv, cl.swap) * wi[kp]);
+                store(yq + 2 * s * (R - m), qv * wr[kq] + __builtin_shuffle(qv, cl.swap) * wi[kq]);
+            }
+        }
+    }
+}
+
+
+// complex FFT of nc points by a convolution over nb points
+// X[k] = conj(b_k) sum_j x_j conj(b_j) b_(k - j), b_j = exp(i pi j^2 / nc)
+// the inverse is conj(FFT(conj x)). The result is in out_a
+template <u32 L, bool INV>
+static MIXED_INLINE f32* bluestein_cft(MixedTables const& t, f32 const* src, f32* out_a)
+{
+    auto nc = t.nc;
+    auto nb = t.nb;
+    auto b = t.chirp;
+
+    auto u = t.work_b;
+    auto v = t.work_b + 2 * nb;
+
+    // u = x conj(b), zero padded to nb
+    for (u32 j = 0; j < nc; j++)
+    {
+        auto xr = src[2 * j];
+        auto xi = INV ? -src[2 * j + 1] : src[2 * j + 1];
+
+        u[2 * j] = xr * b[2 * j] + xi * b[2 * j + 1];
+        u[2 * j + 1] = xi * b[2 * j] - xr * b[2 * j + 1];
+    }
+
+    for (u32 j = 2 * nc; j < 2 * nb; j++)
+    {
+        u[j] = 0.0f;
+    }
+
+    auto uf = stockham_cft<L, false>(nb, u, v, u, t.tw_b);
+
+    for (u32 k = 0; k < nb; k++)
+    {
+        auto ur = uf[2 * k];
+        auto ui = uf[2 * k + 1];
+        auto cr = t.chirp_fft[2 * k];
+        auto ci = t.chirp_fft[2 * k + 1];
+
+        uf[2 * k] = ur * cr - ui * ci;
+        uf[2 * k + 1] = ur * ci + ui * cr;
+    }
+
+    auto r = stockham_cft<L, true>(nb, uf, uf == u ? v : u, uf, t.tw_b);
+
+    // X = conj(b) r
+    for (u32 k = 0; k < nc; k++)
+    {
+        auto rr = r[2 * k];
+        auto ri = r[2 * k + 1];
+
+        auto xr = rr * b[2 * k] + ri * b[2 * k + 1];
+        auto xi = ri * b[2 * k] - rr * b[2 * k + 1];
+
+        out_a[2 * k] = xr;
+        out_a[2 * k + 1] = INV ? -xi : xi;
+    }
+
+    return out_a;
+}
+
+
+// passes write out_a, out_b, out_a... src is only read by the first pass and must not be out_a
+// returns the buffer holding the result
+template <u32 L, bool INV>
+static MIXED_INLINE f32* mixed_cft(MixedTables const& t, f32 const* src, f32* out_a, f32* out_b)
+{
+    if (t.nb)
+    {
+        return bluestein_cft<L, INV>(t, src, out_a);
+    }
+
+    auto x = src;
+    auto y = out_a;
+    auto z = out_b;
+
+    u32 n = t.nc;
+    u32 s = 1;
+
+    for (u32 i = 0; i < t.n_factors; i++)
+    {
+        auto r = t.factors[i];
+
+        switch (r)
+        {
+        case 4: stockham_pass4<L, INV>(n, s, x, y, t.tw); break;
+        case 3: mixed_pass<L, 3, INV>(n, s, x, y, t.tw); break;
+        case 5: mixed_pass<L, 5, INV>(n, s, x, y, t.tw); break;
+        case 7: mixed_pass<L, 7, INV>(n, s, x, y, t.tw); break;
+        default: stockham_pass2<L>(s, x, y); break;
+        }
+
+        n /= r;
+        s *= r;
+
+        x = y;
+        y = z;
+        z = (f32*)x;
+    }
+
+    return (f32*)x;
+}
+
+
+static u32 mixed_n_passes(MixedTables const& t)
+{
+    return t.nb ? 1 : t.n_factors;
+}
+
+
+// odd n: X[k], k <= m = (n - 1) / 2, a[2k] = Re, a[2k + 1] = -Im, a[1] = -Im X[m]
+template <u32 L>
+static MIXED_INLINE void mixed_forward(u32 n, MixedTables const& t, f32 const* src, f32* dst)
+{
+    auto nc = t.nc;
+    auto work = t.work;
+
+    if (n % 2 == 0)
+    {
+        auto z = mixed_cft<L, false>(t, src, work, dst);
+
+        stockham_rft_split<L>(nc, z, dst, t.ws);
+        return;
+    }
+
+    for (u32 j = 0; j < n; j++)
+    {
+        work[2 * j] = src[j];
+        work[2 * j + 1] = 0.0f;
+    }
+
+    auto z = mixed_cft<L, false>(t, work, work + 2 * nc, work);
+
+    auto m = n / 2;
+
+    dst[0] = z[0];
+    for (u32 k = 1; k < m; k++)
+    {
+        dst[2 * k] = z[2 * k];
+        dst[2 * k + 1] = -z[2 * k + 1];
+    }
+
+    dst[n - 1] = z[2 * m];
+    dst[1] = -z[2 * m + 1];
+}
+
+
+// scaled by n / 2 like rdft_inverse
+template <u32 L>
+static MIXED_INLINE void mixed_inverse(u32 n, MixedTables const& t, f32 const* src, f32* dst)
+{
+    auto nc = t.nc;
+    auto work = t.work;
+
+    if (n % 2 == 0)
+    {
+        // the pass count decides which buffer the join writes so that the last pass lands in dst
+        auto odd = mixed_n_passes(t) & 1u;
+
+        auto first = odd ? dst : work;
+        auto second = odd ? work : dst;
+
+        stockham_rft_join<L>(nc, src, second, t.ws);
+        mixed_cft<L, true>(t, second, first, second);
+        return;
+    }
+
+    // Z = X / 2 with the upper half mirrored
+    auto m = n / 2;
+
+    work[0] = 0.5f * src[0];
+    work[1] = 0.0f;
+
+    for (u32 k = 1; k <= m; k++)
+    {
+        auto re = k < m ? src[2 * k] : src[n - 1];
+        auto im = k < m ? -src[2 * k + 1] : -src[1];
+
+        work[2 * k] = 0.5f * re;
+        work[2 * k + 1] = 0.5f * im;
+        work[2 * (n - k)] = 0.5f * re;
+        work[2 * (n - k) + 1] = -0.5f * im;
+    }
+
+    auto z = mixed_cft<L, true>(t, work, work + 2 * nc, work);
+
+    for (u32 j = 0; j < n; j++)
+    {
+        dst[j] = z[2 * j];
+    }
+}
+
+
+/* entry points */
+
+static void mixed_forward_x4(u32 n, MixedTables const& t, f32 const* src, f32* dst)
+{
+    mixed_forward<4>(n, t, src, dst);
+}
+
+
+static void mixed_inverse_x4(u32 n, MixedTables const& t, f32 const* src, f32* dst)
+{
+    mixed_inverse<4>(n, t, src, dst);
+}
+
+
+#ifdef FFT_SIMD_256
+
+CPU_TARGET_AVX2
+static void mixed_forward_x8_256(u32 n, MixedTables const& t, f32 const* src, f32* dst)
+{
+    mixed_forward<8>(n, t, src, dst);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX2
+static void mixed_inverse_x8_256(u32 n, MixedTables const& t, f32 const* src, f32* dst)
+{
+    mixed_inverse<8>(n, t, src, dst);
+
+    _mm256_zeroupper();
+}
+
+#endif
+
+
+#ifdef FFT_SIMD_512
+
+CPU_TARGET_AVX512
+static void mixed_forward_x16_512(u32 n, MixedTables const& t, f32 const* src, f32* dst)
+{
+    mixed_forward<16>(n, t, src, dst);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX512
+static void mixed_inverse_x16_512(u32 n, MixedTables const& t, f32 const* src, f32* dst)
+{
+    mixed_inverse<16>(n, t, src, dst);
+
+    _mm256_zeroupper();
+}
+
+#endif
+
+
+#undef MIXED_INLINE
@@ -0,0 +1,661 @@
+// Stockham autosort real FFT, same layout and scaling as rdft_forward/rdft_inverse
+// A complex FFT of n / 2 points on the even/odd sample pairs followed by the real split
+// Every pass reads one buffer and writes the other already in sorted order,
+// so there is no bit reversal and every pass walks its buffers sequentially
+// Radix-4 passes, then one radix-2 pass when log2(n / 2) is odd
+// tw[j] = exp(-2 pi i j / nc), j < nc. ws[k] = (cos, sin)(2 pi k / n), k <= nc / 2
+
+
+#define STOCKHAM_INLINE inline __attribute__((always_inline))
+
+
+// shuffle indices for Lanes<L>
+template <u32 L> class LaneIndex;
+
+template <> class LaneIndex<4> { public: typedef i32 type __attribute__((vector_size(16))); };
+
+template <> class LaneIndex<8> { public: typedef i32 type __attribute__((vector_size(32))); };
+
+template <> class LaneIndex<16> { public: typedef i32 type __attribute__((vector_size(64))); };
+
+
+// constants for complex interleaved lanes, L / 2 complex values per vector
+template <u32 L>
+class ComplexLanes
+{
+public:
+    using V = typename Lanes<L>::type;
+    using I = typename LaneIndex<L>::type;
+
+    I swap;   // (im, re)
+    I dup_re; // (re, re)
+    I dup_im; // (im, im)
+    I rev;    // complex values in reverse order
+    I zip_lo; // a0 b0 a1 b1... from the first halves of a and b
+    I zip_hi; // from the second halves
+
+    V alt;  // (-1, 1, -1, 1...)
+    V conj; // (1, -1, 1, -1...)
+
+
+    STOCKHAM_INLINE ComplexLanes()
+    {
+        constexpr i32 H = L / 2;
+
+        for (i32 i = 0; i < (i32)L; i++)
+        {
+            auto c = i / 2;
+            auto im = i & 1;
+
+            swap[i] = i ^ 1;
+            dup_re[i] = 2 * c;
+            dup_im[i] = 2 * c + 1;
+            rev[i] = 2 * (H - 1 - c) + im;
+
+            // second operand starts at index L
+            auto src = (c & 1) ? (i32)L : 0;
+            zip_lo[i] = src + 2 * (c / 2) + im;
+            zip_hi[i] = src + 2 * (c / 2 + H / 2) + im;
+
+            alt[i] = im ? 1.0f : -1.0f;
+            conj[i] = im ? -1.0f : 1.0f;
+        }
+    }
+};
+
+
+// r = a * b
+template <u32 L>
+static STOCKHAM_INLINE void cmul(typename Lanes<L>::type& r, typename Lanes<L>::type const& a, typename Lanes<L>::type const& b, ComplexLanes<L> const& cl)
+{
+    r = a * __builtin_shuffle(b, cl.dup_re) + __builtin_shuffle(a, cl.swap) * __builtin_shuffle(b, cl.dup_im) * cl.alt;
+}
+
+
+// lo, hi = a0 b0 a1 b1...
+template <u32 L>
+static STOCKHAM_INLINE void zip(typename Lanes<L>::type& lo, typename Lanes<L>::type& hi, typename Lanes<L>::type const& a, typename Lanes<L>::type const& b, ComplexLanes<L> const& cl)
+{
+    lo = __builtin_shuffle(a, b, cl.zip_lo);
+    hi = __builtin_shuffle(a, b, cl.zip_hi);
+}
+
+
+template <bool INV>
+static STOCKHAM_INLINE void stockham_bfly4(f32 const* xa, f32 const* xb, f32 const* xc, f32 const* xd, f32* y, u32 s, f32 const* w)
+{
+    auto ar = xa[0]; auto ai = xa[1];
+    auto br = xb[0]; auto bi = xb[1];
+    auto cr = xc[0]; auto ci = xc[1];
+    auto dr = xd[0]; auto di = xd[1];
+
+    auto apcr = ar + cr; auto apci = ai + ci;
+    auto amcr = ar - cr; auto amci = ai - ci;
+    auto bpdr = br + dr; auto bpdi = bi + di;
+
+    // -i (b - d) forward, +i (b - d) inverse
+    auto jr = INV ? di - bi : bi - di;
+    auto ji = INV ? br - dr : dr - br;
+
+    auto t1r = amcr + jr; auto t1i = amci + ji;
+    auto t2r = apcr - bpdr; auto t2i = apci - bpdi;
+    auto t3r = amcr - jr; auto t3i = amci - ji;
+
+    y[0] = apcr + bpdr;
+    y[1] = apci + bpdi;
+
+    y[2 * s] = w[0] * t1r - w[1] * t1i;
+    y[2 * s + 1] = w[0] * t1i + w[1] * t1r;
+
+    y[4 * s] = w[2] * t2r - w[3] * t2i;
+    y[4 * s + 1] = w[2] * t2i + w[3] * t2r;
+
+    y[6 * s] = w[4] * t3r - w[5] * t3i;
+    y[6 * s + 1] = w[4] * t3i + w[5] * t3r;
+}
+
+
+// first radix-4 pass, s = 1, vectors run along p
+// the 4 outputs of each p are adjacent, zipped back together before the stores
+template <u32 L, bool INV>
+static STOCKHAM_INLINE void stockham_pass4_first(u32 n, f32 const* x, f32* y, f32 const* tw)
+{
+    using V = typename Lanes<L>::type;
+
+    constexpr u32 QV = L / 2;
+
+    ComplexLanes<L> cl;
+
+    // -i v forward, +i v inverse = swap(v) * js
+    V js = INV ? cl.alt : -cl.alt;
+
+    auto n1 = n / 4;
+    auto step = 2 * n1;
+
+    for (u32 p = 0; p < n1; p += QV)
+    {
+        auto xp = x + 2 * p;
+
+        V a, b, c, d, w1, w2, w3;
+        load(a, xp);
+        load(b, xp + step);
+        load(c, xp + 2 * step);
+        load(d, xp + 3 * step);
+        load(w1, tw + 2 * p);
+
+        if constexpr (INV)
+        {
+            w1 = w1 * cl.conj;
+        }
+
+        cmul(w2, w1, w1, cl);
+        cmul(w3, w2, w1, cl);
+
+        V apc = a + c;
+        V amc = a - c;
+        V bpd = b + d;
+        V jbmd = __builtin_shuffle(b - d, cl.swap) * js;
+
+        V y0 = apc + bpd;
+        V y1, y2, y3;
+        cmul(y1, amc + jbmd, w1, cl);
+        cmul(y2, apc - bpd, w2, cl);
+        cmul(y3, amc - jbmd, w3, cl);
+
+        V e0, e1, f0, f1, o0, o1, o2, o3;
+        zip(e0, e1, y0, y2, cl);
+        zip(f0, f1, y1, y3, cl);
+        zip(o0, o1, e0, f0, cl);
+        zip(o2, o3, e1, f1, cl);
+
+        auto yp = y + 8 * p;
+        store(yp, o0);
+        store(yp + L, o1);
+        store(yp + 2 * L, o2);
+        store(yp + 3 * L, o3);
+    }
+}
+
+
+// one radix-4 pass, s sub transforms of length n
+// y[q + s (4p + k)] from x[q + s (p + k n / 4)], q < s, p < n / 4
+template <u32 L, bool INV>
+static STOCKHAM_INLINE void stockham_pass4(u32 n, u32 s, f32 const* x, f32* y, f32 const* tw)
+{
+    using V = typename Lanes<L>::type;
+
+    constexpr u32 QV = L / 2; // complex values per vector
+
+    auto n1 = n / 4;
+    auto step = 2 * s * n1;
+
+    if (s == 1 && n1 % QV == 0)
+    {
+        stockham_pass4_first<L, INV>(n, x, y, tw);
+        return;
+    }
+
+    if constexpr (L > 4)
+    {
+        if (s % QV)
+        {
+            stockham_pass4<L / 2, INV>(n, s, x, y, tw);
+            return;
+        }
+    }
+
+    ComplexLanes<L> cl;
+
+    V js = INV ? cl.alt : -cl.alt;
+
+    for (u32 p = 0; p < n1; p++)
+    {
+        // w^p, w^2p, w^3p, w = exp(-+2 pi i / n)
+        auto i1 = 2 * p * s;
+        f32 w[6] = {
+            tw[i1], INV ? -tw[i1 + 1] : tw[i1 + 1],
+            tw[2 * i1], INV ? -tw[2 * i1 + 1] : tw[2 * i1 + 1],
+            tw[3 * i1], INV ? -tw[3 * i1 + 1] : tw[3 * i1 + 1]
+        };
+
+        auto xa = x + 2 * s * p;
+        auto ya = y + 8 * s * p;
+
+        if (s % QV)
+        {
+            for (u32 q = 0; q < s; q++)
+            {
+                auto xq = xa + 2 * q;
+                stockham_bfly4<INV>(xq, xq + step, xq + 2 * step, xq + 3 * step, ya + 2 * q, s, w);
+            }
+
+            continue;
+        }
+
+        // v * (wr + i wi) = v * wr + swap(v) * (-wi, wi, -wi, wi...)
+        V w1r = w[0] + V{};
+        V w1s = w[1] * cl.alt;
+        V w2r = w[2] + V{};
+        V w2s = w[3] * cl.alt;
+        V w3r = w[4] + V{};
+        V w3s = w[5] * cl.alt;
+
+        for (u32 q = 0; q < s; q += QV)
+        {
+            auto xq = xa + 2 * q;
+            auto yq = ya + 2 * q;
+
+            V a, b, c, d;
+            load(a, xq);
+            load(b, xq + step);
+            load(c, xq + 2 * step);
+            load(d, xq + 3 * step);
+
+            V apc = a + c;
+            V amc = a - c;
+            V bpd = b + d;
+            V jbmd = __builtin_shuffle(b - d, cl.swap) * js;
+
+            V t1 = amc + jbmd;
+            V t2 = apc - bpd;
+            V t3 = amc - jbmd;
+
+            store(yq, apc + bpd);
+            store(yq + 2 * s, t1 * w1r + __builtin_shuffle(t1, cl.swap) * w1s);
+            store(yq + 4 * s, t2 * w2r + __builtin_shuffle(t2, cl.swap) * w2s);
+            store(yq + 6 * s, t3 * w3r + __builtin_shuffle(t3, cl.swap) * w3s);
+        }
+    }
+}
+
+
+// last pass when log2(nc) is odd, n = 2, twiddles are all 1
+template <u32 L>
+static STOCKHAM_INLINE void stockham_pass2(u32 s, f32 const* x, f32* y)
+{
+    using V = typename Lanes<L>::type;
+
+    u32 i = 0;
+
+    if (s % (L / 2) == 0)
+    {
+        for (; i < 2 * s; i += L)
+        {
+            V a, b;
+            load(a, x + i);
+            load(b, x + 2 * s + i);
+
+            store(y + i, a + b);
+            store(y + 2 * s + i, a - b);
+        }
+    }
+
+    for (; i < 2 * s; i++)
+    {
+        auto a = x[i];
+        auto b = x[2 * s + i];
+
+        y[i] = a + b;
+        y[2 * s + i] = a - b;
+    }
+}
+
+
+static u32 stockham_n_passes(u32 nc)
+{
+    u32 n_passes = 0;
+    for (; nc >= 4; nc /= 4)
+    {
+        n_passes++;
+    }
+
+    return n_passes + (nc == 2 ? 1 : 0);
+}
+
+
+// complex FFT of nc points, unscaled
+// passes write out_a, out_b, out_a... src is only read by the first pass and must not be out_a
+// returns the buffer holding the result
+template <u32 L, bool INV>
+static STOCKHAM_INLINE f32* stockham_cft(u32 nc, f32 const* src, f32* out_a, f32* out_b, f32 const* tw)
+{
+    auto x = src;
+    auto y = out_a;
+    auto z = out_b;
+
+    u32 n = nc;
+    u32 s = 1;
+
+    for (; n >= 4; n /= 4, s *= 4)
+    {
+        stockham_pass4<L, INV>(n, s, x, y, tw);
+
+        x = y;
+        y = z;
+        z = (f32*)x;
+    }
+
+    if (n == 2)
+    {
+        stockham_pass2<L>(s, x, y);
+        x = y;
+    }
+
+    return (f32*)x;
+}
+
+
+// X[k] and X[nc - k] from Z[k] and Z[nc - k] for k_begin <= k < k_end, z == a is allowed
+// 1 <= k_begin, k_end <= nc / 2 + 1
+// E = (Z[k] + conj Z[j]) / 2, O = (Z[k] - conj Z[j]) / 2i, P = exp(-2 pi i k / n) O
+// X[k] = E + P, X[j] = conj(E - P), stored with the imaginary part negated
+template <u32 L>
+static STOCKHAM_INLINE void stockham_rft_split(u32 nc, f32 const* z, f32* a, f32 const* ws, u32 k_begin, u32 k_end)
+{
+    using V = typename Lanes<L>::type;
+
+    constexpr u32 QV = L / 2;
+
+    ComplexLanes<L> cl;
+
+    // blocks of k below every j of the block
+    u32 k = k_begin;
+    for (; k + QV <= k_end && 2 * (k + QV - 1) < nc; k += QV)
+    {
+        auto j = nc - k - (QV - 1);
+
+        V zk, zj, w;
+        load(zk, z + 2 * k);
+        load(zj, z + 2 * j);
+        load(w, ws + 2 * k);
+
+        zj = __builtin_shuffle(zj, cl.rev) * cl.conj;
+
+        V e = 0.5f * (zk + zj);
+        V d = 0.5f * (zk - zj);
+        V o = __builtin_shuffle(d, cl.swap) * cl.conj;
+
+        // o * conj(w)
+        V pw = o * __builtin_shuffle(w, cl.dup_re) + __builtin_shuffle(o, cl.swap) * __builtin_shuffle(w, cl.dup_im) * cl.conj;
+
+        store(a + 2 * k, (e + pw) * cl.conj);
+        store(a + 2 * j, __builtin_shuffle(e - pw, cl.rev));
+    }
+
+    for (; k < k_end; k++)
+    {
+        auto j = nc - k;
+
+        auto c = ws[2 * k];
+        auto s = ws[2 * k + 1];
+
+        auto zkr = z[2 * k];
+        auto zki = z[2 * k + 1];
+        auto zjr = z[2 * j];
+        auto zji = z[2 * j + 1];
+
+        auto er = 0.5f * (zkr + zjr);
+        auto ei = 0.5f * (zki - zji);
+        auto or_ = 0.5f * (zki + zji);
+        auto oi = 0.5f * (zjr - zkr);
+
+        auto pr = c * or_ + s * oi;
+        auto pi = c * oi - s * or_;
+
+        a[2 * j] = er - pr;
+        a[2 * j + 1] = ei - pi;
+        a[2 * k] = er + pr;
+        a[2 * k + 1] = -(ei + pi);
+    }
+}
+
+
+template <u32 L>
+static STOCKHAM_INLINE void stockham_rft_split(u32 nc, f32 const* z, f32* a, f32 const* ws)
+{
+    auto z0 = z[0];
+    auto z1 = z[1];
+
+    a[0] = z0 + z1;
+    a[1] = z0 - z1;
+
+    stockham_rft_split<L>(nc, z, a, ws, 1, nc / 2 + 1);
+}
+
+
+// Z[k] and Z[nc - k] from X[k] and X[nc - k] for k_begin <= k < k_end, a == z is allowed
+// inverse of stockham_rft_split
+// E = (X[k] + conj X[j]) / 2, O = exp(2 pi i k / n) (X[k] - conj X[j]) / 2
+// Z[k] = E + iO, Z[j] = conj(E - iO)
+template <u32 L>
+static STOCKHAM_INLINE void stockham_rft_join(u32 nc, f32 const* a, f32* z, f32 const* ws, u32 k_begin, u32 k_end)
+{
+    using V = typename Lanes<L>::type;
+
+    constexpr u32 QV = L / 2;
+
+    ComplexLanes<L> cl;
+
+    u32 k = k_begin;
+    for (; k + QV <= k_end && 2 * (k + QV - 1) < nc; k += QV)
+    {
+        auto j = nc - k - (QV - 1);
+
+        V xk, xj, w;
+        load(xk, a + 2 * k);
+        load(xj, a + 2 * j);
+        load(w, ws + 2 * k);
+
+        // X[k], conj X[j]
+        xk = xk * cl.conj;
+        xj = __builtin_shuffle(xj, cl.rev);
+
+        V e = 0.5f * (xk + xj);
+        V d = 0.5f * (xk - xj);
+
+        V o;
+        cmul(o, d, w, cl);
+
+        V io = __builtin_shuffle(o, cl.swap) * cl.alt;
+
+        store(z + 2 * k, e + io);
+        store(z + 2 * j, __builtin_shuffle((e - io) * cl.conj, cl.rev));
+    }
+
+    for (; k < k_end; k++)
+    {
+        auto j = nc - k;
+
+        auto c = ws[2 * k];
+        auto s = ws[2 * k + 1];
+
+        auto xkr = a[2 * k];
+        auto xki = -a[2 * k + 1];
+        auto xjr = a[2 * j];
+        auto xji = -a[2 * j + 1];
+
+        auto er = 0.5f * (xkr + xjr);
+        auto ei = 0.5f * (xki - xji);
+        auto dr = 0.5f * (xkr - xjr);
+        auto di = 0.5f * (xki + xji);
+
+        auto or_ = c * dr - s * di;
+        auto oi = c * di + s * dr;
+
+        z[2 * j] = er + oi;
+        z[2 * j + 1] = or_ - ei;
+        z[2 * k] = er - oi;
+        z[2 * k + 1] = ei + or_;
+    }
+}
+
+
+template <u32 L>
+static STOCKHAM_INLINE void stockham_rft_join(u32 nc, f32 const* a, f32* z, f32 const* ws)
+{
+    auto a0 = a[0];
+    auto a1 = a[1];
+
+    z[0] = 0.5f * (a0 + a1);
+    z[1] = 0.5f * (a0 - a1);
+
+    stockham_rft_join<L>(nc, a, z, ws, 1, nc / 2 + 1);
+}
+
+
+// work holds n values, src == dst is allowed
+template <u32 L>
+static STOCKHAM_INLINE void stockham_forward(u32 n, f32 const* src, f32* dst, f32* work, f32 const* tw, f32 const* ws)
+{
+    auto nc = n / 2;
+
+    auto z = stockham_cft<L, false>(nc, src, work, dst, tw);
+
+    stockham_rft_split<L>(nc, z, dst, ws);
+}
+
+
+template <u32 L>
+static STOCKHAM_INLINE void stockham_inverse(u32 n, f32 const* src, f32* dst, f32* work, f32 const* tw, f32 const* ws)
+{
+    auto nc = n / 2;
+
+    // the pass count decides which buffer the join writes so that the last pass lands in dst
+    auto odd = stockham_n_passes(nc) & 1u;
+
+    auto first = odd ? dst : work;
+    auto second = odd ? work : dst;
+
+    stockham_rft_join<L>(nc, src, second, ws);
+    stockham_cft<L, true>(nc, second, first, second, tw);
+}
+
+
+// complex FFT of nc points into dst, work holds 2 nc values, src == dst is allowed
+template <u32 L, bool INV>
+static STOCKHAM_INLINE void stockham_cft_to(u32 nc, f32 const* src, f32* dst, f32* work, f32 const* tw)
+{
+    // the pass count decides which buffer the first pass writes so that the last pass lands in dst
+    if (!(stockham_n_passes(nc) & 1u))
+    {
+        stockham_cft<L, INV>(nc, src, work, dst, tw);
+    }
+    else if (src != dst)
+    {
+        stockham_cft<L, INV>(nc, src, dst, work, tw);
+    }
+    else
+    {
+        auto res = stockham_cft<L, INV>(nc, src, work, dst, tw);
+        __builtin_memcpy(dst, res, 2 * nc * sizeof(f32));
+    }
+}
+
+
+/* entry points */
+
+static void stockham_forward_x4(u32 n, f32 const* src, f32* dst, f32* work, f32 const* tw, f32 const* ws)
+{
+    stockham_forward<4>(n, src, dst, work, tw, ws);
+}
+
+
+static void stockham_inverse_x4(u32 n, f32 const* src, f32* dst, f32* work, f32 const* tw, f32 const* ws)
+{
+    stockham_inverse<4>(n, src, dst, work, tw, ws);
+}
+
+
+static void stockham_cft_forward_x4(u32 nc, f32 const* src, f32* dst, f32* work, f32 const* tw)
+{
+    stockham_cft_to<4, false>(nc, src, dst, work, tw);
+}
+
+
+static void stockham_cft_inverse_x4(u32 nc, f32 const* src, f32* dst, f32* work, f32 const* tw)
+{
+    stockham_cft_to<4, true>(nc, src, dst, work, tw);
+}
+
+
+#ifdef FFT_SIMD_256
+
+CPU_TARGET_AVX2
+static void stockham_forward_x8_256(u32 n, f32 const* src, f32* dst, f32* work, f32 const* tw, f32 const* ws)
+{
+    stockham_forward<8>(n, src, dst, work, tw, ws);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX2
+static void stockham_inverse_x8_256(u32 n, f32 const* src, f32* dst, f32* work, f32 const* tw, f32 const* ws)
+{
+    stockham_inverse<8>(n, src, dst, work, tw, ws);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX2
+static void stockham_cft_forward_x8_256(u32 nc, f32 const* src, f32* dst, f32* work, f32 const* tw)
+{
+    stockham_cft_to<8, false>(nc, src, dst, work, tw);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX2
+static void stockham_cft_inverse_x8_256(u32 nc, f32 const* src, f32* dst, f32* work, f32 const* tw)
+{
+    stockham_cft_to<8, true>(nc, src, dst, work, tw);
+
+    _mm256_zeroupper();
+}
+
+#endif
+
+
+#ifdef FFT_SIMD_512
+
+CPU_TARGET_AVX512
+static void stockham_forward_x16_512(u32 n, f32 const* src, f32* dst, f32* work, f32 const* tw, f32 const* ws)
+{
+    stockham_forward<16>(n, src, dst, work, tw, ws);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX512
+static void stockham_inverse_x16_512(u32 n, f32 const* src, f32* dst, f32* work, f32 const* tw, f32 const* ws)
+{
+    stockham_inverse<16>(n, src, dst, work, tw, ws);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX512
+static void stockham_cft_forward_x16_512(u32 nc, f32 const* src, f32* dst, f32* work, f32 const* tw)
+{
+    stockham_cft_to<16, false>(nc, src, dst, work, tw);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX512
+static void stockham_cft_inverse_x16_512(u32 nc, f32 const* src, f32* dst, f32* work, f32 const* tw)
+{
+    stockham_cft_to<16, true>(nc, src, dst, work, tw);
+
+    _mm256_zeroupper();
+}
+
+#endif
+
+
+#undef STOCKHAM_INLINE
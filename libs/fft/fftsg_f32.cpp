@@ -26,8 +26,46 @@ void rdft_ip_w(int n, int *ip, f32 *w)
 
 
 void rdft_forward(int n, f32 *a, int *ip, f32 *w)
+{
+    void rdft_forward_src(int n, f32 const *s, f32 *a, int *ip, f32 *w);
+
+    rdft_forward_src(n, a, a, ip, w);
+}
+
+
+void rdft_inverse(int n, f32 *a, int *ip, f32 *w)
+{
+    void rdft_inverse_src(int n, f32 const *s, f32 *a, int *ip, f32 *w);
+
+    rdft_inverse_src(n, a, a, ip, w);
+}
+
+
+// complex FFT of n / 2 points, a[2j] = Re, a[2j + 1] = Im, ip/w from rdft_ip_w(n)
+// forward is cdft(n, -1): exp(-2 pi i j k / (n / 2)), inverse is cdft(n, 1), both unscaled
+
+void cdft_forward(int n, f32 *a, int *ip, f32 *w)
+{
+    void cftbsub_x(int n, f32 *a, int *ip, int nw, f32 *w);
+
+    cftbsub_x(n, a, ip, ip[0], w);
+}
+
+
+void cdft_inverse_src(int n, f32 const *s, f32 *a, int *ip, f32 *w)
+{
+    void cftfsub_x(int n, f32 const *s, f32 *a, int *ip, int nw, f32 *w);
+
+    cftfsub_x(n, s, a, ip, ip[0], w);
+}
+
+
+// out-of-place, reads s and writes the result to a
+// s is only read by the first pass, s == a is the in-place transform
+
+void rdft_forward_src(int n, f32 const *s, f32 *a, int *ip, f32 *w)
 {    
-    void cftfsub_x(int n, f32 *a, int *ip, int nw, f32 *w);
+    void cftfsub_x(int n, f32 const *s, f32 *a, int *ip, int nw, f32 *w);
     void rftfsub(int n, f32 *a, int nc, f32 *c);
     
     int nw, nc;
@@ -36,7 +74,7 @@ void rdft_forward(int n, f32 *a, int *ip, f32 *w)
     nw = ip[0];
     nc = ip[1];
 
-    cftfsub_x(n, a, ip, nw, w);
+    cftfsub_x(n, s, a, ip, nw, w);
     
     if (n > 4) 
     {        
@@ -49,34 +87,330 @@ void rdft_forward(int n, f32 *a, int *ip, f32 *w)
 }
 
 
-void rdft_inverse(int n, f32 *a, int *ip, f32 *w)
+void rdft_inverse_src(int n, f32 const *s, f32 *a, int *ip, f32 *w)
 {
     void cftbsub_x(int n, f32 *a, int *ip, int nw, f32 *w);
-    void rftbsub(int n, f32 *a, int nc, f32 *c);
-    int nw, nc;
-    f32 xi;
+    void rftbsub_src(int n, f32 const *s, f32 *a, int nc, f32 *c);
+    int m, nw, nc;
 
     nw = ip[0];
     nc = ip[1];
+    m = n >> 1;
+
+    a[1] = 0.5 * (s[0] - s[1]);
+    a[0] = s[0] - a[1];
 
-    a[1] = 0.5 * (a[0] - a[1]);
-    a[0] -= a[1];
+    // rftbsub does not touch the middle pair
+    a[m] = s[m];
+    a[m + 1] = s[m + 1];
 
     if (n > 4) 
     {
-        rftbsub(n, a, nc, w + nw);
+        rftbsub_src(n, s, a, nc, w + nw);
     }
 
     cftbsub_x(n, a, ip, nw, w);
 }
 
 
-void cftfsub_x(int n, f32 *a, int *ip, int nw, f32 *w)
+// DCT/DST of n points, ip/w from rdft_ip_w(n), c is the makect(n) table
+// the cft and rft passes run on the rdft tables, dctsub/dstsub on c
+
+// ddct(n, -1): C[k] = sum a[j] cos(pi (j + 1/2) k / n)
+
+void ddct_forward(int n, f32 *a, int *ip, f32 *w, f32 *c)
+{
+    void cftbsub_x(int n, f32 *a, int *ip, int nw, f32 *w);
+    void rftbsub(int n, f32 *a, int nc, f32 *c);
+    void dctsub(int n, f32 *a, int nc, f32 *c);
+    int j, nw, nc;
+    f32 xr;
+
+    nw = ip[0];
+    nc = ip[1];
+
+    xr = a[n - 1];
+    for (j = n - 2; j >= 2; j -= 2) {
+        a[j + 1] = a[j] - a[j - 1];
+        a[j] += a[j - 1];
+    }
+    a[1] = a[0] - xr;
+    a[0] += xr;
+    if (n > 4) {
+        rftbsub(n, a, nc, w + nw);
+        cftbsub_x(n, a, ip, nw, w);
+    } else if (n == 4) {
+        cftbsub_x(n, a, ip, nw, w);
+    }
+
+    dctsub(n, a, n, c);
+}
+
+
+// ddct(n, 1): C[k] = sum a[j] cos(pi j (k + 1/2) / n)
+
+void ddct_inverse(int n, f32 *a, int *ip, f32 *w, f32 *c)
+{
+    void cftfsub_x(int n, f32 const *s, f32 *a, int *ip, int nw, f32 *w);
+    void rftfsub(int n, f32 *a, int nc, f32 *c);
+    void dctsub(int n, f32 *a, int nc, f32 *c);
+    int j, nw, nc;
+    f32 xr;
+
+    nw = ip[0];
+    nc = ip[1];
+
+    dctsub(n, a, n, c);
+
+    if (n > 4) {
+        cftfsub_x(n, a, a, ip, nw, w);
+        rftfsub(n, a, nc, w + nw);
+    } else if (n == 4) {
+        cftfsub_x(n, a, a, ip, nw, w);
+    }
+    xr = a[0] - a[1];
+    a[0] += a[1];
+    for (j = 2; j < n; j += 2) {
+        a[j - 1] = a[j] - a[j + 1];
+        a[j] += a[j + 1];
+    }
+    a[n - 1] = xr;
+}
+
+
+// ddst(n, -1): S[k] = sum a[j] sin(pi (j + 1/2) k / n), 0 < k <= n, S[n] to a[0]
+
+void ddst_forward(int n, f32 *a, int *ip, f32 *w, f32 *c)
+{
+    void cftbsub_x(int n, f32 *a, int *ip, int nw, f32 *w);
+    void rftbsub(int n, f32 *a, int nc, f32 *c);
+    void dstsub(int n, f32 *a, int nc, f32 *c);
+    int j, nw, nc;
+    f32 xr;
+
+    nw = ip[0];
+    nc = ip[1];
+
+    xr = a[n - 1];
+    for (j = n - 2; j >= 2; j -= 2) {
+        a[j + 1] = -a[j] - a[j - 1];
+        a[j] -= a[j - 1];
+    }
+    a[1] = a[0] + xr;
+    a[0] -= xr;
+    if (n > 4) {
+        rftbsub(n, a, nc, w + nw);
+        cftbsub_x(n, a, ip, nw, w);
+    } else if (n == 4) {
+        cftbsub_x(n, a, ip, nw, w);
+    }
+
+    dstsub(n, a, n, c);
+}
+
+
+// ddst(n, 1): S[k] = sum A[j] sin(pi j (k + 1/2) / n), 0 < j <= n, A[n] from a[0]
+
+void ddst_inverse(int n, f32 *a, int *ip, f32 *w, f32 *c)
+{
+    void cftfsub_x(int n, f32 const *s, f32 *a, int *ip, int nw, f32 *w);
+    void rftfsub(int n, f32 *a, int nc, f32 *c);
+    void dstsub(int n, f32 *a, int nc, f32 *c);
+    int j, nw, nc;
+    f32 xr;
+
+    nw = ip[0];
+    nc = ip[1];
+
+    dstsub(n, a, n, c);
+
+    if (n > 4) {
+        cftfsub_x(n, a, a, ip, nw, w);
+        rftfsub(n, a, nc, w + nw);
+    } else if (n == 4) {
+        cftfsub_x(n, a, a, ip, nw, w);
+    }
+    xr = a[0] - a[1];
+    a[0] += a[1];
+    for (j = 2; j < n; j += 2) {
+        a[j - 1] = -a[j] - a[j + 1];
+        a[j] -= a[j + 1];
+    }
+    a[n - 1] = -xr;
+}
+
+
+// dfct: C[k] = sum a[j] cos(pi j k / n), 0 <= j, k <= n, n + 1 points
+// the tables of n run the halves of n / 2 and below at a stride, t is n / 2 + 1 floats
+
+void dfct(int n, f32 *a, f32 *t, int *ip, f32 *w, f32 *c)
+{
+    void cftfsub_x(int n, f32 const *s, f32 *a, int *ip, int nw, f32 *w);
+    void rftfsub(int n, f32 *a, int nc, f32 *c);
+    void dctsub(int n, f32 *a, int nc, f32 *c);
+    int j, k, l, m, mh, nw, nc;
+    f32 xr, xi, yr, yi;
+
+    nw = ip[0];
+    nc = ip[1];
+
+    m = n >> 1;
+    yi = a[m];
+    xi = a[0] + a[n];
+    a[0] -= a[n];
+    t[0] = xi - yi;
+    t[m] = xi + yi;
+    if (n > 2) {
+        mh = m >> 1;
+        for (j = 1; j < mh; j++) {
+            k = m - j;
+            xr = a[j] - a[n - j];
+            xi = a[j] + a[n - j];
+            yr = a[k] - a[n - k];
+            yi = a[k] + a[n - k];
+            a[j] = xr;
+            a[k] = yr;
+            t[j] = xi - yi;
+            t[k] = xi + yi;
+        }
+        t[mh] = a[mh] + a[n - mh];
+        a[mh] -= a[n - mh];
+        dctsub(m, a, n, c);
+        if (m > 4) {
+            cftfsub_x(m, a, a, ip, nw, w);
+            rftfsub(m, a, nc, w + nw);
+        } else if (m == 4) {
+            cftfsub_x(m, a, a, ip, nw, w);
+        }
+        a[n - 1] = a[0] - a[1];
+        a[1] = a[0] + a[1];
+        for (j = m - 2; j >= 2; j -= 2) {
+            a[2 * j + 1] = a[j] + a[j + 1];
+            a[2 * j - 1] = a[j] - a[j + 1];
+        }
+        l = 2;
+        m = mh;
+        while (m >= 2) {
+            dctsub(m, t, n, c);
+            if (m > 4) {
+                cftfsub_x(m, t, t, ip, nw, w);
+                rftfsub(m, t, nc, w + nw);
+            } else if (m == 4) {
+                cftfsub_x(m, t, t, ip, nw, w);
+            }
+            a[n - l] = t[0] - t[1];
+            a[l] = t[0] + t[1];
+            k = 0;
+            for (j = 2; j < m; j += 2) {
+                k += l << 2;
+                a[k - l] = t[j] - t[j + 1];
+                a[k + l] = t[j] + t[j + 1];
+            }
+            l <<= 1;
+            mh = m >> 1;
+            for (j = 0; j < mh; j++) {
+                k = m - j;
+                t[j] = t[m + k] - t[m + j];
+                t[k] = t[m + k] + t[m + j];
+            }
+            t[mh] = t[m + mh];
+            m = mh;
+        }
+        a[l] = t[0];
+        a[n] = t[2] - t[1];
+        a[0] = t[2] + t[1];
+    } else {
+        a[1] = a[0];
+        a[2] = t[0];
+        a[0] = t[1];
+    }
+}
+
+
+// dfst: S[k] = sum a[j] sin(pi j k / n), 0 < j, k < n, a[0] is set to 0
+// tables and t as dfct
+
+void dfst(int n, f32 *a, f32 *t, int *ip, f32 *w, f32 *c)
+{
+    void cftfsub_x(int n, f32 const *s, f32 *a, int *ip, int nw, f32 *w);
+    void rftfsub(int n, f32 *a, int nc, f32 *c);
+    void dstsub(int n, f32 *a, int nc, f32 *c);
+    int j, k, l, m, mh, nw, nc;
+    f32 xr, xi, yr, yi;
+
+    nw = ip[0];
+    nc = ip[1];
+
+    if (n > 2) {
+        m = n >> 1;
+        mh = m >> 1;
+        for (j = 1; j < mh; j++) {
+            k = m - j;
+            xr = a[j] + a[n - j];
+            xi = a[j] - a[n - j];
+            yr = a[k] + a[n - k];
+            yi = a[k] - a[n - k];
+            a[j] = xr;
+            a[k] = yr;
+            t[j] = xi + yi;
+            t[k] = xi - yi;
+        }
+        t[0] = a[mh] - a[n - mh];
+        a[mh] += a[n - mh];
+        a[0] = a[m];
+        dstsub(m, a, n, c);
+        if (m > 4) {
+            cftfsub_x(m, a, a, ip, nw, w);
+            rftfsub(m, a, nc, w + nw);
+        } else if (m == 4) {
+            cftfsub_x(m, a, a, ip, nw, w);
+        }
+        a[n - 1] = a[1] - a[0];
+        a[1] = a[0] + a[1];
+        for (j = m - 2; j >= 2; j -= 2) {
+            a[2 * j + 1] = a[j] - a[j + 1];
+            a[2 * j - 1] = -a[j] - a[j + 1];
+        }
+        l = 2;
+        m = mh;
+        while (m >= 2) {
+            dstsub(m, t, n, c);
+            if (m > 4) {
+                cftfsub_x(m, t, t, ip, nw, w);
+                rftfsub(m, t, nc, w + nw);
+            } else if (m == 4) {
+                cftfsub_x(m, t, t, ip, nw, w);
+            }
+            a[n - l] = t[1] - t[0];
+            a[l] = t[0] + t[1];
+            k = 0;
+            for (j = 2; j < m; j += 2) {
+                k += l << 2;
+                a[k - l] = -t[j] - t[j + 1];
+                a[k + l] = t[j] - t[j + 1];
+            }
+            l <<= 1;
+            mh = m >> 1;
+            for (j = 1; j < mh; j++) {
+                k = m - j;
+                t[j] = t[m + k] + t[m + j];
+                t[k] = t[m + k] - t[m + j];
+            }
+            t[0] = t[m + mh];
+            m = mh;
+        }
+        a[l] = t[0];
+    }
+    a[0] = 0;
+}
+
+
+void cftfsub_x(int n, f32 const *s, f32 *a, int *ip, int nw, f32 *w)
 {
     void bitrv2(int n, int *ip, f32 *a);
     void bitrv216(f32 *a);
     void bitrv208(f32 *a);
-    void cftf1st(int n, f32 *a, f32 *w);
+    void cftf1st_src(int n, f32 const *s, f32 *a, f32 *w);
     void cftrec4(int n, f32 *a, int nw, f32 *w);
     void cftleaf(int n, int isplt, f32 *a, int nw, f32 *w);
     void cftfx41(int n, f32 *a, int nw, f32 *w);
@@ -85,6 +419,16 @@ void cftfsub_x(int n, f32 *a, int *ip, int nw, f32 *w)
     void cftf040(f32 *a);
     void cftx020(f32 *a);
 
+    int j;
+
+    // the small sizes have no separate first pass
+    if (s != a && n <= 32)
+    {
+        for (j = 0; j < n; j++) {
+            a[j] = s[j];
+        }
+    }
+
     switch (n)
     {
     case 4:
@@ -107,20 +451,20 @@ void cftfsub_x(int n, f32 *a, int *ip, int nw, f32 *w)
 
     case 64:
     case 128:
-        cftf1st(n, a, &w[nw - (n >> 2)]);
+        cftf1st_src(n, s, a, &w[nw - (n >> 2)]);
         cftfx41(n, a, nw, w);
         bitrv2(n, ip, a);
         break;
 
     case 256:
     case 512:
-        cftf1st(n, a, &w[nw - (n >> 2)]);
+        cftf1st_src(n, s, a, &w[nw - (n >> 2)]);
         cftleaf(n, 1, a, nw, w);
         bitrv2(n, ip, a);
         break;
 
     default:
-        cftf1st(n, a, &w[nw - (n >> 2)]);
+        cftf1st_src(n, s, a, &w[nw - (n >> 2)]);
         cftrec4(n, a, nw, w);
         bitrv2(n, ip, a);
         break;
@@ -346,7 +690,7 @@ void makect(int nc, int *ip, f32 *c)
 /* -------- child routines -------- */
 
 
-void bitrv2(int n, int *ip, f32 *a)
+void bitrv2_scalar(int n, int *ip, f32 *a)
 {
     int j, j1, k, k1, l, m, nh, nm;
     f32 xr, xi, yr, yi;
@@ -724,7 +1068,7 @@ void bitrv2(int n, int *ip, f32 *a)
 }
 
 
-void bitrv2conj(int n, int *ip, f32 *a)
+void bitrv2conj_scalar(int n, int *ip, f32 *a)
 {
     int j, j1, k, k1, l, m, nh, nm;
     f32 xr, xi, yr, yi;
@@ -1265,7 +1609,7 @@ void bitrv208neg(f32 *a)
 }
 
 
-void cftf1st(int n, f32 *a, f32 *w)
+void cftf1st_scalar(int n, f32 const *s, f32 *a, f32 *w, int j_begin)
 {
     int j, j0, j1, j2, j3, k, m, mh;
     f32 wn4r, csc1, csc3, wk1r, wk1i, wk3r, wk3i, 
@@ -1278,14 +1622,14 @@ void cftf1st(int n, f32 *a, f32 *w)
     j1 = m;
     j2 = j1 + m;
     j3 = j2 + m;
-    x0r = a[0] + a[j2];
-    x0i = a[1] + a[j2 + 1];
-    x1r = a[0] - a[j2];
-    x1i = a[1] - a[j2 + 1];
-    x2r = a[j1] + a[j3];
-    x2i = a[j1 + 1] + a[j3 + 1];
-    x3r = a[j1] - a[j3];
-    x3i = a[j1 + 1] - a[j3 + 1];
+    x0r = s[0] + s[j2];
+    x0i = s[1] + s[j2 + 1];
+    x1r = s[0] - s[j2];
+    x1i = s[1] - s[j2 + 1];
+    x2r = s[j1] + s[j3];
+    x2i = s[j1 + 1] + s[j3 + 1];
+    x3r = s[j1] - s[j3];
+    x3i = s[j1 + 1] - s[j3 + 1];
     a[0] = x0r + x2r;
     a[1] = x0i + x2i;
     a[j1] = x0r - x2r;
@@ -1301,8 +1645,14 @@ void cftf1st(int n, f32 *a, f32 *w)
     wd1i = 0;
     wd3r = 1;
     wd3i = 0;
-    k = 0;
-    for (j = 2; j < mh - 2; j += 4) {
+    k = j_begin - 2;
+    if (k > 0) {
+        wd1r = w[k];
+        wd1i = w[k + 1];
+        wd3r = w[k + 2];
+        wd3i = w[k + 3];
+    }
+    for (j = j_begin; j < mh - 2; j += 4) {
         k += 4;
         wk1r = csc1 * (wd1r + w[k]);
         wk1i = csc1 * (wd1i + w[k + 1]);
@@ -1315,22 +1665,22 @@ void cftf1st(int n, f32 *a, f32 *w)
         j1 = j + m;
         j2 = j1 + m;
         j3 = j2 + m;
-        x0r = a[j] + a[j2];
-        x0i = a[j + 1] + a[j2 + 1];
-        x1r = a[j] - a[j2];
-        x1i = a[j + 1] - a[j2 + 1];
-        y0r = a[j + 2] + a[j2 + 2];
-        y0i = a[j + 3] + a[j2 + 3];
-        y1r = a[j + 2] - a[j2 + 2];
-        y1i = a[j + 3] - a[j2 + 3];
-        x2r = a[j1] + a[j3];
-        x2i = a[j1 + 1] + a[j3 + 1];
-        x3r = a[j1] - a[j3];
-        x3i = a[j1 + 1] - a[j3 + 1];
-        y2r = a[j1 + 2] + a[j3 + 2];
-        y2i = a[j1 + 3] + a[j3 + 3];
-        y3r = a[j1 + 2] - a[j3 + 2];
-        y3i = a[j1 + 3] - a[j3 + 3];
+        x0r = s[j] + s[j2];
+        x0i = s[j + 1] + s[j2 + 1];
+        x1r = s[j] - s[j2];
+        x1i = s[j + 1] - s[j2 + 1];
+        y0r = s[j + 2] + s[j2 + 2];
+        y0i = s[j + 3] + s[j2 + 3];
+        y1r = s[j + 2] - s[j2 + 2];
+        y1i = s[j + 3] - s[j2 + 3];
+        x2r = s[j1] + s[j3];
+        x2i = s[j1 + 1] + s[j3 + 1];
+        x3r = s[j1] - s[j3];
+        x3i = s[j1 + 1] - s[j3 + 1];
+        y2r = s[j1 + 2] + s[j3 + 2];
+        y2i = s[j1 + 3] + s[j3 + 3];
+        y3r = s[j1 + 2] - s[j3 + 2];
+        y3i = s[j1 + 3] - s[j3 + 3];
         a[j] = x0r + x2r;
         a[j + 1] = x0i + x2i;
         a[j + 2] = y0r + y2r;
@@ -1359,22 +1709,22 @@ void cftf1st(int n, f32 *a, f32 *w)
         j1 = j0 + m;
         j2 = j1 + m;
         j3 = j2 + m;
-        x0r = a[j0] + a[j2];
-        x0i = a[j0 + 1] + a[j2 + 1];
-        x1r = a[j0] - a[j2];
-        x1i = a[j0 + 1] - a[j2 + 1];
-        y0r = a[j0 - 2] + a[j2 - 2];
-        y0i = a[j0 - 1] + a[j2 - 1];
-        y1r = a[j0 - 2] - a[j2 - 2];
-        y1i = a[j0 - 1] - a[j2 - 1];
-        x2r = a[j1] + a[j3];
-        x2i = a[j1 + 1] + a[j3 + 1];
-        x3r = a[j1] - a[j3];
-        x3i = a[j1 + 1] - a[j3 + 1];
-        y2r = a[j1 - 2] + a[j3 - 2];
-        y2i = a[j1 - 1] + a[j3 - 1];
-        y3r = a[j1 - 2] - a[j3 - 2];
-        y3i = a[j1 - 1] - a[j3 - 1];
+        x0r = s[j0] + s[j2];
+        x0i = s[j0 + 1] + s[j2 + 1];
+        x1r = s[j0] - s[j2];
+        x1i = s[j0 + 1] - s[j2 + 1];
+        y0r = s[j0 - 2] + s[j2 - 2];
+        y0i = s[j0 - 1] + s[j2 - 1];
+        y1r = s[j0 - 2] - s[j2 - 2];
+        y1i = s[j0 - 1] - s[j2 - 1];
+        x2r = s[j1] + s[j3];
+        x2i = s[j1 + 1] + s[j3 + 1];
+        x3r = s[j1] - s[j3];
+        x3i = s[j1 + 1] - s[j3 + 1];
+        y2r = s[j1 - 2] + s[j3 - 2];
+        y2i = s[j1 - 1] + s[j3 - 1];
+        y3r = s[j1 - 2] - s[j3 - 2];
+        y3i = s[j1 - 1] - s[j3 - 1];
         a[j0] = x0r + x2r;
         a[j0 + 1] = x0i + x2i;
         a[j0 - 2] = y0r + y2r;
@@ -1408,14 +1758,14 @@ void cftf1st(int n, f32 *a, f32 *w)
     j1 = j0 + m;
     j2 = j1 + m;
     j3 = j2 + m;
-    x0r = a[j0 - 2] + a[j2 - 2];
-    x0i = a[j0 - 1] + a[j2 - 1];
-    x1r = a[j0 - 2] - a[j2 - 2];
-    x1i = a[j0 - 1] - a[j2 - 1];
-    x2r = a[j1 - 2] + a[j3 - 2];
-    x2i = a[j1 - 1] + a[j3 - 1];
-    x3r = a[j1 - 2] - a[j3 - 2];
-    x3i = a[j1 - 1] - a[j3 - 1];
+    x0r = s[j0 - 2] + s[j2 - 2];
+    x0i = s[j0 - 1] + s[j2 - 1];
+    x1r = s[j0 - 2] - s[j2 - 2];
+    x1i = s[j0 - 1] - s[j2 - 1];
+    x2r = s[j1 - 2] + s[j3 - 2];
+    x2i = s[j1 - 1] + s[j3 - 1];
+    x3r = s[j1 - 2] - s[j3 - 2];
+    x3i = s[j1 - 1] - s[j3 - 1];
     a[j0 - 2] = x0r + x2r;
     a[j0 - 1] = x0i + x2i;
     a[j1 - 2] = x0r - x2r;
@@ -1428,14 +1778,14 @@ void cftf1st(int n, f32 *a, f32 *w)
     x0i = x1i - x3r;
     a[j3 - 2] = wk3r * x0r + wk3i * x0i;
     a[j3 - 1] = wk3r * x0i - wk3i * x0r;
-    x0r = a[j0] + a[j2];
-    x0i = a[j0 + 1] + a[j2 + 1];
-    x1r = a[j0] - a[j2];
-    x1i = a[j0 + 1] - a[j2 + 1];
-    x2r = a[j1] + a[j3];
-    x2i = a[j1 + 1] + a[j3 + 1];
-    x3r = a[j1] - a[j3];
-    x3i = a[j1 + 1] - a[j3 + 1];
+    x0r = s[j0] + s[j2];
+    x0i = s[j0 + 1] + s[j2 + 1];
+    x1r = s[j0] - s[j2];
+    x1i = s[j0 + 1] - s[j2 + 1];
+    x2r = s[j1] + s[j3];
+    x2i = s[j1 + 1] + s[j3 + 1];
+    x3r = s[j1] - s[j3];
+    x3i = s[j1 + 1] - s[j3 + 1];
     a[j0] = x0r + x2r;
     a[j0 + 1] = x0i + x2i;
     a[j1] = x0r - x2r;
@@ -1448,14 +1798,14 @@ void cftf1st(int n, f32 *a, f32 *w)
     x0i = x1i - x3r;
     a[j3] = -wn4r * (x0r + x0i);
     a[j3 + 1] = -wn4r * (x0i - x0r);
-    x0r = a[j0 + 2] + a[j2 + 2];
-    x0i = a[j0 + 3] + a[j2 + 3];
-    x1r = a[j0 + 2] - a[j2 + 2];
-    x1i = a[j0 + 3] - a[j2 + 3];
-    x2r = a[j1 + 2] + a[j3 + 2];
-    x2i = a[j1 + 3] + a[j3 + 3];
-    x3r = a[j1 + 2] - a[j3 + 2];
-    x3i = a[j1 + 3] - a[j3 + 3];
+    x0r = s[j0 + 2] + s[j2 + 2];
+    x0i = s[j0 + 3] + s[j2 + 3];
+    x1r = s[j0 + 2] - s[j2 + 2];
+    x1i = s[j0 + 3] - s[j2 + 3];
+    x2r = s[j1 + 2] + s[j3 + 2];
+    x2i = s[j1 + 3] + s[j3 + 3];
+    x3r = s[j1 + 2] - s[j3 + 2];
+    x3i = s[j1 + 3] - s[j3 + 3];
     a[j0 + 2] = x0r + x2r;
     a[j0 + 3] = x0i + x2i;
     a[j1 + 2] = x0r - x2r;
@@ -1471,7 +1821,7 @@ void cftf1st(int n, f32 *a, f32 *w)
 }
 
 
-void cftb1st(int n, f32 *a, f32 *w)
+void cftb1st_scalar(int n, f32 *a, f32 *w, int j_begin)
 {
     int j, j0, j1, j2, j3, k, m, mh;
     f32 wn4r, csc1, csc3, wk1r, wk1i, wk3r, wk3i, 
@@ -1507,8 +1857,14 @@ void cftb1st(int n, f32 *a, f32 *w)
     wd1i = 0;
     wd3r = 1;
     wd3i = 0;
-    k = 0;
-    for (j = 2; j < mh - 2; j += 4) {
+    k = j_begin - 2;
+    if (k > 0) {
+        wd1r = w[k];
+        wd1i = w[k + 1];
+        wd3r = w[k + 2];
+        wd3i = w[k + 3];
+    }
+    for (j = j_begin; j < mh - 2; j += 4) {
         k += 4;
         wk1r = csc1 * (wd1r + w[k]);
         wk1i = csc1 * (wd1i + w[k + 1]);
@@ -1734,7 +2090,7 @@ int cfttree(int n, int j, int k, f32 *a, int nw, f32 *w)
 }
 
 
-void cftleaf(int n, int isplt, f32 *a, int nw, f32 *w)
+void cftleaf_scalar(int n, int isplt, f32 *a, int nw, f32 *w)
 {
     void cftmdl1(int n, f32 *a, f32 *w);
     void cftmdl2(int n, f32 *a, f32 *w);
@@ -1799,7 +2155,7 @@ void cftleaf(int n, int isplt, f32 *a, int nw, f32 *w)
 }
 
 
-void cftmdl1(int n, f32 *a, f32 *w)
+void cftmdl1_scalar(int n, f32 *a, f32 *w, int j_begin)
 {
     int j, j0, j1, j2, j3, k, m, mh;
     f32 wn4r, wk1r, wk1i, wk3r, wk3i;
@@ -1827,8 +2183,8 @@ void cftmdl1(int n, f32 *a, f32 *w)
     a[j3] = x1r + x3i;
     a[j3 + 1] = x1i - x3r;
     wn4r = w[1];
-    k = 0;
-    for (j = 2; j < mh; j += 2) {
+    k = 2 * j_begin - 4;
+    for (j = j_begin; j < mh; j += 2) {
         k += 4;
         wk1r = w[k];
         wk1i = w[k + 1];
@@ -1909,7 +2265,7 @@ void cftmdl1(int n, f32 *a, f32 *w)
 }
 
 
-void cftmdl2(int n, f32 *a, f32 *w)
+void cftmdl2_scalar(int n, f32 *a, f32 *w, int j_begin)
 {
     int j, j0, j1, j2, j3, k, kr, m, mh;
     f32 wn4r, wk1r, wk1i, wk3r, wk3i, wd1r, wd1i, wd3r, wd3i;
@@ -1941,9 +2297,9 @@ void cftmdl2(int n, f32 *a, f32 *w)
     a[j2 + 1] = x1i + y0r;
     a[j3] = x1r + y0i;
     a[j3 + 1] = x1i - y0r;
-    k = 0;
-    kr = 2 * m;
-    for (j = 2; j < mh; j += 2) {
+    k = 2 * j_begin - 4;
+    kr = 2 * m - k;
+    for (j = j_begin; j < mh; j += 2) {
         k += 4;
         wk1r = w[k];
         wk1i = w[k + 1];
@@ -2043,7 +2399,7 @@ void cftmdl2(int n, f32 *a, f32 *w)
 }
 
 
-void cftfx41(int n, f32 *a, int nw, f32 *w)
+void cftfx41_scalar(int n, f32 *a, int nw, f32 *w)
 {
     void cftf161(f32 *a, f32 *w);
     void cftf162(f32 *a, f32 *w);
@@ -2599,15 +2955,15 @@ void cftx020(f32 *a)
 }
 
 
-void rftfsub(int n, f32 *a, int nc, f32 *c)
+void rftfsub_scalar(int n, f32 *a, int nc, f32 *c, int j_begin)
 {
     int j, k, kk, ks, m;
     f32 wkr, wki, xr, xi, yr, yi;
     
     m = n >> 1;
     ks = 2 * nc / m;
-    kk = 0;
-    for (j = 2; j < m; j += 2) {
+    kk = (j_begin - 2) / 2 * ks;
+    for (j = j_begin; j < m; j += 2) {
         k = n - j;
         kk += ks;
         wkr = 0.5 - c[nc - kk];
@@ -2624,26 +2980,68 @@ void rftfsub(int n, f32 *a, int nc, f32 *c)
 }
 
 
-void rftbsub(int n, f32 *a, int nc, f32 *c)
+void rftbsub_scalar(int n, f32 const *s, f32 *a, int nc, f32 *c, int j_begin)
 {
     int j, k, kk, ks, m;
     f32 wkr, wki, xr, xi, yr, yi;
     
     m = n >> 1;
     ks = 2 * nc / m;
-    kk = 0;
-    for (j = 2; j < m; j += 2) {
+    kk = (j_begin - 2) / 2 * ks;
+    for (j = j_begin; j < m; j += 2) {
         k = n - j;
         kk += ks;
         wkr = 0.5 - c[nc - kk];
         wki = c[kk];
-        xr = a[j] - a[k];
-        xi = a[j + 1] + a[k + 1];
+        xr = s[j] - s[k];
+        xi = s[j + 1] + s[k + 1];
         yr = wkr * xr + wki * xi;
         yi = wkr * xi - wki * xr;
-        a[j] -= yr;
-        a[j + 1] -= yi;
-        a[k] += yr;
-        a[k + 1] -= yi;
+        a[j] = s[j] - yr;
+        a[j + 1] = s[j + 1] - yi;
+        a[k] = s[k] + yr;
+        a[k + 1] = s[k + 1] - yi;
+    }
+}
+
+
+void dctsub_scalar(int n, f32 *a, int nc, f32 *c, int j_begin)
+{
+    int j, k, kk, ks, m;
+    f32 wkr, wki, xr;
+    
+    m = n >> 1;
+    ks = nc / n;
+    kk = (j_begin - 1) * ks;
+    for (j = j_begin; j < m; j++) {
+        k = n - j;
+        kk += ks;
+        wkr = c[kk] - c[nc - kk];
+        wki = c[kk] + c[nc - kk];
+        xr = wki * a[j] - wkr * a[k];
+        a[j] = wkr * a[j] + wki * a[k];
+        a[k] = xr;
+    }
+    a[m] *= c[0];
+}
+
+
+void dstsub_scalar(int n, f32 *a, int nc, f32 *c, int j_begin)
+{
+    int j, k, kk, ks, m;
+    f32 wkr, wki, xr;
+    
+    m = n >> 1;
+    ks = nc / n;
+    kk = (j_begin - 1) * ks;
+    for (j = j_begin; j < m; j++) {
+        k = n - j;
+        kk += ks;
+        wkr = c[kk] - c[nc - kk];
+        wki = c[kk] + c[nc - kk];
+        xr = wki * a[k] - wkr * a[j];
+        a[k] = wkr * a[k] + wki * a[j];
+        a[j] = xr;
     }
+    a[m] *= c[0];
 }
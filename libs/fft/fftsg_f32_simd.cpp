@@ -0,0 +1,2031 @@
+// Vectorized butterfly stages for fftsg_f32.cpp
+// Each kernel runs the main loop of its scalar counterpart on 2 (SSE), 4 (AVX2) or 8 (AVX-512) complex values
+// at a time, starting at complex index c (k), and hands the remaining iterations to a narrower version
+// dctsub/dstsub work on 4, 8 or 16 real values from index j
+// The AVX2 and AVX-512 kernels are compiled with target attributes and bound at runtime (see dispatch)
+// They clear the upper register state before handing over to code compiled for the baseline (SSE) ISA
+// cftleaf/cftfx41 run the 16 and 8 point leaves on rows of 4 complex values: 2 SSE registers or 1 AVX2 register
+// bitrv2 swaps transposed blocks of 2 x 2 (SSE) or 4 x 4 (AVX2) complex values
+
+
+// past this many floats the block rows of bitrv2 are a power of 2 of at least 16 KB apart
+// and every swap misses the cache, the scalar permutation is faster there
+static constexpr int BITRV2_BLOCKS_MAX_SIZE = 8192;
+
+
+/* simd 128 */
+
+#ifdef FFT_SIMD_128
+
+namespace simd128
+{
+    using f32x4 = __m128;
+
+
+    static inline f32x4 load(f32 const* src) { return _mm_loadu_ps(src); }
+
+    static inline void store(f32* dst, f32x4 v) { _mm_storeu_ps(dst, v); }
+
+    static inline f32x4 add(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+
+    static inline f32x4 sub(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+
+    static inline f32x4 mul(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+
+
+    static inline f32x4 sign_even_128() { return _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f); }
+
+    static inline f32x4 sign_odd_128() { return _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f); }
+
+
+    // (re, im) -> (im, re)
+    static inline f32x4 swap(f32x4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)); }
+
+    // reverse the order of the complex values
+    static inline f32x4 reverse(f32x4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)); }
+
+    // reverse the order of the floats
+    static inline f32x4 flip(f32x4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3)); }
+
+    static inline f32x4 conj(f32x4 v) { return _mm_xor_ps(v, sign_odd_128()); }
+
+    static inline f32x4 mul_i(f32x4 v) { return _mm_xor_ps(swap(v), sign_even_128()); }
+
+
+    // x * w
+    static inline f32x4 cmul(f32x4 x, f32x4 w)
+    {
+        auto wr = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+        auto wi = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+        auto t = _mm_mul_ps(swap(x), wi);
+
+        return _mm_add_ps(_mm_mul_ps(x, wr), _mm_xor_ps(t, sign_even_128()));
+    }
+
+
+    // x * conj(w)
+    static inline f32x4 cmulc(f32x4 x, f32x4 w)
+    {
+        auto wr = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+        auto wi = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+        auto t = _mm_mul_ps(swap(x), wi);
+
+        return _mm_add_ps(_mm_mul_ps(x, wr), _mm_xor_ps(t, sign_odd_128()));
+    }
+
+
+    // wk1 and wk3 for 2 consecutive entries of an Ooura w table
+    static inline void twiddles(f32x4 w0, f32x4 w1, f32x4& wk1, f32x4& wk3)
+    {
+        wk1 = _mm_movelh_ps(w0, w1);
+        wk3 = _mm_movehl_ps(w1, w0);
+    }
+}
+
+
+namespace simd128
+{
+    // forward radix-4 butterfly, 2 complex values per leg, reads s and writes a
+    static inline void bfly4f(f32 const* s, f32* a, int m, f32x4 wk1, f32x4 wk3)
+    {
+        auto A = load(s);
+        auto B = load(s + m);
+        auto C = load(s + 2 * m);
+        auto D = load(s + 3 * m);
+
+        auto x0 = add(A, C);
+        auto x1 = sub(A, C);
+        auto x2 = add(B, D);
+        auto x3 = mul_i(sub(B, D));
+
+        store(a, add(x0, x2));
+        store(a + m, sub(x0, x2));
+        store(a + 2 * m, cmul(add(x1, x3), wk1));
+        store(a + 3 * m, cmulc(sub(x1, x3), wk3));
+    }
+
+
+    static inline void bfly4f(f32* a, int m, f32x4 wk1, f32x4 wk3) { bfly4f(a, a, m, wk1, wk3); }
+
+
+    // backward radix-4 butterfly, 2 complex values per leg
+    static inline void bfly4b(f32* a, int m, f32x4 wk1, f32x4 wk3)
+    {
+        auto A = load(a);
+        auto B = load(a + m);
+        auto C = load(a + 2 * m);
+        auto D = load(a + 3 * m);
+
+        auto x0 = conj(add(A, C));
+        auto x1 = conj(sub(A, C));
+        auto x2 = conj(add(B, D));
+        auto x3 = mul_i(conj(sub(B, D)));
+
+        store(a, add(x0, x2));
+        store(a + m, sub(x0, x2));
+        store(a + 2 * m, cmul(add(x1, x3), wk1));
+        store(a + 3 * m, cmulc(sub(x1, x3), wk3));
+    }
+
+
+    // cftmdl2 butterfly, 2 complex values per leg
+    static inline void bfly4m2(f32* a, int m, f32x4 wa1, f32x4 wa3, f32x4 wb1, f32x4 wb3)
+    {
+        auto A = load(a);
+        auto B = load(a + m);
+        auto iC = mul_i(load(a + 2 * m));
+        auto iD = mul_i(load(a + 3 * m));
+
+        auto y0 = cmul(add(A, iC), wa1);
+        auto y2 = cmul(add(B, iD), wb1);
+
+        store(a, add(y0, y2));
+        store(a + m, sub(y0, y2));
+
+        y0 = cmulc(sub(A, iC), wa3);
+        y2 = cmulc(sub(B, iD), wb3);
+
+        store(a + 2 * m, add(y0, y2));
+        store(a + 3 * m, sub(y0, y2));
+    }
+}
+
+
+void cftf1st_128(int n, f32 const *s, f32 *a, f32 *w, int c)
+{
+    using namespace simd128;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    auto csc = _mm_setr_ps(w[2], w[2], w[3], w[3]);
+    auto one = _mm_setr_ps(1.0f, 0.0f, 1.0f, 0.0f);
+
+    // complex c is odd, twiddles are interpolated from the even neighbors
+    for (; c + 1 < mh / 2 - 1; c += 2)
+    {
+        auto w0 = c == 1 ? one : load(w + 2 * (c - 1));
+        auto w1 = load(w + 2 * (c + 1));
+        auto wo = _mm_mul_ps(add(w0, w1), csc);
+
+        f32x4 wk1, wk3;
+        twiddles(wo, w1, wk1, wk3);
+
+        bfly4f(s + 2 * c, a + 2 * c, m, wk1, wk3);
+        bfly4f(s + m - 2 * c - 2, a + m - 2 * c - 2, m, swap(reverse(wk1)), swap(reverse(wk3)));
+    }
+
+    cftf1st_scalar(n, s, a, w, 2 * c);
+}
+
+
+void cftb1st_128(int n, f32 *a, f32 *w, int c)
+{
+    using namespace simd128;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    auto csc = _mm_setr_ps(w[2], w[2], w[3], w[3]);
+    auto one = _mm_setr_ps(1.0f, 0.0f, 1.0f, 0.0f);
+
+    for (; c + 1 < mh / 2 - 1; c += 2)
+    {
+        auto w0 = c == 1 ? one : load(w + 2 * (c - 1));
+        auto w1 = load(w + 2 * (c + 1));
+        auto wo = _mm_mul_ps(add(w0, w1), csc);
+
+        f32x4 wk1, wk3;
+        twiddles(wo, w1, wk1, wk3);
+
+        bfly4b(a + 2 * c, m, wk1, wk3);
+        bfly4b(a + m - 2 * c - 2, m, swap(reverse(wk1)), swap(reverse(wk3)));
+    }
+
+    cftb1st_scalar(n, a, w, 2 * c);
+}
+
+
+void cftmdl1_128(int n, f32 *a, f32 *w, int c)
+{
+    using namespace simd128;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    for (; c + 1 < mh / 2; c += 2)
+    {
+        f32x4 wk1, wk3;
+        twiddles(load(w + 4 * c), load(w + 4 * c + 4), wk1, wk3);
+
+        bfly4f(a + 2 * c, m, wk1, wk3);
+        bfly4f(a + m - 2 * c - 2, m, swap(reverse(wk1)), swap(reverse(wk3)));
+    }
+
+    cftmdl1_scalar(n, a, w, 2 * c);
+}
+
+
+void cftmdl2_128(int n, f32 *a, f32 *w, int c)
+{
+    using namespace simd128;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    for (; c + 1 < mh / 2; c += 2)
+    {
+        int cr = mh - c - 1;
+
+        f32x4 wf1, wf3, wm1, wm3;
+        twiddles(load(w + 4 * c), load(w + 4 * c + 4), wf1, wf3);
+        twiddles(load(w + 4 * cr), load(w + 4 * cr + 4), wm1, wm3);
+
+        bfly4m2(a + 2 * c, m, wf1, wf3, swap(reverse(wm1)), swap(reverse(wm3)));
+        bfly4m2(a + 2 * cr, m, wm1, wm3, swap(reverse(wf1)), swap(reverse(wf3)));
+    }
+
+    cftmdl2_scalar(n, a, w, 2 * c);
+}
+
+
+void rftfsub_128(int n, f32 *a, int nc, f32 *c, int k)
+{
+    using namespace simd128;
+
+    int m = n >> 1;
+    if (2 * nc / m != 1)
+    {
+        rftfsub_scalar(n, a, nc, c, 2);
+        return;
+    }
+
+    for (; k + 1 < m / 2; k += 2)
+    {
+        auto wk = _mm_setr_ps(0.5f - c[nc - k], c[k], 0.5f - c[nc - k - 1], c[k + 1]);
+
+        auto A = load(a + 2 * k);
+        auto K = reverse(load(a + n - 2 * k - 2));
+
+        auto y = cmul(sub(A, conj(K)), wk);
+
+        store(a + 2 * k, sub(A, y));
+        store(a + n - 2 * k - 2, reverse(add(K, conj(y))));
+    }
+
+    rftfsub_scalar(n, a, nc, c, 2 * k);
+}
+
+
+void rftbsub_128(int n, f32 const *s, f32 *a, int nc, f32 *c, int k)
+{
+    using namespace simd128;
+
+    int m = n >> 1;
+    if (2 * nc / m != 1)
+    {
+        rftbsub_scalar(n, s, a, nc, c, 2);
+        return;
+    }
+
+    for (; k + 1 < m / 2; k += 2)
+    {
+        auto wk = _mm_setr_ps(0.5f - c[nc - k], c[k], 0.5f - c[nc - k - 1], c[k + 1]);
+
+        auto A = load(s + 2 * k);
+        auto K = reverse(load(s + n - 2 * k - 2));
+
+        auto y = cmulc(sub(A, conj(K)), wk);
+
+        store(a + 2 * k, sub(A, y));
+        store(a + n - 2 * k - 2, reverse(add(K, conj(y))));
+    }
+
+    rftbsub_scalar(n, s, a, nc, c, 2 * k);
+}
+
+
+void dctsub_128(int n, f32 *a, int nc, f32 *c, int j)
+{
+    using namespace simd128;
+
+    int m = n >> 1;
+    if (nc != n)
+    {
+        dctsub_scalar(n, a, nc, c, 1);
+        return;
+    }
+
+    for (; j + 3 < m; j += 4)
+    {
+        auto cj = load(c + j);
+        auto ck = flip(load(c + n - j - 3));
+        auto wkr = sub(cj, ck);
+        auto wki = add(cj, ck);
+
+        auto A = load(a + j);
+        auto K = flip(load(a + n - j - 3));
+
+        store(a + j, add(mul(wkr, A), mul(wki, K)));
+        store(a + n - j - 3, flip(sub(mul(wki, A), mul(wkr, K))));
+    }
+
+    dctsub_scalar(n, a, nc, c, j);
+}
+
+
+void dstsub_128(int n, f32 *a, int nc, f32 *c, int j)
+{
+    using namespace simd128;
+
+    int m = n >> 1;
+    if (nc != n)
+    {
+        dstsub_scalar(n, a, nc, c, 1);
+        return;
+    }
+
+    for (; j + 3 < m; j += 4)
+    {
+        auto cj = load(c + j);
+        auto ck = flip(load(c + n - j - 3));
+        auto wkr = sub(cj, ck);
+        auto wki = add(cj, ck);
+
+        auto A = load(a + j);
+        auto K = flip(load(a + n - j - 3));
+
+        store(a + j, sub(mul(wki, K), mul(wkr, A)));
+        store(a + n - j - 3, flip(add(mul(wkr, K), mul(wki, A))));
+    }
+
+    dstsub_scalar(n, a, nc, c, j);
+}
+
+
+namespace simd128
+{
+    // 4 complex values, one row of a leaf codelet
+    class Row4
+    {
+    public:
+        f32x4 lo; // 0 and 1
+        f32x4 hi; // 2 and 3
+    };
+
+
+    static inline Row4 load4(f32 const* src) { return { load(src), load(src + 4) }; }
+
+    static inline void store4(f32* dst, Row4 v) { store(dst, v.lo); store(dst + 4, v.hi); }
+
+    static inline Row4 set4(f32 r0, f32 i0, f32 r1, f32 i1, f32 r2, f32 i2, f32 r3, f32 i3)
+    {
+        return { _mm_setr_ps(r0, i0, r1, i1), _mm_setr_ps(r2, i2, r3, i3) };
+    }
+
+    static inline Row4 add(Row4 a, Row4 b) { return { add(a.lo, b.lo), add(a.hi, b.hi) }; }
+
+    static inline Row4 sub(Row4 a, Row4 b) { return { sub(a.lo, b.lo), sub(a.hi, b.hi) }; }
+
+    static inline Row4 mul_i(Row4 v) { return { mul_i(v.lo), mul_i(v.hi) }; }
+
+    static inline Row4 cmul(Row4 x, Row4 w) { return { cmul(x.lo, w.lo), cmul(x.hi, w.hi) }; }
+
+
+    // (v0 + v1, v0 - v1)
+    static inline f32x4 bfly2(f32x4 v)
+    {
+        return add(_mm_movelh_ps(v, v), _mm_xor_ps(_mm_movehl_ps(v, v), _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f)));
+    }
+
+
+    // 0 + 2, 1 + 3, 0 - 2, 1 - 3
+    static inline Row4 halves(Row4 v) { return { add(v.lo, v.hi), sub(v.lo, v.hi) }; }
+
+    // 0 + 1, 0 - 1, 2 + 3, 2 - 3
+    static inline Row4 pairs(Row4 v) { return { bfly2(v.lo), bfly2(v.hi) }; }
+
+    // 0, 1, i 2, i 3
+    static inline Row4 mul_i23(Row4 v) { return { v.lo, mul_i(v.hi) }; }
+
+    // 0, 1, 2, i 3
+    static inline Row4 mul_i3(Row4 v) { return { v.lo, _mm_shuffle_ps(v.hi, mul_i(v.hi), _MM_SHUFFLE(3, 2, 1, 0)) }; }
+
+    // the 4 point DFT every leaf ends with, in bit reversed order
+    static inline Row4 dft4(Row4 v) { return pairs(mul_i3(halves(v))); }
+}
+
+
+namespace simd128
+{
+    // cftf161/cftf162 as two radix-4 passes on rows of 4 complex values
+    // the first across the rows, the second a dft4 within each row
+    // the twiddles of both passes become one factor per value, 1 and +-i stay exact
+    class Leaf16
+    {
+    public:
+        Row4 f1;
+        Row4 f2;
+        Row4 f3;
+
+        // cftf162
+        Row4 p;
+        Row4 q;
+        Row4 pc;
+        Row4 s;
+        Row4 g2;
+        Row4 g3;
+    };
+
+
+    // cftf081/cftf082 with a row of 4 complex values per half
+    class Leaf8
+    {
+    public:
+        Row4 g1;
+        Row4 k1;
+        Row4 k2;
+    };
+
+
+    // w1 = &w[nw - 8] for cftf161, w2 = &w[nw - 32] for cftf162
+    static inline Leaf16 leaf16(f32 const* w1, f32 const* w2)
+    {
+        auto wn4r = w1[1];
+        auto wk1r = w1[2];
+        auto wk1i = w1[3];
+
+        Leaf16 t;
+
+        t.f1 = set4(1.0f, 0.0f, wn4r, wn4r, 0.0f, 1.0f, -wn4r, wn4r);
+        t.f2 = set4(1.0f, 0.0f, wk1r, wk1i, wn4r, wn4r, wk1i, wk1r);
+        t.f3 = set4(1.0f, 0.0f, wk1i, wk1r, -wn4r, wn4r, -wk1r, -wk1i);
+
+        wn4r = w2[1];
+        wk1r = w2[4];
+        wk1i = w2[5];
+        auto wk3r = w2[6];
+        auto wk3i = -w2[7];
+        auto wk2r = w2[8];
+        auto wk2i = w2[9];
+
+        t.p = set4(1.0f, 0.0f, wk1r, wk1i, wk2r, wk2i, wk3r, wk3i);
+        t.q = set4(wn4r, wn4r, wk3i, wk3r, wk2i, wk2r, wk1i, wk1r);
+        t.pc = set4(1.0f, 0.0f, wk3r, wk3i, wk2i, wk2r, wk1i, -wk1r);
+        t.s = set4(-wn4r, wn4r, -wk1r, wk1i, -wk2r, -wk2i, wk3i, wk3r);
+        t.g2 = set4(1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f);
+        t.g3 = set4(1.0f, 0.0f, wn4r, wn4r, 0.0f, 1.0f, wn4r, -wn4r);
+
+        return t;
+    }
+
+
+    // w1 = &w[nw - 8]
+    static inline Leaf8 leaf8(f32 const* w1)
+    {
+        auto wn4r = w1[1];
+        auto wk1r = w1[2];
+        auto wk1i = w1[3];
+
+        Leaf8 t;
+
+        t.g1 = set4(1.0f, 0.0f, wn4r, wn4r, 1.0f, 0.0f, -wn4r, wn4r);
+        t.k1 = set4(1.0f, 0.0f, wk1r, wk1i, wn4r, wn4r, wk1i, wk1r);
+        t.k2 = set4(1.0f, 0.0f, wk1i, wk1r, -wn4r, wn4r, -wk1r, -wk1i);
+
+        return t;
+    }
+
+
+    static inline void leaf161(f32* a, Leaf16 const& t)
+    {
+        auto R0 = load4(a);
+        auto R1 = load4(a + 8);
+        auto R2 = load4(a + 16);
+        auto R3 = load4(a + 24);
+
+        auto x0 = add(R0, R2);
+        auto x1 = sub(R0, R2);
+        auto x2 = add(R1, R3);
+        auto x3 = mul_i(sub(R1, R3));
+
+        store4(a, dft4(add(x0, x2)));
+        store4(a + 8, dft4(cmul(sub(x0, x2), t.f1)));
+        store4(a + 16, dft4(cmul(add(x1, x3), t.f2)));
+        store4(a + 24, dft4(cmul(sub(x1, x3), t.f3)));
+    }
+
+
+    static inline void leaf162(f32* a, Leaf16 const& t)
+    {
+        auto R0 = load4(a);
+        auto R1 = load4(a + 8);
+        auto iR2 = mul_i(load4(a + 16));
+        auto iR3 = mul_i(load4(a + 24));
+
+        auto u = cmul(add(R0, iR2), t.p);
+        auto v = cmul(add(R1, iR3), t.q);
+
+        store4(a, dft4(add(u, v)));
+        store4(a + 8, dft4(cmul(sub(u, v), t.f1)));
+
+        u = cmul(sub(R0, iR2), t.pc);
+        v = cmul(sub(R1, iR3), t.s);
+
+        store4(a + 16, dft4(cmul(add(u, v), t.g2)));
+        store4(a + 24, dft4(cmul(sub(u, v), t.g3)));
+    }
+
+
+    static inline void leaf081(f32* a, Leaf8 const& t)
+    {
+        auto R0 = load4(a);
+        auto R1 = load4(a + 8);
+
+        auto x = halves(add(R0, R1));
+        auto y = halves(mul_i23(sub(R0, R1)));
+
+        store4(a, pairs(mul_i3(x)));
+        store4(a + 8, pairs(cmul(y, t.g1)));
+    }
+
+
+    static inline void leaf082(f32* a, Leaf8 const& t)
+    {
+        auto R0 = load4(a);
+        auto iR1 = mul_i(load4(a + 8));
+
+        store4(a, dft4(cmul(add(R0, iR1), t.k1)));
+        store4(a + 8, dft4(cmul(sub(R0, iR1), t.k2)));
+    }
+}
+
+
+void cftleaf_128(int n, int isplt, f32 *a, int nw, f32 *w)
+{
+    using namespace simd128;
+
+    if (n == 512)
+    {
+        auto t = leaf16(&w[nw - 8], &w[nw - 32]);
+
+        cftmdl1_128(128, a, &w[nw - 64], 1);
+        leaf161(a, t);
+        leaf162(&a[32], t);
+        leaf161(&a[64], t);
+        leaf161(&a[96], t);
+        cftmdl2_128(128, &a[128], &w[nw - 128], 1);
+        leaf161(&a[128], t);
+        leaf162(&a[160], t);
+        leaf161(&a[192], t);
+        leaf162(&a[224], t);
+        cftmdl1_128(128, &a[256], &w[nw - 64], 1);
+        leaf161(&a[256], t);
+        leaf162(&a[288], t);
+        leaf161(&a[320], t);
+        leaf161(&a[352], t);
+        if (isplt != 0)
+        {
+            cftmdl1_128(128, &a[384], &w[nw - 64], 1);
+            leaf161(&a[480], t);
+        }
+        else
+        {
+            cftmdl2_128(128, &a[384], &w[nw - 128], 1);
+            leaf162(&a[480], t);
+        }
+        leaf161(&a[384], t);
+        leaf162(&a[416], t);
+        leaf161(&a[448], t);
+    }
+    else
+    {
+        auto t = leaf8(&w[nw - 8]);
+
+        cftmdl1_128(64, a, &w[nw - 32], 1);
+        leaf081(a, t);
+        leaf082(&a[16], t);
+        leaf081(&a[32], t);
+        leaf081(&a[48], t);
+        cftmdl2_128(64, &a[64], &w[nw - 64], 1);
+        leaf081(&a[64], t);
+        leaf082(&a[80], t);
+        leaf081(&a[96], t);
+        leaf082(&a[112], t);
+        cftmdl1_128(64, &a[128], &w[nw - 32], 1);
+        leaf081(&a[128], t);
+        leaf082(&a[144], t);
+        leaf081(&a[160], t);
+        leaf081(&a[176], t);
+        if (isplt != 0)
+        {
+            cftmdl1_128(64, &a[192], &w[nw - 32], 1);
+            leaf081(&a[240], t);
+        }
+        else
+        {
+            cftmdl2_128(64, &a[192], &w[nw - 64], 1);
+            leaf082(&a[240], t);
+        }
+        leaf081(&a[192], t);
+        leaf082(&a[208], t);
+        leaf081(&a[224], t);
+    }
+}
+
+
+void cftfx41_128(int n, f32 *a, int nw, f32 *w)
+{
+    using namespace simd128;
+
+    if (n == 128)
+    {
+        auto t = leaf16(&w[nw - 8], &w[nw - 32]);
+
+        leaf161(a, t);
+        leaf162(&a[32], t);
+        leaf161(&a[64], t);
+        leaf161(&a[96], t);
+    }
+    else
+    {
+        auto t = leaf8(&w[nw - 8]);
+
+        leaf081(a, t);
+        leaf082(&a[16], t);
+        leaf081(&a[32], t);
+        leaf081(&a[48], t);
+    }
+}
+
+
+namespace simd128
+{
+    // the n / 2 complex values as 2 rows, 2 x 2 blocks of a row and the next
+    // complex (h, j, l) goes to (l, rev(j), h), so block j is transposed into block rev(j)
+    template <bool CONJ>
+    static inline void bitrv2_blocks(int n, f32 *a)
+    {
+        int nr = n >> 1;
+        int nb = n >> 3;
+
+        auto sign = CONJ ? sign_odd_128() : _mm_setzero_ps();
+
+        for (int j = 0, r = 0; j < nb; j++)
+        {
+            if (j <= r)
+            {
+                auto a0 = a + 4 * j;
+                auto b0 = a + 4 * r;
+
+                auto x0 = load(a0);
+                auto x1 = load(a0 + nr);
+                auto y0 = load(b0);
+                auto y1 = load(b0 + nr);
+
+                store(b0, _mm_xor_ps(_mm_movelh_ps(x0, x1), sign));
+                store(b0 + nr, _mm_xor_ps(_mm_movehl_ps(x1, x0), sign));
+                store(a0, _mm_xor_ps(_mm_movelh_ps(y0, y1), sign));
+                store(a0 + nr, _mm_xor_ps(_mm_movehl_ps(y1, y0), sign));
+            }
+
+            // r = rev(j + 1)
+            int bit = nb >> 1;
+            while (r & bit)
+            {
+                r ^= bit;
+                bit >>= 1;
+            }
+            r |= bit;
+        }
+    }
+}
+
+
+void bitrv2_128(int n, int *ip, f32 *a)
+{
+    if (n > BITRV2_BLOCKS_MAX_SIZE)
+    {
+        bitrv2_scalar(n, ip, a);
+        return;
+    }
+
+    simd128::bitrv2_blocks<false>(n, a);
+}
+
+
+void bitrv2conj_128(int n, int *ip, f32 *a)
+{
+    if (n > BITRV2_BLOCKS_MAX_SIZE)
+    {
+        bitrv2conj_scalar(n, ip, a);
+        return;
+    }
+
+    simd128::bitrv2_blocks<true>(n, a);
+}
+
+#endif // FFT_SIMD_128
+
+
+/* simd 256 */
+
+#ifdef FFT_SIMD_256
+
+namespace simd256
+{
+    using f32x8 = __m256;
+
+
+    CPU_TARGET_AVX2 static inline f32x8 load(f32 const* src) { return _mm256_loadu_ps(src); }
+
+    CPU_TARGET_AVX2 static inline void store(f32* dst, f32x8 v) { _mm256_storeu_ps(dst, v); }
+
+    CPU_TARGET_AVX2 static inline f32x8 add(f32x8 a, f32x8 b) { return _mm256_add_ps(a, b); }
+
+    CPU_TARGET_AVX2 static inline f32x8 sub(f32x8 a, f32x8 b) { return _mm256_sub_ps(a, b); }
+
+    CPU_TARGET_AVX2 static inline f32x8 mul(f32x8 a, f32x8 b) { return _mm256_mul_ps(a, b); }
+
+
+    CPU_TARGET_AVX2 static inline f32x8 sign_even_256() { return _mm256_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f); }
+
+    CPU_TARGET_AVX2 static inline f32x8 sign_odd_256() { return _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f); }
+
+
+    CPU_TARGET_AVX2 static inline f32x8 swap(f32x8 v) { return _mm256_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1)); }
+
+    CPU_TARGET_AVX2 static inline f32x8 reverse(f32x8 v)
+    {
+        return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v), _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+
+    CPU_TARGET_AVX2 static inline f32x8 flip(f32x8 v)
+    {
+        return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+
+    CPU_TARGET_AVX2 static inline f32x8 conj(f32x8 v) { return _mm256_xor_ps(v, sign_odd_256()); }
+
+    CPU_TARGET_AVX2 static inline f32x8 mul_i(f32x8 v) { return _mm256_xor_ps(swap(v), sign_even_256()); }
+
+
+    CPU_TARGET_AVX2 static inline f32x8 cmul(f32x8 x, f32x8 w)
+    {
+        auto t = _mm256_mul_ps(swap(x), _mm256_movehdup_ps(w));
+
+        return _mm256_fmaddsub_ps(x, _mm256_moveldup_ps(w), t);
+    }
+
+
+    CPU_TARGET_AVX2 static inline f32x8 cmulc(f32x8 x, f32x8 w)
+    {
+        auto t = _mm256_mul_ps(swap(x), _mm256_movehdup_ps(w));
+
+        return _mm256_fmsubadd_ps(x, _mm256_moveldup_ps(w), t);
+    }
+
+
+    // wk1 and wk3 for 4 consecutive entries of an Ooura w table
+    CPU_TARGET_AVX2 static inline void twiddles(f32x8 w0, f32x8 w1, f32x8& wk1, f32x8& wk3)
+    {
+        auto d0 = _mm256_castps_pd(w0);
+        auto d1 = _mm256_castps_pd(w1);
+
+        wk1 = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_unpacklo_pd(d0, d1), _MM_SHUFFLE(3, 1, 2, 0)));
+        wk3 = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_unpackhi_pd(d0, d1), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+}
+
+
+namespace simd256
+{
+    CPU_TARGET_AVX2 static inline void bfly4f(f32 const* s, f32* a, int m, f32x8 wk1, f32x8 wk3)
+    {
+        auto A = load(s);
+        auto B = load(s + m);
+        auto C = load(s + 2 * m);
+        auto D = load(s + 3 * m);
+
+        auto x0 = add(A, C);
+        auto x1 = sub(A, C);
+        auto x2 = add(B, D);
+        auto x3 = mul_i(sub(B, D));
+
+        store(a, add(x0, x2));
+        store(a + m, sub(x0, x2));
+        store(a + 2 * m, cmul(add(x1, x3), wk1));
+        store(a + 3 * m, cmulc(sub(x1, x3), wk3));
+    }
+
+
+    CPU_TARGET_AVX2 static inline void bfly4f(f32* a, int m, f32x8 wk1, f32x8 wk3) { bfly4f(a, a, m, wk1, wk3); }
+
+
+    CPU_TARGET_AVX2 static inline void bfly4b(f32* a, int m, f32x8 wk1, f32x8 wk3)
+    {
+        auto A = load(a);
+        auto B = load(a + m);
+        auto C = load(a + 2 * m);
+        auto D = load(a + 3 * m);
+
+        auto x0 = conj(add(A, C));
+        auto x1 = conj(sub(A, C));
+        auto x2 = conj(add(B, D));
+        auto x3 = mul_i(conj(sub(B, D)));
+
+        store(a, add(x0, x2));
+        store(a + m, sub(x0, x2));
+        store(a + 2 * m, cmul(add(x1, x3), wk1));
+        store(a + 3 * m, cmulc(sub(x1, x3), wk3));
+    }
+
+
+    CPU_TARGET_AVX2 static inline void bfly4m2(f32* a, int m, f32x8 wa1, f32x8 wa3, f32x8 wb1, f32x8 wb3)
+    {
+        auto A = load(a);
+        auto B = load(a + m);
+        auto iC = mul_i(load(a + 2 * m));
+        auto iD = mul_i(load(a + 3 * m));
+
+        auto y0 = cmul(add(A, iC), wa1);
+        auto y2 = cmul(add(B, iD), wb1);
+
+        store(a, add(y0, y2));
+        store(a + m, sub(y0, y2));
+
+        y0 = cmulc(sub(A, iC), wa3);
+        y2 = cmulc(sub(B, iD), wb3);
+
+        store(a + 2 * m, add(y0, y2));
+        store(a + 3 * m, sub(y0, y2));
+    }
+
+
+    // cftf1st/cftb1st twiddles for odd complex c to c + 3
+    CPU_TARGET_AVX2 static inline void twiddles_1st(f32* w, int c, f32x8 csc, f32x8& wk1, f32x8& wk3)
+    {
+        auto w0 = load(w + 2 * (c - 1));
+        auto w1 = load(w + 2 * (c + 1));
+
+        if (c == 1)
+        {
+            w0 = _mm256_blend_ps(w0, _mm256_setr_ps(1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f), 0x0F);
+        }
+
+        auto wo = _mm256_castps_pd(_mm256_mul_ps(add(w0, w1), csc));
+        auto we = _mm256_castps_pd(w1);
+
+        wk1 = _mm256_castpd_ps(_mm256_unpacklo_pd(wo, we));
+        wk3 = _mm256_castpd_ps(_mm256_unpackhi_pd(wo, we));
+    }
+}
+
+
+CPU_TARGET_AVX2
+void cftf1st_256(int n, f32 const *s, f32 *a, f32 *w, int c)
+{
+    using namespace simd256;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    auto csc = _mm256_setr_ps(w[2], w[2], w[3], w[3], w[2], w[2], w[3], w[3]);
+
+    for (; c + 3 < mh / 2 - 1; c += 4)
+    {
+        f32x8 wk1, wk3;
+        twiddles_1st(w, c, csc, wk1, wk3);
+
+        bfly4f(s + 2 * c, a + 2 * c, m, wk1, wk3);
+        bfly4f(s + m - 2 * c - 6, a + m - 2 * c - 6, m, swap(reverse(wk1)), swap(reverse(wk3)));
+    }
+
+    _mm256_zeroupper();
+    cftf1st_scalar(n, s, a, w, 2 * c);
+}
+
+
+CPU_TARGET_AVX2
+void cftb1st_256(int n, f32 *a, f32 *w, int c)
+{
+    using namespace simd256;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    auto csc = _mm256_setr_ps(w[2], w[2], w[3], w[3], w[2], w[2], w[3], w[3]);
+
+    for (; c + 3 < mh / 2 - 1; c += 4)
+    {
+        f32x8 wk1, wk3;
+        twiddles_1st(w, c, csc, wk1, wk3);
+
+        bfly4b(a + 2 * c, m, wk1, wk3);
+        bfly4b(a + m - 2 * c - 6, m, swap(reverse(wk1)), swap(reverse(wk3)));
+    }
+
+    _mm256_zeroupper();
+    cftb1st_scalar(n, a, w, 2 * c);
+}
+
+
+CPU_TARGET_AVX2
+void cftmdl1_256(int n, f32 *a, f32 *w, int c)
+{
+    using namespace simd256;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    for (; c + 3 < mh / 2; c += 4)
+    {
+        f32x8 wk1, wk3;
+        twiddles(load(w + 4 * c), load(w + 4 * c + 8), wk1, wk3);
+
+        bfly4f(a + 2 * c, m, wk1, wk3);
+        bfly4f(a + m - 2 * c - 6, m, swap(reverse(wk1)), swap(reverse(wk3)));
+    }
+
+    _mm256_zeroupper();
+    cftmdl1_scalar(n, a, w, 2 * c);
+}
+
+
+CPU_TARGET_AVX2
+void cftmdl2_256(int n, f32 *a, f32 *w, int c)
+{
+    using namespace simd256;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    for (; c + 3 < mh / 2; c += 4)
+    {
+        int cr = mh - c - 3;
+
+        f32x8 wf1, wf3, wm1, wm3;
+        twiddles(load(w + 4 * c), load(w + 4 * c + 8), wf1, wf3);
+        twiddles(load(w + 4 * cr), load(w + 4 * cr + 8), wm1, wm3);
+
+        bfly4m2(a + 2 * c, m, wf1, wf3, swap(reverse(wm1)), swap(reverse(wm3)));
+        bfly4m2(a + 2 * cr, m, wm1, wm3, swap(reverse(wf1)), swap(reverse(wf3)));
+    }
+
+    _mm256_zeroupper();
+    cftmdl2_scalar(n, a, w, 2 * c);
+}
+
+
+namespace simd256
+{
+    // interleaved (0.5 - c[nc - k], c[k]) for k to k + 3
+    CPU_TARGET_AVX2 static inline f32x8 twiddles_rft(f32* c, int nc, int k)
+    {
+        auto ci = _mm_loadu_ps(c + k);
+        auto cr = _mm_loadu_ps(c + nc - k - 3);
+        cr = _mm_sub_ps(_mm_set1_ps(0.5f), _mm_shuffle_ps(cr, cr, _MM_SHUFFLE(0, 1, 2, 3)));
+
+        auto lo = _mm_unpacklo_ps(cr, ci);
+        auto hi = _mm_unpackhi_ps(cr, ci);
+
+        return _mm256_set_m128(hi, lo);
+    }
+}
+
+
+CPU_TARGET_AVX2
+void rftfsub_256(int n, f32 *a, int nc, f32 *c, int k)
+{
+    using namespace simd256;
+
+    int m = n >> 1;
+    if (2 * nc / m != 1)
+    {
+        rftfsub_scalar(n, a, nc, c, 2);
+        return;
+    }
+
+    for (; k + 3 < m / 2; k += 4)
+    {
+        auto wk = twiddles_rft(c, nc, k);
+
+        auto A = load(a + 2 * k);
+        auto K = reverse(load(a + n - 2 * k - 6));
+
+        auto y = cmul(sub(A, conj(K)), wk);
+
+        store(a + 2 * k, sub(A, y));
+        store(a + n - 2 * k - 6, reverse(add(K, conj(y))));
+    }
+
+    _mm256_zeroupper();
+    rftfsub_scalar(n, a, nc, c, 2 * k);
+}
+
+
+CPU_TARGET_AVX2
+void rftbsub_256(int n, f32 const *s, f32 *a, int nc, f32 *c, int k)
+{
+    using namespace simd256;
+
+    int m = n >> 1;
+    if (2 * nc / m != 1)
+    {
+        rftbsub_scalar(n, s, a, nc, c, 2);
+        return;
+    }
+
+    for (; k + 3 < m / 2; k += 4)
+    {
+        auto wk = twiddles_rft(c, nc, k);
+
+        auto A = load(s + 2 * k);
+        auto K = reverse(load(s + n - 2 * k - 6));
+
+        auto y = cmulc(sub(A, conj(K)), wk);
+
+        store(a + 2 * k, sub(A, y));
+        store(a + n - 2 * k - 6, reverse(add(K, conj(y))));
+    }
+
+    _mm256_zeroupper();
+    rftbsub_scalar(n, s, a, nc, c, 2 * k);
+}
+
+
+CPU_TARGET_AVX2
+void dctsub_256(int n, f32 *a, int nc, f32 *c, int j)
+{
+    using namespace simd256;
+
+    int m = n >> 1;
+    if (nc != n)
+    {
+        dctsub_scalar(n, a, nc, c, 1);
+        return;
+    }
+
+    for (; j + 7 < m; j += 8)
+    {
+        auto cj = load(c + j);
+        auto ck = flip(load(c + n - j - 7));
+        auto wkr = sub(cj, ck);
+        auto wki = add(cj, ck);
+
+        auto A = load(a + j);
+        auto K = flip(load(a + n - j - 7));
+
+        store(a + j, add(mul(wkr, A), mul(wki, K)));
+        store(a + n - j - 7, flip(sub(mul(wki, A), mul(wkr, K))));
+    }
+
+    _mm256_zeroupper();
+    dctsub_scalar(n, a, nc, c, j);
+}
+
+
+CPU_TARGET_AVX2
+void dstsub_256(int n, f32 *a, int nc, f32 *c, int j)
+{
+    using namespace simd256;
+
+    int m = n >> 1;
+    if (nc != n)
+    {
+        dstsub_scalar(n, a, nc, c, 1);
+        return;
+    }
+
+    for (; j + 7 < m; j += 8)
+    {
+        auto cj = load(c + j);
+        auto ck = flip(load(c + n - j - 7));
+        auto wkr = sub(cj, ck);
+        auto wki = add(cj, ck);
+
+        auto A = load(a + j);
+        auto K = flip(load(a + n - j - 7));
+
+        store(a + j, sub(mul(wki, K), mul(wkr, A)));
+        store(a + n - j - 7, flip(add(mul(wkr, K), mul(wki, A))));
+    }
+
+    _mm256_zeroupper();
+    dstsub_scalar(n, a, nc, c, j);
+}
+
+
+
+namespace simd256
+{
+    // 4 complex values, one row of a leaf codelet
+    using Row4 = f32x8;
+
+
+    CPU_TARGET_AVX2 static inline Row4 load4(f32 const* src) { return load(src); }
+
+    CPU_TARGET_AVX2 static inline void store4(f32* dst, Row4 v) { store(dst, v); }
+
+    CPU_TARGET_AVX2 static inline Row4 set4(f32 r0, f32 i0, f32 r1, f32 i1, f32 r2, f32 i2, f32 r3, f32 i3)
+    {
+        return _mm256_setr_ps(r0, i0, r1, i1, r2, i2, r3, i3);
+    }
+
+
+    // 0 + 2, 1 + 3, 0 - 2, 1 - 3
+    CPU_TARGET_AVX2 static inline Row4 halves(Row4 v)
+    {
+        auto sign = _mm256_setr_ps(0.0f, 0.0f, 0.0f, 0.0f, -0.0f, -0.0f, -0.0f, -0.0f);
+
+        return add(_mm256_permute2f128_ps(v, v, 0x01), _mm256_xor_ps(v, sign));
+    }
+
+    // 0 + 1, 0 - 1, 2 + 3, 2 - 3
+    CPU_TARGET_AVX2 static inline Row4 pairs(Row4 v)
+    {
+        auto sign = _mm256_setr_ps(0.0f, 0.0f, -0.0f, -0.0f, 0.0f, 0.0f, -0.0f, -0.0f);
+        auto d = _mm256_castps_pd(v);
+
+        auto lo = _mm256_castpd_ps(_mm256_permute_pd(d, 0x0));
+        auto hi = _mm256_castpd_ps(_mm256_permute_pd(d, 0xF));
+
+        return add(lo, _mm256_xor_ps(hi, sign));
+    }
+
+    // 0, 1, i 2, i 3
+    CPU_TARGET_AVX2 static inline Row4 mul_i23(Row4 v) { return _mm256_blend_ps(v, mul_i(v), 0xF0); }
+
+    // 0, 1, 2, i 3
+    CPU_TARGET_AVX2 static inline Row4 mul_i3(Row4 v) { return _mm256_blend_ps(v, mul_i(v), 0xC0); }
+
+    // the 4 point DFT every leaf ends with, in bit reversed order
+    CPU_TARGET_AVX2 static inline Row4 dft4(Row4 v) { return pairs(mul_i3(halves(v))); }
+}
+
+
+namespace simd256
+{
+    // cftf161/cftf162 as two radix-4 passes on rows of 4 complex values
+    // the first across the rows, the second a dft4 within each row
+    // the twiddles of both passes become one factor per value, 1 and +-i stay exact
+    class Leaf16
+    {
+    public:
+        Row4 f1;
+        Row4 f2;
+        Row4 f3;
+
+        // cftf162
+        Row4 p;
+        Row4 q;
+        Row4 pc;
+        Row4 s;
+        Row4 g2;
+        Row4 g3;
+    };
+
+
+    // cftf081/cftf082 with a row of 4 complex values per half
+    class Leaf8
+    {
+    public:
+        Row4 g1;
+        Row4 k1;
+        Row4 k2;
+    };
+
+
+    // w1 = &w[nw - 8] for cftf161, w2 = &w[nw - 32] for cftf162
+    CPU_TARGET_AVX2 static inline Leaf16 leaf16(f32 const* w1, f32 const* w2)
+    {
+        auto wn4r = w1[1];
+        auto wk1r = w1[2];
+        auto wk1i = w1[3];
+
+        Leaf16 t;
+
+        t.f1 = set4(1.0f, 0.0f, wn4r, wn4r, 0.0f, 1.0f, -wn4r, wn4r);
+        t.f2 = set4(1.0f, 0.0f, wk1r, wk1i, wn4r, wn4r, wk1i, wk1r);
+        t.f3 = set4(1.0f, 0.0f, wk1i, wk1r, -wn4r, wn4r, -wk1r, -wk1i);
+
+        wn4r = w2[1];
+        wk1r = w2[4];
+        wk1i = w2[5];
+        auto wk3r = w2[6];
+        auto wk3i = -w2[7];
+        auto wk2r = w2[8];
+        auto wk2i = w2[9];
+
+        t.p = set4(1.0f, 0.0f, wk1r, wk1i, wk2r, wk2i, wk3r, wk3i);
+        t.q = set4(wn4r, wn4r, wk3i, wk3r, wk2i, wk2r, wk1i, wk1r);
+        t.pc = set4(1.0f, 0.0f, wk3r, wk3i, wk2i, wk2r, wk1i, -wk1r);
+        t.s = set4(-wn4r, wn4r, -wk1r, wk1i, -wk2r, -wk2i, wk3i, wk3r);
+        t.g2 = set4(1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f);
+        t.g3 = set4(1.0f, 0.0f, wn4r, wn4r, 0.0f, 1.0f, wn4r, -wn4r);
+
+        return t;
+    }
+
+
+    // w1 = &w[nw - 8]
+    CPU_TARGET_AVX2 static inline Leaf8 leaf8(f32 const* w1)
+    {
+        auto wn4r = w1[1];
+        auto wk1r = w1[2];
+        auto wk1i = w1[3];
+
+        Leaf8 t;
+
+        t.g1 = set4(1.0f, 0.0f, wn4r, wn4r, 1.0f, 0.0f, -wn4r, wn4r);
+        t.k1 = set4(1.0f, 0.0f, wk1r, wk1i, wn4r, wn4r, wk1i, wk1r);
+        t.k2 = set4(1.0f, 0.0f, wk1i, wk1r, -wn4r, wn4r, -wk1r, -wk1i);
+
+        return t;
+    }
+
+
+    CPU_TARGET_AVX2 static inline void leaf161(f32* a, Leaf16 const& t)
+    {
+        auto R0 = load4(a);
+        auto R1 = load4(a + 8);
+        auto R2 = load4(a + 16);
+        auto R3 = load4(a + 24);
+
+        auto x0 = add(R0, R2);
+        auto x1 = sub(R0, R2);
+        auto x2 = add(R1, R3);
+        auto x3 = mul_i(sub(R1, R3));
+
+        store4(a, dft4(add(x0, x2)));
+        store4(a + 8, dft4(cmul(sub(x0, x2), t.f1)));
+        store4(a + 16, dft4(cmul(add(x1, x3), t.f2)));
+        store4(a + 24, dft4(cmul(sub(x1, x3), t.f3)));
+    }
+
+
+    CPU_TARGET_AVX2 static inline void leaf162(f32* a, Leaf16 const& t)
+    {
+        auto R0 = load4(a);
+        auto R1 = load4(a + 8);
+        auto iR2 = mul_i(load4(a + 16));
+        auto iR3 = mul_i(load4(a + 24));
+
+        auto u = cmul(add(R0, iR2), t.p);
+        auto v = cmul(add(R1, iR3), t.q);
+
+        store4(a, dft4(add(u, v)));
+        store4(a + 8, dft4(cmul(sub(u, v), t.f1)));
+
+        u = cmul(sub(R0, iR2), t.pc);
+        v = cmul(sub(R1, iR3), t.s);
+
+        store4(a + 16, dft4(cmul(add(u, v), t.g2)));
+        store4(a + 24, dft4(cmul(sub(u, v), t.g3)));
+    }
+
+
+    CPU_TARGET_AVX2 static inline void leaf081(f32* a, Leaf8 const& t)
+    {
+        auto R0 = load4(a);
+        auto R1 = load4(a + 8);
+
+        auto x = halves(add(R0, R1));
+        auto y = halves(mul_i23(sub(R0, R1)));
+
+        store4(a, pairs(mul_i3(x)));
+        store4(a + 8, pairs(cmul(y, t.g1)));
+    }
+
+
+    CPU_TARGET_AVX2 static inline void leaf082(f32* a, Leaf8 const& t)
+    {
+        auto R0 = load4(a);
+        auto iR1 = mul_i(load4(a + 8));
+
+        store4(a, dft4(cmul(add(R0, iR1), t.k1)));
+        store4(a + 8, dft4(cmul(sub(R0, iR1), t.k2)));
+    }
+}
+
+
+CPU_TARGET_AVX2
+void cftleaf_256(int n, int isplt, f32 *a, int nw, f32 *w)
+{
+    using namespace simd256;
+
+    if (n == 512)
+    {
+        auto t = leaf16(&w[nw - 8], &w[nw - 32]);
+
+        cftmdl1_256(128, a, &w[nw - 64], 1);
+        leaf161(a, t);
+        leaf162(&a[32], t);
+        leaf161(&a[64], t);
+        leaf161(&a[96], t);
+        cftmdl2_256(128, &a[128], &w[nw - 128], 1);
+        leaf161(&a[128], t);
+        leaf162(&a[160], t);
+        leaf161(&a[192], t);
+        leaf162(&a[224], t);
+        cftmdl1_256(128, &a[256], &w[nw - 64], 1);
+        leaf161(&a[256], t);
+        leaf162(&a[288], t);
+        leaf161(&a[320], t);
+        leaf161(&a[352], t);
+        if (isplt != 0)
+        {
+            cftmdl1_256(128, &a[384], &w[nw - 64], 1);
+            leaf161(&a[480], t);
+        }
+        else
+        {
+            cftmdl2_256(128, &a[384], &w[nw - 128], 1);
+            leaf162(&a[480], t);
+        }
+        leaf161(&a[384], t);
+        leaf162(&a[416], t);
+        leaf161(&a[448], t);
+    }
+    else
+    {
+        auto t = leaf8(&w[nw - 8]);
+
+        cftmdl1_256(64, a, &w[nw - 32], 1);
+        leaf081(a, t);
+        leaf082(&a[16], t);
+        leaf081(&a[32], t);
+        leaf081(&a[48], t);
+        cftmdl2_256(64, &a[64], &w[nw - 64], 1);
+        leaf081(&a[64], t);
+        leaf082(&a[80], t);
+        leaf081(&a[96], t);
+        leaf082(&a[112], t);
+        cftmdl1_256(64, &a[128], &w[nw - 32], 1);
+        leaf081(&a[128], t);
+        leaf082(&a[144], t);
+        leaf081(&a[160], t);
+        leaf081(&a[176], t);
+        if (isplt != 0)
+        {
+            cftmdl1_256(64, &a[192], &w[nw - 32], 1);
+            leaf081(&a[240], t);
+        }
+        else
+        {
+            cftmdl2_256(64, &a[192], &w[nw - 64], 1);
+            leaf082(&a[240], t);
+        }
+        leaf081(&a[192], t);
+        leaf082(&a[208], t);
+        leaf081(&a[224], t);
+    }
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX2
+void cftfx41_256(int n, f32 *a, int nw, f32 *w)
+{
+    using namespace simd256;
+
+    if (n == 128)
+    {
+        auto t = leaf16(&w[nw - 8], &w[nw - 32]);
+
+        leaf161(a, t);
+        leaf162(&a[32], t);
+        leaf161(&a[64], t);
+        leaf161(&a[96], t);
+    }
+    else
+    {
+        auto t = leaf8(&w[nw - 8]);
+
+        leaf081(a, t);
+        leaf082(&a[16], t);
+        leaf081(&a[32], t);
+        leaf081(&a[48], t);
+    }
+
+    _mm256_zeroupper();
+}
+
+
+namespace simd256
+{
+    // the n / 2 complex values as 4 rows of nr floats, 4 x 4 blocks of a row and the next 3
+    // complex (h, j, l) goes to (rev(l), rev(j), rev(h)), so block j is transposed into block rev(j)
+    // with its rows and columns in the order 0, 2, 1, 3
+    CPU_TARGET_AVX2 static inline void bitrv2_transpose(f32 const* src, int nr, f32x8 (&dst)[4])
+    {
+        auto m0 = _mm256_castps_pd(load(src));
+        auto m1 = _mm256_castps_pd(load(src + nr));
+        auto m2 = _mm256_castps_pd(load(src + 2 * nr));
+        auto m3 = _mm256_castps_pd(load(src + 3 * nr));
+
+        auto t0 = _mm256_castpd_ps(_mm256_unpacklo_pd(m0, m2));
+        auto t1 = _mm256_castpd_ps(_mm256_unpackhi_pd(m0, m2));
+        auto t2 = _mm256_castpd_ps(_mm256_unpacklo_pd(m1, m3));
+        auto t3 = _mm256_castpd_ps(_mm256_unpackhi_pd(m1, m3));
+
+        dst[0] = _mm256_permute2f128_ps(t0, t2, 0x20);
+        dst[1] = _mm256_permute2f128_ps(t0, t2, 0x31);
+        dst[2] = _mm256_permute2f128_ps(t1, t3, 0x20);
+        dst[3] = _mm256_permute2f128_ps(t1, t3, 0x31);
+    }
+
+
+    template <bool CONJ>
+    CPU_TARGET_AVX2 static inline void bitrv2_blocks(int n, f32 *a)
+    {
+        int nr = n >> 2;
+        int nb = n >> 5;
+
+        auto sign = CONJ ? sign_odd_256() : _mm256_setzero_ps();
+
+        for (int j = 0, r = 0; j < nb; j++)
+        {
+            if (j <= r)
+            {
+                f32x8 x[4];
+                f32x8 y[4];
+                bitrv2_transpose(a + 8 * j, nr, x);
+                bitrv2_transpose(a + 8 * r, nr, y);
+
+                for (int k = 0; k < 4; k++)
+                {
+                    store(a + 8 * r + k * nr, _mm256_xor_ps(x[k], sign));
+                    store(a + 8 * j + k * nr, _mm256_xor_ps(y[k], sign));
+                }
+            }
+
+            // r = rev(j + 1)
+            int bit = nb >> 1;
+            while (r & bit)
+            {
+                r ^= bit;
+                bit >>= 1;
+            }
+            r |= bit;
+        }
+    }
+}
+
+
+CPU_TARGET_AVX2
+void bitrv2_256(int n, int *ip, f32 *a)
+{
+    if (n > BITRV2_BLOCKS_MAX_SIZE)
+    {
+        bitrv2_scalar(n, ip, a);
+        return;
+    }
+
+    simd256::bitrv2_blocks<false>(n, a);
+
+    _mm256_zeroupper();
+}
+
+
+CPU_TARGET_AVX2
+void bitrv2conj_256(int n, int *ip, f32 *a)
+{
+    if (n > BITRV2_BLOCKS_MAX_SIZE)
+    {
+        bitrv2conj_scalar(n, ip, a);
+        return;
+    }
+
+    simd256::bitrv2_blocks<true>(n, a);
+
+    _mm256_zeroupper();
+}
+
+#endif // FFT_SIMD_256
+
+
+/* simd 512 */
+
+#ifdef FFT_SIMD_512
+
+namespace simd512
+{
+    using f32x16 = __m512;
+
+
+    CPU_TARGET_AVX512 static inline f32x16 load(f32 const* src) { return _mm512_loadu_ps(src); }
+
+    CPU_TARGET_AVX512 static inline void store(f32* dst, f32x16 v) { _mm512_storeu_ps(dst, v); }
+
+    CPU_TARGET_AVX512 static inline f32x16 add(f32x16 a, f32x16 b) { return _mm512_add_ps(a, b); }
+
+    CPU_TARGET_AVX512 static inline f32x16 sub(f32x16 a, f32x16 b) { return _mm512_sub_ps(a, b); }
+
+    CPU_TARGET_AVX512 static inline f32x16 mul(f32x16 a, f32x16 b) { return _mm512_mul_ps(a, b); }
+
+
+    // xor on the integer unit, _mm512_xor_ps needs AVX-512DQ
+    CPU_TARGET_AVX512 static inline f32x16 flip_sign(f32x16 v, __m512i sign)
+    {
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), sign));
+    }
+
+    CPU_TARGET_AVX512 static inline __m512i sign_even_512() { return _mm512_set1_epi64(0x80000000ll); }
+
+    CPU_TARGET_AVX512 static inline __m512i sign_odd_512() { return _mm512_set1_epi64(0x8000000000000000ll); }
+
+
+    CPU_TARGET_AVX512 static inline f32x16 swap(f32x16 v) { return _mm512_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1)); }
+
+    CPU_TARGET_AVX512 static inline f32x16 reverse(f32x16 v)
+    {
+        auto idx = _mm512_setr_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+
+        return _mm512_castpd_ps(_mm512_permutexvar_pd(idx, _mm512_castps_pd(v)));
+    }
+
+    CPU_TARGET_AVX512 static inline f32x16 flip(f32x16 v)
+    {
+        auto idx = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+        return _mm512_permutexvar_ps(idx, v);
+    }
+
+    CPU_TARGET_AVX512 static inline f32x16 conj(f32x16 v) { return flip_sign(v, sign_odd_512()); }
+
+    CPU_TARGET_AVX512 static inline f32x16 mul_i(f32x16 v) { return flip_sign(swap(v), sign_even_512()); }
+
+
+    CPU_TARGET_AVX512 static inline f32x16 cmul(f32x16 x, f32x16 w)
+    {
+        auto t = _mm512_mul_ps(swap(x), _mm512_movehdup_ps(w));
+
+        return _mm512_fmaddsub_ps(x, _mm512_moveldup_ps(w), t);
+    }
+
+
+    CPU_TARGET_AVX512 static inline f32x16 cmulc(f32x16 x, f32x16 w)
+    {
+        auto t = _mm512_mul_ps(swap(x), _mm512_movehdup_ps(w));
+
+        return _mm512_fmsubadd_ps(x, _mm512_moveldup_ps(w), t);
+    }
+
+
+    // wk1 and wk3 for 8 consecutive entries of an Ooura w table
+    CPU_TARGET_AVX512 static inline void twiddles(f32x16 w0, f32x16 w1, f32x16& wk1, f32x16& wk3)
+    {
+        auto d0 = _mm512_castps_pd(w0);
+        auto d1 = _mm512_castps_pd(w1);
+
+        auto even = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+        auto odd = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+
+        wk1 = _mm512_castpd_ps(_mm512_permutex2var_pd(d0, even, d1));
+        wk3 = _mm512_castpd_ps(_mm512_permutex2var_pd(d0, odd, d1));
+    }
+}
+
+
+namespace simd512
+{
+    CPU_TARGET_AVX512 static inline void bfly4f(f32 const* s, f32* a, int m, f32x16 wk1, f32x16 wk3)
+    {
+        auto A = load(s);
+        auto B = load(s + m);
+        auto C = load(s + 2 * m);
+        auto D = load(s + 3 * m);
+
+        auto x0 = add(A, C);
+        auto x1 = sub(A, C);
+        auto x2 = add(B, D);
+        auto x3 = mul_i(sub(B, D));
+
+        store(a, add(x0, x2));
+        store(a + m, sub(x0, x2));
+        store(a + 2 * m, cmul(add(x1, x3), wk1));
+        store(a + 3 * m, cmulc(sub(x1, x3), wk3));
+    }
+
+
+    CPU_TARGET_AVX512 static inline void bfly4f(f32* a, int m, f32x16 wk1, f32x16 wk3) { bfly4f(a, a, m, wk1, wk3); }
+
+
+    CPU_TARGET_AVX512 static inline void bfly4b(f32* a, int m, f32x16 wk1, f32x16 wk3)
+    {
+        auto A = load(a);
+        auto B = load(a + m);
+        auto C = load(a + 2 * m);
+        auto D = load(a + 3 * m);
+
+        auto x0 = conj(add(A, C));
+        auto x1 = conj(sub(A, C));
+        auto x2 = conj(add(B, D));
+        auto x3 = mul_i(conj(sub(B, D)));
+
+        store(a, add(x0, x2));
+        store(a + m, sub(x0, x2));
+        store(a + 2 * m, cmul(add(x1, x3), wk1));
+        store(a + 3 * m, cmulc(sub(x1, x3), wk3));
+    }
+
+
+    CPU_TARGET_AVX512 static inline void bfly4m2(f32* a, int m, f32x16 wa1, f32x16 wa3, f32x16 wb1, f32x16 wb3)
+    {
+        auto A = load(a);
+        auto B = load(a + m);
+        auto iC = mul_i(load(a + 2 * m));
+        auto iD = mul_i(load(a + 3 * m));
+
+        auto y0 = cmul(add(A, iC), wa1);
+        auto y2 = cmul(add(B, iD), wb1);
+
+        store(a, add(y0, y2));
+        store(a + m, sub(y0, y2));
+
+        y0 = cmulc(sub(A, iC), wa3);
+        y2 = cmulc(sub(B, iD), wb3);
+
+        store(a + 2 * m, add(y0, y2));
+        store(a + 3 * m, sub(y0, y2));
+    }
+
+
+    // cftf1st/cftb1st twiddles for odd complex c to c + 7
+    CPU_TARGET_AVX512 static inline void twiddles_1st(f32* w, int c, f32x16 csc, f32x16& wk1, f32x16& wk3)
+    {
+        auto w0 = load(w + 2 * (c - 1));
+        auto w1 = load(w + 2 * (c + 1));
+
+        if (c == 1)
+        {
+            auto one = _mm512_setr_ps(1.0f, 0.0f, 1.0f, 0.0f, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+            w0 = _mm512_mask_blend_ps(0x000F, w0, one);
+        }
+
+        auto wo = _mm512_castps_pd(_mm512_mul_ps(add(w0, w1), csc));
+        auto we = _mm512_castps_pd(w1);
+
+        wk1 = _mm512_castpd_ps(_mm512_unpacklo_pd(wo, we));
+        wk3 = _mm512_castpd_ps(_mm512_unpackhi_pd(wo, we));
+    }
+
+
+    // interleaved (0.5 - c[nc - k], c[k]) for k to k + 7
+    CPU_TARGET_AVX512 static inline f32x16 twiddles_rft(f32* c, int nc, int k)
+    {
+        auto ci = _mm256_loadu_ps(c + k);
+        auto cr = _mm256_loadu_ps(c + nc - k - 7);
+        cr = _mm256_permutevar8x32_ps(cr, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+        cr = _mm256_sub_ps(_mm256_set1_ps(0.5f), cr);
+
+        auto idx = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+
+        return _mm512_permutex2var_ps(_mm512_castps256_ps512(cr), idx, _mm512_castps256_ps512(ci));
+    }
+}
+
+
+CPU_TARGET_AVX512
+void cftf1st_512(int n, f32 const *s, f32 *a, f32 *w)
+{
+    using namespace simd512;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    auto csc = _mm512_broadcast_f32x4(_mm_setr_ps(w[2], w[2], w[3], w[3]));
+
+    int c = 1;
+    for (; c + 7 < mh / 2 - 1; c += 8)
+    {
+        f32x16 wk1, wk3;
+        twiddles_1st(w, c, csc, wk1, wk3);
+
+        bfly4f(s + 2 * c, a + 2 * c, m, wk1, wk3);
+        bfly4f(s + m - 2 * c - 14, a + m - 2 * c - 14, m, swap(reverse(wk1)), swap(reverse(wk3)));
+    }
+
+    cftf1st_256(n, s, a, w, c);
+}
+
+
+CPU_TARGET_AVX512
+void cftb1st_512(int n, f32 *a, f32 *w)
+{
+    using namespace simd512;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    auto csc = _mm512_broadcast_f32x4(_mm_setr_ps(w[2], w[2], w[3], w[3]));
+
+    int c = 1;
+    for (; c + 7 < mh / 2 - 1; c += 8)
+    {
+        f32x16 wk1, wk3;
+        twiddles_1st(w, c, csc, wk1, wk3);
+
+        bfly4b(a + 2 * c, m, wk1, wk3);
+        bfly4b(a + m - 2 * c - 14, m, swap(reverse(wk1)), swap(reverse(wk3)));
+    }
+
+    cftb1st_256(n, a, w, c);
+}
+
+
+CPU_TARGET_AVX512
+void cftmdl1_512(int n, f32 *a, f32 *w)
+{
+    using namespace simd512;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    int c = 1;
+    for (; c + 7 < mh / 2; c += 8)
+    {
+        f32x16 wk1, wk3;
+        twiddles(load(w + 4 * c), load(w + 4 * c + 16), wk1, wk3);
+
+        bfly4f(a + 2 * c, m, wk1, wk3);
+        bfly4f(a + m - 2 * c - 14, m, swap(reverse(wk1)), swap(reverse(wk3)));
+    }
+
+    cftmdl1_256(n, a, w, c);
+}
+
+
+CPU_TARGET_AVX512
+void cftmdl2_512(int n, f32 *a, f32 *w)
+{
+    using namespace simd512;
+
+    int mh = n >> 3;
+    int m = 2 * mh;
+
+    int c = 1;
+    for (; c + 7 < mh / 2; c += 8)
+    {
+        int cr = mh - c - 7;
+
+        f32x16 wf1, wf3, wm1, wm3;
+        twiddles(load(w + 4 * c), load(w + 4 * c + 16), wf1, wf3);
+        twiddles(load(w + 4 * cr), load(w + 4 * cr + 16), wm1, wm3);
+
+        bfly4m2(a + 2 * c, m, wf1, wf3, swap(reverse(wm1)), swap(reverse(wm3)));
+        bfly4m2(a + 2 * cr, m, wm1, wm3, swap(reverse(wf1)), swap(reverse(wf3)));
+    }
+
+    cftmdl2_256(n, a, w, c);
+}
+
+
+CPU_TARGET_AVX512
+void rftfsub_512(int n, f32 *a, int nc, f32 *c)
+{
+    using namespace simd512;
+
+    int m = n >> 1;
+    if (2 * nc / m != 1)
+    {
+        rftfsub_scalar(n, a, nc, c, 2);
+        return;
+    }
+
+    int k = 1;
+    for (; k + 7 < m / 2; k += 8)
+    {
+        auto wk = twiddles_rft(c, nc, k);
+
+        auto A = load(a + 2 * k);
+        auto K = reverse(load(a + n - 2 * k - 14));
+
+        auto y = cmul(sub(A, conj(K)), wk);
+
+        store(a + 2 * k, sub(A, y));
+        store(a + n - 2 * k - 14, reverse(add(K, conj(y))));
+    }
+
+    rftfsub_256(n, a, nc, c, k);
+}
+
+
+CPU_TARGET_AVX512
+void rftbsub_512(int n, f32 const *s, f32 *a, int nc, f32 *c)
+{
+    using namespace simd512;
+
+    int m = n >> 1;
+    if (2 * nc / m != 1)
+    {
+        rftbsub_scalar(n, s, a, nc, c, 2);
+        return;
+    }
+
+    int k = 1;
+    for (; k + 7 < m / 2; k += 8)
+    {
+        auto wk = twiddles_rft(c, nc, k);
+
+        auto A = load(s + 2 * k);
+        auto K = reverse(load(s + n - 2 * k - 14));
+
+        auto y = cmulc(sub(A, conj(K)), wk);
+
+        store(a + 2 * k, sub(A, y));
+        store(a + n - 2 * k - 14, reverse(add(K, conj(y))));
+    }
+
+    rftbsub_256(n, s, a, nc, c, k);
+}
+
+
+CPU_TARGET_AVX512
+void dctsub_512(int n, f32 *a, int nc, f32 *c)
+{
+    using namespace simd512;
+
+    int m = n >> 1;
+    if (nc != n)
+    {
+        dctsub_scalar(n, a, nc, c, 1);
+        return;
+    }
+
+    int j = 1;
+    for (; j + 15 < m; j += 16)
+    {
+        auto cj = load(c + j);
+        auto ck = flip(load(c + n - j - 15));
+        auto wkr = sub(cj, ck);
+        auto wki = add(cj, ck);
+
+        auto A = load(a + j);
+        auto K = flip(load(a + n - j - 15));
+
+        store(a + j, add(mul(wkr, A), mul(wki, K)));
+        store(a + n - j - 15, flip(sub(mul(wki, A), mul(wkr, K))));
+    }
+
+    dctsub_256(n, a, nc, c, j);
+}
+
+
+CPU_TARGET_AVX512
+void dstsub_512(int n, f32 *a, int nc, f32 *c)
+{
+    using namespace simd512;
+
+    int m = n >> 1;
+    if (nc != n)
+    {
+        dstsub_scalar(n, a, nc, c, 1);
+        return;
+    }
+
+    int j = 1;
+    for (; j + 15 < m; j += 16)
+    {
+        auto cj = load(c + j);
+        auto ck = flip(load(c + n - j - 15));
+        auto wkr = sub(cj, ck);
+        auto wki = add(cj, ck);
+
+        auto A = load(a + j);
+        auto K = flip(load(a + n - j - 15));
+
+        store(a + j, sub(mul(wki, K), mul(wkr, A)));
+        store(a + n - j - 15, flip(add(mul(wkr, K), mul(wki, A))));
+    }
+
+    dstsub_256(n, a, nc, c, j);
+}
+
+#endif // FFT_SIMD_512
+
+
+/* dispatch */
+
+// the scalar kernels until bind_stage_kernels runs, a transform from another static initializer is safe
+class StageKernels
+{
+public:
+    void (*cftf1st)(int n, f32 const *s, f32 *a, f32 *w) = [](int n, f32 const *s, f32 *a, f32 *w) { cftf1st_scalar(n, s, a, w, 2); };
+    void (*cftb1st)(int n, f32 *a, f32 *w) = [](int n, f32 *a, f32 *w) { cftb1st_scalar(n, a, w, 2); };
+    void (*cftmdl1)(int n, f32 *a, f32 *w) = [](int n, f32 *a, f32 *w) { cftmdl1_scalar(n, a, w, 2); };
+    void (*cftmdl2)(int n, f32 *a, f32 *w) = [](int n, f32 *a, f32 *w) { cftmdl2_scalar(n, a, w, 2); };
+    void (*rftfsub)(int n, f32 *a, int nc, f32 *c) = [](int n, f32 *a, int nc, f32 *c) { rftfsub_scalar(n, a, nc, c, 2); };
+    void (*rftbsub)(int n, f32 const *s, f32 *a, int nc, f32 *c) = [](int n, f32 const *s, f32 *a, int nc, f32 *c) { rftbsub_scalar(n, s, a, nc, c, 2); };
+    void (*dctsub)(int n, f32 *a, int nc, f32 *c) = [](int n, f32 *a, int nc, f32 *c) { dctsub_scalar(n, a, nc, c, 1); };
+    void (*dstsub)(int n, f32 *a, int nc, f32 *c) = [](int n, f32 *a, int nc, f32 *c) { dstsub_scalar(n, a, nc, c, 1); };
+    void (*cftleaf)(int n, int isplt, f32 *a, int nw, f32 *w) = cftleaf_scalar;
+    void (*cftfx41)(int n, f32 *a, int nw, f32 *w) = cftfx41_scalar;
+    void (*bitrv2)(int n, int *ip, f32 *a) = bitrv2_scalar;
+    void (*bitrv2conj)(int n, int *ip, f32 *a) = bitrv2conj_scalar;
+};
+
+
+static StageKernels stage_kernels;
+
+
+// returns the level actually bound
+static cpu::SIMD bind_stage_kernels(cpu::SIMD simd)
+{
+    auto& k = stage_kernels;
+
+#ifdef FFT_SIMD_512
+    if (simd >= cpu::SIMD::AVX512)
+    {
+        k.cftf1st = cftf1st_512;
+        k.cftb1st = cftb1st_512;
+        k.cftmdl1 = cftmdl1_512;
+        k.cftmdl2 = cftmdl2_512;
+        k.rftfsub = rftfsub_512;
+        k.rftbsub = rftbsub_512;
+        k.dctsub = dctsub_512;
+        k.dstsub = dstsub_512;
+        k.cftleaf = cftleaf_256;
+        k.cftfx41 = cftfx41_256;
+        k.bitrv2 = bitrv2_256;
+        k.bitrv2conj = bitrv2conj_256;
+
+        return cpu::SIMD::AVX512;
+    }
+#endif
+
+#ifdef FFT_SIMD_256
+    if (simd >= cpu::SIMD::AVX2)
+    {
+        k.cftf1st = [](int n, f32 const *s, f32 *a, f32 *w) { cftf1st_256(n, s, a, w, 1); };
+        k.cftb1st = [](int n, f32 *a, f32 *w) { cftb1st_256(n, a, w, 1); };
+        k.cftmdl1 = [](int n, f32 *a, f32 *w) { cftmdl1_256(n, a, w, 1); };
+        k.cftmdl2 = [](int n, f32 *a, f32 *w) { cftmdl2_256(n, a, w, 1); };
+        k.rftfsub = [](int n, f32 *a, int nc, f32 *c) { rftfsub_256(n, a, nc, c, 1); };
+        k.rftbsub = [](int n, f32 const *s, f32 *a, int nc, f32 *c) { rftbsub_256(n, s, a, nc, c, 1); };
+        k.dctsub = [](int n, f32 *a, int nc, f32 *c) { dctsub_256(n, a, nc, c, 1); };
+        k.dstsub = [](int n, f32 *a, int nc, f32 *c) { dstsub_256(n, a, nc, c, 1); };
+        k.cftleaf = cftleaf_256;
+        k.cftfx41 = cftfx41_256;
+        k.bitrv2 = bitrv2_256;
+        k.bitrv2conj = bitrv2conj_256;
+
+        return cpu::SIMD::AVX2;
+    }
+#endif
+
+#ifdef FFT_SIMD_128
+    if (simd >= cpu::SIMD::SSE2)
+    {
+        k.cftf1st = [](int n, f32 const *s, f32 *a, f32 *w) { cftf1st_128(n, s, a, w, 1); };
+        k.cftb1st = [](int n, f32 *a, f32 *w) { cftb1st_128(n, a, w, 1); };
+        k.cftmdl1 = [](int n, f32 *a, f32 *w) { cftmdl1_128(n, a, w, 1); };
+        k.cftmdl2 = [](int n, f32 *a, f32 *w) { cftmdl2_128(n, a, w, 1); };
+        k.rftfsub = [](int n, f32 *a, int nc, f32 *c) { rftfsub_128(n, a, nc, c, 1); };
+        k.rftbsub = [](int n, f32 const *s, f32 *a, int nc, f32 *c) { rftbsub_128(n, s, a, nc, c, 1); };
+        k.dctsub = [](int n, f32 *a, int nc, f32 *c) { dctsub_128(n, a, nc, c, 1); };
+        k.dstsub = [](int n, f32 *a, int nc, f32 *c) { dstsub_128(n, a, nc, c, 1); };
+        k.cftleaf = cftleaf_128;
+        k.cftfx41 = cftfx41_128;
+        k.bitrv2 = bitrv2_128;
+        k.bitrv2conj = bitrv2conj_128;
+
+        return cpu::SIMD::SSE2;
+    }
+#endif
+
+    k = StageKernels{};
+
+    return cpu::SIMD::None;
+}
+
+
+void cftf1st(int n, f32 *a, f32 *w) { stage_kernels.cftf1st(n, a, a, w); }
+
+void cftf1st_src(int n, f32 const *s, f32 *a, f32 *w) { stage_kernels.cftf1st(n, s, a, w); }
+
+void cftb1st(int n, f32 *a, f32 *w) { stage_kernels.cftb1st(n, a, w); }
+
+void cftmdl1(int n, f32 *a, f32 *w) { stage_kernels.cftmdl1(n, a, w); }
+
+void cftmdl2(int n, f32 *a, f32 *w) { stage_kernels.cftmdl2(n, a, w); }
+
+void rftfsub(int n, f32 *a, int nc, f32 *c) { stage_kernels.rftfsub(n, a, nc, c); }
+
+void rftbsub(int n, f32 *a, int nc, f32 *c) { stage_kernels.rftbsub(n, a, a, nc, c); }
+
+void rftbsub_src(int n, f32 const *s, f32 *a, int nc, f32 *c) { stage_kernels.rftbsub(n, s, a, nc, c); }
+
+void dctsub(int n, f32 *a, int nc, f32 *c) { stage_kernels.dctsub(n, a, nc, c); }
+
+void dstsub(int n, f32 *a, int nc, f32 *c) { stage_kernels.dstsub(n, a, nc, c); }
+
+void cftleaf(int n, int isplt, f32 *a, int nw, f32 *w) { stage_kernels.cftleaf(n, isplt, a, nw, w); }
+
+void cftfx41(int n, f32 *a, int nw, f32 *w) { stage_kernels.cftfx41(n, a, nw, w); }
+
+void bitrv2(int n, int *ip, f32 *a) { stage_kernels.bitrv2(n, ip, a); }
+
+void bitrv2conj(int n, int *ip, f32 *a) { stage_kernels.bitrv2conj(n, ip, a); }
@@ -0,0 +1,177 @@
+#pragma once
+
+// each test_*.cpp is a program of its own, main_o.cpp style: the library is included as a unity build
+
+#include "../fft.cpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+
+namespace test
+{
+    static u32 n_failed = 0;
+
+
+    // max_error limits
+    // fftsg_f32.cpp builds the Ooura tables with the numeric.hpp sin/cos approximations (FFT_UTIL_NUMERIC),
+    // the static tables match them. The other engines and the codelets use exact tables
+    static constexpr f64 OOURA_ERROR = 2e-2;
+    static constexpr f64 EXACT_ERROR = 1e-5;
+
+
+    inline void check(bool ok, cstr expr, cstr file, int line)
+    {
+        if (!ok)
+        {
+            std::printf("  FAIL %s:%d %s\n", file, line, expr);
+            n_failed++;
+        }
+    }
+
+
+    // 0 when every check passed, for main
+    inline int result(cstr name)
+    {
+        std::printf("%s: %s\n", name, n_failed ? "FAILED" : "ok");
+
+        return n_failed ? 1 : 0;
+    }
+
+
+    inline std::vector<f32> random_frame(u32 size, u32 seed)
+    {
+        std::vector<f32> frame(size);
+
+        u32 s = seed * 2654435761u + 1;
+        for (auto& v : frame)
+        {
+            s = s * 1664525u + 1013904223u;
+            v = (f32)((s >> 8) * (2.0 / 16777216.0) - 1.0);
+        }
+
+        return frame;
+    }
+
+
+    // direct DFT in f64, in the rdft_forward layout:
+    // [0] = Re X[0], [1] = Re X[n / 2] (odd n: Re X[(n - 1) / 2]), [2k] = Re X[k], [2k + 1] = -Im X[k]
+    inline std::vector<f64> reference_dft(std::vector<f32> const& x)
+    {
+        auto n = (u32)x.size();
+
+        std::vector<f64> out(n, 0.0);
+
+        for (u32 k = 0; k <= n / 2; k++)
+        {
+            f64 re = 0.0;
+            f64 im = 0.0;
+
+            for (u32 j = 0; j < n; j++)
+            {
+                auto t = 2.0 * M_PI * (f64)(((u64)j * k) % n) / n;
+                re += x[j] * std::cos(t);
+                im += x[j] * std::sin(t);
+            }
+
+            if (k == 0)
+            {
+                out[0] = re;
+            }
+            else if (2 * k == n)
+            {
+                out[1] = re;
+            }
+            else if (n % 2 && k == n / 2)
+            {
+                out[n - 1] = re;
+                out[1] = im;
+            }
+            else
+            {
+                out[2 * k] = re;
+                out[2 * k + 1] = im;
+            }
+        }
+
+        return out;
+    }
+
+
+    // magnitudes of bins 1 to fft_bin_size(n) from a reference_dft
+    inline std::vector<f64> reference_bins(std::vector<f64> const& dft)
+    {
+        auto n = (u32)dft.size();
+        auto n_bins = (n - 1) / 2;
+
+        std::vector<f64> bins(n_bins);
+
+        for (u32 k = 1; k <= n_bins; k++)
+        {
+            auto last_odd = n % 2 && k == n_bins;
+
+            auto re = last_odd ? dft[n - 1] : dft[2 * k];
+            auto im = last_odd ? dft[1] : dft[2 * k + 1];
+
+            bins[k - 1] = std::sqrt(re * re + im * im);
+        }
+
+        return bins;
+    }
+
+
+    // largest difference relative to the largest reference value
+    template <typename T>
+    inline f64 max_error(f32 const* values, std::vector<T> const& expected)
+    {
+        f64 err = 0.0;
+        f64 scale = 1e-30;
+
+        for (u32 i = 0; i < expected.size(); i++)
+        {
+            err = std::fmax(err, std::fabs(values[i] - (f64)expected[i]));
+            scale = std::fmax(scale, std::fabs((f64)expected[i]));
+        }
+
+        return err / scale;
+    }
+
+
+    // func(level) at every simd level the cpu supports, lowest first, then back to the best one
+    template <class FUNC>
+    inline void for_each_simd(FUNC const& func)
+    {
+        auto best = cpu::simd_level();
+
+        for (int i = 0; i <= (int)best; i++)
+        {
+            auto level = (cpu::SIMD)i;
+            if (fft::set_simd(level) == level)
+            {
+                func(level);
+            }
+        }
+
+        fft::set_simd(best);
+    }
+
+
+    inline bool write_text(cstr path, cstr text)
+    {
+        auto file = std::fopen(path, "w");
+        if (!file)
+        {
+            return false;
+        }
+
+        std::fputs(text, file);
+        std::fclose(file);
+
+        return true;
+    }
+}
+
+
+#define TEST_CHECK(expr) test::check((expr), #expr, __FILE__, __LINE__)
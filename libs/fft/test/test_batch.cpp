@@ -0,0 +1,66 @@
+#include "test.hpp"
+
+// BatchPlan, each channel against a direct DFT of its frame, at every simd level
+
+using namespace fft;
+
+
+static void check_batch(u32 size, u32 n_channels)
+{
+    std::vector<std::vector<f32>> x(n_channels);
+    std::vector<std::vector<f64>> ref(n_channels);
+    std::vector<f32*> frames(n_channels);
+
+    for (u32 c = 0; c < n_channels; c++)
+    {
+        x[c] = test::random_frame(size, 100 * size + c);
+        ref[c] = test::reference_dft(x[c]);
+        frames[c] = x[c].data();
+    }
+
+    std::vector<f32> buffer(size * n_channels);
+    interleave(frames.data(), buffer.data(), size, n_channels);
+
+    BatchPlan plan;
+    TEST_CHECK(create_batch_plan(plan, size, n_channels));
+
+    std::vector<f32> bins(n_channels * plan.n_bins);
+    forward(plan, buffer.data(), bins.data());
+
+    std::vector<std::vector<f32>> out(n_channels, std::vector<f32>(size));
+    for (u32 c = 0; c < n_channels; c++)
+    {
+        frames[c] = out[c].data();
+    }
+
+    deinterleave(buffer.data(), frames.data(), size, n_channels);
+
+    for (u32 c = 0; c < n_channels; c++)
+    {
+        TEST_CHECK(test::max_error(out[c].data(), ref[c]) < test::EXACT_ERROR);
+        TEST_CHECK(test::max_error(bins.data() + c * plan.n_bins, test::reference_bins(ref[c])) < test::EXACT_ERROR);
+    }
+}
+
+
+int main()
+{
+    test::for_each_simd([&](cpu::SIMD)
+    {
+        for (auto size : { 4u, 16u, 64u, 1024u })
+        {
+            for (auto n_channels : { 4u, 8u, 16u })
+            {
+                check_batch(size, n_channels);
+            }
+        }
+    });
+
+    BatchPlan plan;
+    TEST_CHECK(!create_batch_plan(plan, 1024, 2));
+    TEST_CHECK(!create_batch_plan(plan, 1000, 4));
+
+    destroy_plans();
+
+    return test::result("test_batch");
+}
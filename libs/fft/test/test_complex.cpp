@@ -0,0 +1,88 @@
+#include "test.hpp"
+
+// ComplexPlan against a direct complex DFT, and inverse(forward(x)) = size x, at every simd level
+
+using namespace fft;
+
+
+// interleaved re, im in and out, sign -1 forward, +1 inverse
+static std::vector<f64> reference_cdft(std::vector<f32> const& z, int sign)
+{
+    auto n = (u32)z.size() / 2;
+
+    std::vector<f64> out(2 * n);
+
+    for (u32 k = 0; k < n; k++)
+    {
+        f64 re = 0.0;
+        f64 im = 0.0;
+
+        for (u32 j = 0; j < n; j++)
+        {
+            auto t = sign * 2.0 * M_PI * (f64)(((u64)j * k) % n) / n;
+            auto c = std::cos(t);
+            auto s = std::sin(t);
+
+            re += z[2 * j] * c - z[2 * j + 1] * s;
+            im += z[2 * j] * s + z[2 * j + 1] * c;
+        }
+
+        out[2 * k] = re;
+        out[2 * k + 1] = im;
+    }
+
+    return out;
+}
+
+
+static void check_complex(u32 size, Engine engine)
+{
+    auto z = test::random_frame(2 * size, size);
+    auto limit = engine == Engine::Ooura ? test::OOURA_ERROR : test::EXACT_ERROR;
+
+    ComplexPlan plan;
+    TEST_CHECK(create_complex_plan(plan, size, engine));
+
+    std::vector<f32> a(z);
+    forward(plan, a.data());
+
+    TEST_CHECK(test::max_error(a.data(), reference_cdft(z, -1)) < limit);
+
+    std::vector<f32> b(2 * size);
+    inverse_to(plan, z.data(), b.data());
+
+    TEST_CHECK(test::max_error(b.data(), reference_cdft(z, 1)) < limit);
+
+    std::vector<f32> c(2 * size);
+    forward_to(plan, z.data(), c.data());
+    inverse(plan, c.data());
+
+    for (auto& v : c)
+    {
+        v /= size;
+    }
+
+    TEST_CHECK(test::max_error(c.data(), z) < limit);
+
+    destroy_complex_plan(plan);
+}
+
+
+int main()
+{
+    test::for_each_simd([&](cpu::SIMD)
+    {
+        for (auto size : { 2u, 4u, 8u, 32u, 256u, 2048u })
+        {
+            check_complex(size, Engine::Ooura);
+            check_complex(size, Engine::Stockham);
+        }
+    });
+
+    ComplexPlan plan;
+    TEST_CHECK(!create_complex_plan(plan, 1000));
+
+    destroy_plans();
+
+    return test::result("test_complex");
+}
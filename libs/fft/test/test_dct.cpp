@@ -0,0 +1,158 @@
+#include "test.hpp"
+
+// the DCT/DST transforms against their direct sums, and each through its listed inverse
+
+using namespace fft;
+
+
+using transform_fn = void (*)(DctPlan const& plan, f32* buffer);
+
+// f(j, k) is the sum term of out[k]: out[k] = sum_j in[j] f(j, k), j and k over [begin, end)
+template <class FUNC>
+static std::vector<f64> direct(std::vector<f32> const& x, u32 begin, u32 end, FUNC const& f)
+{
+    std::vector<f64> out(x.size(), 0.0);
+
+    for (u32 k = begin; k < end; k++)
+    {
+        for (u32 j = begin; j < end; j++)
+        {
+            out[k] += x[j] * f((f64)j, (f64)k);
+        }
+    }
+
+    return out;
+}
+
+
+static void scale(std::vector<f32>& x, f32 s)
+{
+    for (auto& v : x)
+    {
+        v *= s;
+    }
+}
+
+
+static void check_dct(u32 n)
+{
+    auto const limit = test::OOURA_ERROR;
+    auto const pi_n = M_PI / n;
+
+    DctPlan plan;
+    TEST_CHECK(create_dct_plan(plan, n));
+
+    auto x = test::random_frame(n, n);
+
+    // DCT-II and DCT-III
+    {
+        auto ref2 = direct(x, 0, n, [&](f64 j, f64 k){ return std::cos(pi_n * (j + 0.5) * k); });
+        auto ref3 = direct(x, 0, n, [&](f64 j, f64 k){ return std::cos(pi_n * j * (k + 0.5)); });
+
+        auto a = x;
+        dct2(plan, a.data());
+        TEST_CHECK(test::max_error(a.data(), ref2) < limit);
+
+        a[0] *= 0.5f;
+        dct3(plan, a.data());
+        scale(a, 2.0f / n);
+        TEST_CHECK(test::max_error(a.data(), x) < limit);
+
+        auto b = x;
+        dct3(plan, b.data());
+        TEST_CHECK(test::max_error(b.data(), ref3) < limit);
+    }
+
+    // DST-II and DST-III, S[n] lives in buffer[0]
+    {
+        std::vector<f64> ref2(n, 0.0);
+        for (u32 k = 1; k <= n; k++)
+        {
+            for (u32 j = 0; j < n; j++)
+            {
+                ref2[k % n] += x[j] * std::sin(pi_n * (j + 0.5) * k);
+            }
+        }
+
+        std::vector<f64> ref3(n, 0.0);
+        for (u32 k = 0; k < n; k++)
+        {
+            for (u32 j = 1; j <= n; j++)
+            {
+                ref3[k] += x[j % n] * std::sin(pi_n * j * (k + 0.5));
+            }
+        }
+
+        auto a = x;
+        dst2(plan, a.data());
+        TEST_CHECK(test::max_error(a.data(), ref2) < limit);
+
+        a[0] *= 0.5f;
+        dst3(plan, a.data());
+        scale(a, 2.0f / n);
+        TEST_CHECK(test::max_error(a.data(), x) < limit);
+
+        auto b = x;
+        dst3(plan, b.data());
+        TEST_CHECK(test::max_error(b.data(), ref3) < limit);
+    }
+
+    // DCT-I of n + 1 points
+    {
+        auto y = test::random_frame(n + 1, n + 1);
+        auto ref = direct(y, 0, n + 1, [&](f64 j, f64 k){ return std::cos(pi_n * j * k); });
+
+        auto a = y;
+        dct1(plan, a.data());
+        TEST_CHECK(test::max_error(a.data(), ref) < limit);
+
+        // the ends halved, twice
+        a = y;
+        for (u32 r = 0; r < 2; r++)
+        {
+            a[0] *= 0.5f;
+            a[n] *= 0.5f;
+            dct1(plan, a.data());
+        }
+
+        scale(a, 2.0f / n);
+        TEST_CHECK(test::max_error(a.data(), y) < limit);
+    }
+
+    // DST-I, buffer[0] is not an input
+    {
+        auto y = x;
+        y[0] = 0.0f;
+
+        auto ref = direct(y, 1, n, [&](f64 j, f64 k){ return std::sin(pi_n * j * k); });
+
+        auto a = x;
+        dst1(plan, a.data());
+        TEST_CHECK(test::max_error(a.data(), ref) < limit);
+
+        dst1(plan, a.data());
+        scale(a, 2.0f / n);
+        TEST_CHECK(test::max_error(a.data(), y) < limit);
+    }
+
+    destroy_dct_plan(plan);
+}
+
+
+int main()
+{
+    test::for_each_simd([&](cpu::SIMD)
+    {
+        for (auto n : { 4u, 8u, 16u, 64u, 512u, 2048u })
+        {
+            check_dct(n);
+        }
+    });
+
+    DctPlan plan;
+    TEST_CHECK(!create_dct_plan(plan, 100));
+
+    destroy_plans();
+
+    return test::result("test_dct");
+}
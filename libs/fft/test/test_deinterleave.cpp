@@ -0,0 +1,73 @@
+#include "test.hpp"
+
+// deinterleave for 1 to 32 channels, the SIMD paths and their scalar tails, and interleave back
+
+using namespace fft;
+
+
+static constexpr u32 MAX_CHANNELS = 32;
+
+// past the end of each frame, must not be written
+static constexpr f32 GUARD = -12345.0f;
+
+
+static void check_channels(u32 n_channels, u32 size)
+{
+    // sample i of channel c, exact in f32
+    std::vector<f32> buffer(size * n_channels);
+    for (u32 i = 0; i < size; i++)
+    {
+        for (u32 c = 0; c < n_channels; c++)
+        {
+            buffer[i * n_channels + c] = (f32)(i * 64 + c);
+        }
+    }
+
+    std::vector<f32> memory(MAX_CHANNELS * (size + 1), GUARD);
+
+    f32* frames[MAX_CHANNELS];
+    for (u32 c = 0; c < n_channels; c++)
+    {
+        frames[c] = memory.data() + c * (size + 1);
+    }
+
+    deinterleave(buffer.data(), frames, size, n_channels);
+
+    u32 n_wrong = 0;
+    for (u32 c = 0; c < n_channels; c++)
+    {
+        for (u32 i = 0; i < size; i++)
+        {
+            n_wrong += frames[c][i] != (f32)(i * 64 + c);
+        }
+
+        n_wrong += frames[c][size] != GUARD;
+    }
+
+    TEST_CHECK(n_wrong == 0);
+
+    std::vector<f32> back(size * n_channels);
+    interleave(frames, back.data(), size, n_channels);
+
+    TEST_CHECK(back == buffer);
+}
+
+
+int main()
+{
+    // below, at and past the 8 sample SIMD blocks
+    u32 const sizes[] = { 0, 1, 7, 8, 9, 16, 31, 64, 257, 1024 };
+
+    test::for_each_simd([&](cpu::SIMD)
+    {
+        for (u32 n_channels = 1; n_channels <= MAX_CHANNELS; n_channels++)
+        {
+            for (auto size : sizes)
+            {
+                check_channels(n_channels, size);
+            }
+        }
+    });
+
+    return test::result("test_deinterleave");
+}
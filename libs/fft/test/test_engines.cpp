@@ -0,0 +1,167 @@
+#include "test.hpp"
+
+// every engine against a direct DFT, and forward then inverse back to the input, at every simd level
+
+using namespace fft;
+
+
+static constexpr Engine ENGINES[] = { Engine::Ooura, Engine::Stockham, Engine::FourStep, Engine::Fft4g, Engine::Fft8g };
+
+// FourStep runs its own passes from FOURSTEP_MIN_SIZE, the direct DFT is too slow there
+static constexpr u32 REFERENCE_MAX_SIZE = 4096;
+
+
+static f64 error_limit(Engine engine, u32 size)
+{
+    if (engine == Engine::Ooura && size > internal::CODELET_MAX_SIZE)
+    {
+        return test::OOURA_ERROR;
+    }
+
+    // rounding grows with the number of passes
+    return size < FOURSTEP_MIN_SIZE ? test::EXACT_ERROR : 10 * test::EXACT_ERROR;
+}
+
+
+static void check_engine(Engine engine, u32 size, std::vector<f64> const& ref)
+{
+    auto x = test::random_frame(size, size);
+    auto limit = error_limit(engine, size);
+
+    Plan plan;
+    TEST_CHECK(create_plan(plan, size, engine));
+    TEST_CHECK(plan.engine == engine || (engine == Engine::FourStep && size < FOURSTEP_MIN_SIZE));
+
+    // the tables are shared
+    Plan other;
+    TEST_CHECK(create_plan(other, size, engine));
+    TEST_CHECK(other.ip == plan.ip && other.w == plan.w && other.tw == plan.tw);
+
+    // in place with bins
+    std::vector<f32> a(x);
+    std::vector<f32> bins(plan.n_bins);
+    forward(plan, a.data(), bins.data());
+
+    TEST_CHECK(test::max_error(a.data(), ref) < limit);
+    TEST_CHECK(test::max_error(bins.data(), test::reference_bins(ref)) < limit);
+
+    // out of place, src untouched
+    std::vector<f32> src(x);
+    std::vector<f32> b(size);
+    forward_to(plan, src.data(), b.data());
+
+    TEST_CHECK(test::max_error(b.data(), ref) < limit);
+    TEST_CHECK(test::max_error(src.data(), x) == 0.0);
+
+    // both inverses, scaled by 2 / size
+    std::vector<f32> c(size);
+    inverse_to(plan, b.data(), c.data());
+    inverse(plan, a.data());
+
+    for (u32 i = 0; i < size; i++)
+    {
+        a[i] *= 2.0f / size;
+        c[i] *= 2.0f / size;
+    }
+
+    TEST_CHECK(test::max_error(a.data(), x) < limit);
+    TEST_CHECK(test::max_error(c.data(), x) < limit);
+
+    destroy_plan(other);
+    destroy_plan(plan);
+}
+
+
+// the exact engines agree on the reference, taken once with the scalar kernels
+static std::vector<f64> reference(u32 size)
+{
+    auto x = test::random_frame(size, size);
+
+    if (size <= REFERENCE_MAX_SIZE)
+    {
+        return test::reference_dft(x);
+    }
+
+    auto level = simd();
+    set_simd(cpu::SIMD::None);
+
+    Plan plan;
+    TEST_CHECK(create_plan(plan, size, Engine::Stockham));
+
+    std::vector<f32> out(size);
+    forward_to(plan, x.data(), out.data());
+
+    destroy_plan(plan);
+    set_simd(level);
+
+    return std::vector<f64>(out.begin(), out.end());
+}
+
+
+// the Ooura tables are approximate, but every simd level runs the same arithmetic on them:
+// the vector stages, leaves and bit reversal agree with the scalar ones to rounding
+static void check_ooura_simd(u32 size)
+{
+    auto x = test::random_frame(size, size);
+
+    Plan plan;
+    TEST_CHECK(create_plan(plan, size, Engine::Ooura));
+
+    auto level = simd();
+    set_simd(cpu::SIMD::None);
+
+    std::vector<f32> fwd(x);
+    forward(plan, fwd.data());
+
+    std::vector<f32> inv(fwd);
+    inverse(plan, inv.data());
+
+    set_simd(level);
+
+    std::vector<f64> fwd_ref(fwd.begin(), fwd.end());
+    std::vector<f64> inv_ref(inv.begin(), inv.end());
+
+    test::for_each_simd([&](cpu::SIMD)
+    {
+        std::vector<f32> a(x);
+        forward(plan, a.data());
+        TEST_CHECK(test::max_error(a.data(), fwd_ref) < test::EXACT_ERROR);
+
+        inverse(plan, a.data());
+        TEST_CHECK(test::max_error(a.data(), inv_ref) < test::EXACT_ERROR);
+    });
+
+    destroy_plan(plan);
+}
+
+
+int main()
+{
+    u32 const sizes[] = { 4, 8, 16, 32, 64, 128, 256, 1024, 4096, FOURSTEP_MIN_SIZE, 2 * FOURSTEP_MIN_SIZE };
+
+    for (auto size : sizes)
+    {
+        auto ref = reference(size);
+
+        test::for_each_simd([&](cpu::SIMD)
+        {
+            for (auto engine : ENGINES)
+            {
+                check_engine(engine, size, ref);
+            }
+        });
+    }
+
+    for (u32 size = 64; size <= 4 * FOURSTEP_MIN_SIZE; size *= 4)
+    {
+        check_ooura_simd(size);
+    }
+
+    Plan plan;
+    TEST_CHECK(!create_plan(plan, PLAN_MIN_SIZE / 2));
+    TEST_CHECK(!create_plan(plan, PLAN_MAX_SIZE * 2));
+
+    destroy_plans();
+
+    return test::result("test_engines");
+}
@@ -0,0 +1,115 @@
+#include "test.hpp"
+
+#include <cstring>
+
+// FFT<B2EXP> and FrameFFT in memory that was never constructed, as wave.cpp and mic.cpp allocate them
+
+using namespace fft;
+
+
+template <class F>
+static F* create_garbage()
+{
+    auto p = alloc_aligned(sizeof(F));
+    std::memset(p, 0xAB, sizeof(F));
+
+    return (F*)p;
+}
+
+
+template <class F>
+static void check_transforms(F& f, u32 seed, f64 limit)
+{
+    auto x = test::random_frame(F::size, seed);
+
+    // the direct DFT is too slow for the large sizes, an exact Stockham plan stands in
+    std::vector<f64> ref;
+    if (F::size <= 4096)
+    {
+        ref = test::reference_dft(x);
+    }
+    else
+    {
+        Plan plan;
+        TEST_CHECK(create_plan(plan, F::size, Engine::Stockham));
+
+        std::vector<f32> out(F::size);
+        forward_to(plan, x.data(), out.data());
+        ref.assign(out.begin(), out.end());
+
+        destroy_plan(plan);
+    }
+
+    std::vector<f32> bins(F::n_bins);
+    f.forward(x.data(), bins.data());
+
+    TEST_CHECK(test::max_error(bins.data(), test::reference_bins(ref)) < limit);
+
+    std::vector<f32> back(F::size);
+    f.inverse(back.data());
+
+    for (auto& v : back)
+    {
+        v *= 2.0f / F::size;
+    }
+
+    TEST_CHECK(test::max_error(back.data(), x) < limit);
+}
+
+
+template <u32 EXP>
+static void fft_garbage()
+{
+    using F = FFT<EXP>;
+
+    auto f = create_garbage<F>();
+
+    TEST_CHECK(f->init());
+    TEST_CHECK(f->plan.engine == Engine::Ooura);
+    TEST_CHECK(f->plan.mixed == 0);
+    TEST_CHECK(f->plan.work == 0);
+
+    auto limit = F::size <= internal::CODELET_MAX_SIZE ? test::EXACT_ERROR : test::OOURA_ERROR;
+
+    check_transforms(*f, EXP, limit);
+
+    free_aligned(f);
+}
+
+
+template <u32 SIZE>
+static void frame_fft_garbage()
+{
+    using F = FrameFFT<SIZE>;
+
+    auto f = create_garbage<F>();
+
+    TEST_CHECK(f->init());
+
+    auto limit = num::is_power_of_2(SIZE) ? test::OOURA_ERROR : test::EXACT_ERROR;
+
+    check_transforms(*f, SIZE, limit);
+
+    f->destroy();
+    free_aligned(f);
+}
+
+
+int main()
+{
+    fft_garbage<2>();
+    fft_garbage<6>();
+    fft_garbage<7>();
+    fft_garbage<8>();
+    fft_garbage<10>();
+    fft_garbage<16>();
+    fft_garbage<17>();
+
+    frame_fft_garbage<441>();
+    frame_fft_garbage<480>();
+    frame_fft_garbage<1024>();
+
+    destroy_plans();
+
+    return test::result("test_fft");
+}
@@ -0,0 +1,121 @@
+#include "test.hpp"
+
+// the int16 block floating point path against a direct DFT of the same samples
+
+using namespace fft;
+
+
+// the documented SNR is 52 dB at 4096 points for a tone, a few dB of margin
+static constexpr f64 MIN_SNR_DB = 45.0;
+
+
+static std::vector<i16> tone(u32 size, f64 amplitude)
+{
+    std::vector<i16> s(size);
+
+    for (u32 i = 0; i < size; i++)
+    {
+        s[i] = (i16)std::lround(amplitude * std::sin(2.0 * M_PI * 13.3 * i / size));
+    }
+
+    return s;
+}
+
+
+static std::vector<i16> noise(u32 size, f64 amplitude)
+{
+    auto x = test::random_frame(size, size);
+
+    std::vector<i16> s(size);
+    for (u32 i = 0; i < size; i++)
+    {
+        s[i] = (i16)std::lround(amplitude * x[i]);
+    }
+
+    return s;
+}
+
+
+// reference energy over error energy
+static f64 snr_db(f32 const* values, std::vector<f64> const& expected)
+{
+    f64 signal = 0.0;
+    f64 error = 0.0;
+
+    for (u32 i = 0; i < expected.size(); i++)
+    {
+        auto d = values[i] - expected[i];
+        signal += expected[i] * expected[i];
+        error += d * d;
+    }
+
+    return 10.0 * std::log10(signal / num::max(error, 1e-30));
+}
+
+
+static void check_fixed(FixedPlan const& plan, std::vector<i16> const& s)
+{
+    auto size = plan.size;
+
+    std::vector<f32> x(size);
+    for (u32 i = 0; i < size; i++)
+    {
+        x[i] = s[i] / 32768.0f;
+    }
+
+    auto ref = test::reference_dft(x);
+
+    std::vector<f32> dst(size);
+    std::vector<f32> bins(plan.n_bins);
+    forward_to(plan, s.data(), dst.data(), bins.data());
+
+    TEST_CHECK(snr_db(dst.data(), ref) > MIN_SNR_DB);
+    TEST_CHECK(snr_db(bins.data(), test::reference_bins(ref)) > MIN_SNR_DB);
+
+    // without bins, the same transform
+    std::vector<f32> dst2(size);
+    forward_to(plan, s.data(), dst2.data());
+
+    TEST_CHECK(test::max_error(dst2.data(), std::vector<f32>(dst)) == 0.0);
+}
+
+
+int main()
+{
+    u32 const sizes[] = { 4, 16, 64, 256, 1024, 4096 };
+
+    test::for_each_simd([&](cpu::SIMD)
+    {
+        for (auto size : sizes)
+        {
+            FixedPlan plan;
+            TEST_CHECK(create_fixed_plan(plan, size));
+
+            check_fixed(plan, tone(size, 30000.0));
+            check_fixed(plan, noise(size, 32767.0));
+
+            // quiet input keeps its precision
+            check_fixed(plan, tone(size, 200.0));
+            check_fixed(plan, noise(size, 50.0));
+
+            // full scale square wave, the passes must not overflow
+            std::vector<i16> square(size);
+            for (u32 i = 0; i < size; i++)
+            {
+                square[i] = (i / 2) % 2 ? -32768 : 32767;
+            }
+
+            check_fixed(plan, square);
+
+            destroy_fixed_plan(plan);
+        }
+    });
+
+    FixedPlan plan;
+    TEST_CHECK(!create_fixed_plan(plan, 1000));
+    TEST_CHECK(!create_fixed_plan(plan, 2));
+
+    destroy_plans();
+
+    return test::result("test_fixed");
+}
@@ -0,0 +1,81 @@
+#include "test.hpp"
+
+// MixedRadix plans: radix 4, 3, 5, 7 and 2 passes, Bluestein for the other factors, odd sizes
+
+using namespace fft;
+
+
+static void check_size(u32 size)
+{
+    auto x = test::random_frame(size, size);
+    auto ref = test::reference_dft(x);
+
+    test::for_each_simd([&](cpu::SIMD)
+    {
+        // whatever engine is asked for
+        for (auto engine : { Engine::Ooura, Engine::Stockham })
+        {
+            Plan plan;
+            TEST_CHECK(create_plan(plan, size, engine));
+            TEST_CHECK(plan.engine == Engine::MixedRadix);
+            TEST_CHECK(plan.n_bins == (size - 1) / 2);
+
+            std::vector<f32> a(x);
+            std::vector<f32> bins(plan.n_bins);
+            forward(plan, a.data(), bins.data());
+
+            TEST_CHECK(test::max_error(a.data(), ref) < test::EXACT_ERROR);
+            TEST_CHECK(test::max_error(bins.data(), test::reference_bins(ref)) < test::EXACT_ERROR);
+
+            std::vector<f32> src(x);
+            std::vector<f32> b(size);
+            forward_to(plan, src.data(), b.data());
+
+            TEST_CHECK(test::max_error(b.data(), ref) < test::EXACT_ERROR);
+            TEST_CHECK(test::max_error(src.data(), x) == 0.0);
+
+            std::vector<f32> c(size);
+            inverse_to(plan, b.data(), c.data());
+            inverse(plan, a.data());
+
+            for (u32 i = 0; i < size; i++)
+            {
+                a[i] *= 2.0f / size;
+                c[i] *= 2.0f / size;
+            }
+
+            TEST_CHECK(test::max_error(a.data(), x) < test::EXACT_ERROR);
+            TEST_CHECK(test::max_error(c.data(), x) < test::EXACT_ERROR);
+
+            destroy_plan(plan);
+        }
+    });
+}
+
+
+int main()
+{
+    // radix passes only
+    u32 const radix[] = { 5, 6, 7, 12, 15, 21, 35, 105, 441, 480, 1000, 2100, 3 * 1024 };
+
+    // a Bluestein factor, prime or times radix passes
+    u32 const bluestein[] = { 11, 13, 97, 2 * 97, 11 * 13, 1009, 3 * 1009 };
+
+    for (auto size : radix)
+    {
+        check_size(size);
+    }
+
+    for (auto size : bluestein)
+    {
+        check_size(size);
+    }
+
+    // no plan below PLAN_MIN_SIZE
+    Plan plan;
+    TEST_CHECK(!create_plan(plan, 3));
+
+    destroy_plans();
+
+    return test::result("test_mixed");
+}
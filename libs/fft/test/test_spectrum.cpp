@@ -0,0 +1,415 @@
+#include "test.hpp"
+
+// the spectrum modes and the full spectrum layouts against the same values in f64 from a direct DFT, at every simd level
+
+using namespace fft;
+
+
+static constexpr Spectrum MODES[] = { Spectrum::Magnitude, Spectrum::Power, Spectrum::Decibel, Spectrum::Phase, Spectrum::Normalized };
+
+// num::log is a cubic, about 0.002 dB off
+static constexpr f64 DB_ERROR = 0.01;
+
+// num::atan_approx, radians
+static constexpr f64 PHASE_ERROR = 1e-5;
+
+
+// Re and Im of X[k], k from 0 to size / 2
+static void reference_bin(std::vector<f64> const& dft, u32 k, f64& re, f64& im)
+{
+    auto size = (u32)dft.size();
+
+    if (k == 0 || 2 * k == size)
+    {
+        re = dft[k ? 1 : 0];
+        im = 0.0;
+        return;
+    }
+
+    re = dft[2 * k];
+    im = -dft[2 * k + 1];
+}
+
+
+// bin k in the selected mode
+static f64 reference_value(SpectrumOptions const& options, u32 size, u32 k, f64 re, f64 im)
+{
+    auto gain = (f64)options.window_gain;
+    auto pw = re * re + im * im;
+
+    // DC and Nyquist are not folded into the single sided spectrum
+    auto sides = k == 0 || 2 * k == size ? 1.0 : 2.0;
+
+    switch (options.mode)
+    {
+    case Spectrum::Power: return pw / (gain * gain);
+    case Spectrum::Decibel: return std::fmax(10.0 * std::log10(pw) - 20.0 * std::log10(gain), options.db_floor);
+    case Spectrum::Phase: return std::atan2(im, re);
+    case Spectrum::Normalized: return sides * std::sqrt(pw) / (size * gain);
+    default: return std::sqrt(pw) / gain;
+    }
+}
+
+
+// bins first to last in the selected mode
+static std::vector<f64> reference_spectrum(std::vector<f64> const& dft, SpectrumOptions const& options, u32 first, u32 last)
+{
+    auto size = (u32)dft.size();
+
+    std::vector<f64> bins;
+
+    for (u32 k = first; k <= last; k++)
+    {
+        f64 re = 0.0;
+        f64 im = 0.0;
+        reference_bin(dft, k, re, im);
+
+        bins.push_back(reference_value(options, size, k, re, im));
+    }
+
+    return bins;
+}
+
+
+// absolute, phase wraps at +-pi
+static f64 abs_error(f32 const* values, std::vector<f64> const& expected, bool phase)
+{
+    f64 err = 0.0;
+
+    for (u32 i = 0; i < expected.size(); i++)
+    {
+        auto d = std::fabs(values[i] - expected[i]);
+        if (phase)
+        {
+            d = std::fmin(d, 2.0 * M_PI - d);
+        }
+
+        err = std::fmax(err, d);
+    }
+
+    return err;
+}
+
+
+static bool near(f32 const* values, std::vector<f64> const& expected, Spectrum mode)
+{
+    switch (mode)
+    {
+    case Spectrum::Decibel: return abs_error(values, expected, false) < DB_ERROR;
+    case Spectrum::Phase: return abs_error(values, expected, true) < PHASE_ERROR;
+    default: return test::max_error(values, expected) < test::EXACT_ERROR;
+    }
+}
+
+
+// a transformed frame with silent and quiet bins for the dB floor, rounded to f32
+static std::vector<f64> test_dft(u32 size)
+{
+    auto dft = test::reference_dft(test::random_frame(size, size));
+
+    auto n_bins = internal::fft_bin_size(size);
+    for (u32 k = 1; k <= n_bins; k += 3)
+    {
+        dft[2 * k] = 0.0;
+        dft[2 * k + 1] = k % 2 ? 0.0 : 1e-5;
+    }
+
+    std::vector<f32> rounded(dft.begin(), dft.end());
+
+    return std::vector<f64>(rounded.begin(), rounded.end());
+}
+
+
+static void check_spectrum(std::vector<f64> const& dft, SpectrumOptions const& options)
+{
+    auto size = (u32)dft.size();
+
+    // the kernels alone, from an exact transform
+    std::vector<f32> buffer(dft.begin(), dft.end());
+
+    Plan plan;
+    TEST_CHECK(create_plan(plan, size));
+
+    std::vector<f32> bins(plan.n_bins);
+    spectrum(plan, buffer.data(), bins.data(), options);
+
+    TEST_CHECK(near(bins.data(), reference_spectrum(dft, options, 1, plan.n_bins), options.mode));
+
+    // fused into forward, the same kernel
+    auto x = test::random_frame(size, size);
+
+    std::vector<f32> a(x);
+    std::vector<f32> fused(plan.n_bins);
+    forward(plan, a.data(), fused.data(), options);
+
+    spectrum(plan, a.data(), bins.data(), options);
+
+    TEST_CHECK(test::max_error(fused.data(), std::vector<f32>(bins)) == 0.0);
+
+    // DC to Nyquist
+    std::vector<f32> full(plan.n_full_bins);
+    full_spectrum(plan, buffer.data(), full.data(), options);
+
+    TEST_CHECK(near(full.data(), reference_spectrum(dft, options, 0, size / 2), options.mode));
+
+    std::vector<f32> b(x);
+    std::vector<f32> fused_full(plan.n_full_bins);
+    forward_full(plan, b.data(), fused_full.data(), options);
+    full_spectrum(plan, a.data(), full.data(), options);
+
+    TEST_CHECK(test::max_error(fused_full.data(), std::vector<f32>(full)) == 0.0);
+}
+
+
+static void check_layouts(std::vector<f64> const& dft)
+{
+    auto size = (u32)dft.size();
+
+    std::vector<f32> buffer(dft.begin(), dft.end());
+
+    Plan plan;
+    TEST_CHECK(create_plan(plan, size));
+    TEST_CHECK(plan.n_full_bins == size / 2 + 1);
+
+    std::vector<f64> ref_re(plan.n_full_bins);
+    std::vector<f64> ref_im(plan.n_full_bins);
+    std::vector<f64> ref_complex(2 * plan.n_full_bins);
+
+    for (u32 k = 0; k < plan.n_full_bins; k++)
+    {
+        reference_bin(dft, k, ref_re[k], ref_im[k]);
+        ref_complex[2 * k] = ref_re[k];
+        ref_complex[2 * k + 1] = ref_im[k];
+    }
+
+    // only moved and negated, exact
+    std::vector<f32> bins(2 * plan.n_full_bins);
+    complex_bins(plan, buffer.data(), bins.data());
+
+    TEST_CHECK(test::max_error(bins.data(), ref_complex) == 0.0);
+
+    std::vector<f32> re(plan.n_full_bins);
+    std::vector<f32> im(plan.n_full_bins);
+    split_bins(plan, buffer.data(), re.data(), im.data());
+
+    TEST_CHECK(test::max_error(re.data(), ref_re) == 0.0);
+    TEST_CHECK(test::max_error(im.data(), ref_im) == 0.0);
+
+    // fused into forward, the same as from the transformed buffer
+    auto x = test::random_frame(size, size);
+
+    std::vector<f32> a(x);
+    forward(plan, a.data());
+
+    std::vector<f32> b(x);
+    std::vector<f32> fused(2 * plan.n_full_bins);
+    forward_complex(plan, b.data(), fused.data());
+    complex_bins(plan, a.data(), bins.data());
+
+    TEST_CHECK(test::max_error(fused.data(), std::vector<f32>(bins)) == 0.0);
+
+    b = x;
+    std::vector<f32> fused_re(plan.n_full_bins);
+    std::vector<f32> fused_im(plan.n_full_bins);
+    forward_split(plan, b.data(), fused_re.data(), fused_im.data());
+    split_bins(plan, a.data(), re.data(), im.data());
+
+    TEST_CHECK(test::max_error(fused_re.data(), std::vector<f32>(re)) == 0.0);
+    TEST_CHECK(test::max_error(fused_im.data(), std::vector<f32>(im)) == 0.0);
+}
+
+
+static void check_floor(u32 size)
+{
+    SpectrumOptions options;
+    options.mode = Spectrum::Decibel;
+    options.db_floor = -40.0f;
+
+    Plan plan;
+    TEST_CHECK(create_plan(plan, size));
+
+    // bin k at -10 k dB
+    std::vector<f32> buffer(size, 0.0f);
+    for (u32 k = 1; k <= plan.n_bins; k++)
+    {
+        buffer[2 * k] = (f32)std::pow(10.0, -0.5 * k);
+    }
+
+    std::vector<f32> bins(plan.n_bins);
+    spectrum(plan, buffer.data(), bins.data(), options);
+
+    u32 n_wrong = 0;
+    for (u32 k = 1; k <= plan.n_bins; k++)
+    {
+        auto expected = k < 4 ? -10.0 * k : -40.0;
+        n_wrong += std::fabs(bins[k - 1] - expected) > DB_ERROR;
+    }
+
+    TEST_CHECK(n_wrong == 0);
+}
+
+
+// Re < 0 and Im exactly +-0 sit on the +-pi cut: the sign of the zero decides, like atan2, at every simd level
+static void check_phase_cut(u32 size)
+{
+    SpectrumOptions options;
+    options.mode = Spectrum::Phase;
+
+    Plan plan;
+    TEST_CHECK(create_plan(plan, size));
+
+    // packed -Im, +0 and -0 in turn
+    std::vector<f32> buffer(size, 0.0f);
+    for (u32 k = 0; k < size / 2; k++)
+    {
+        buffer[2 * k] = -1.0f - (f32)k;
+        buffer[2 * k + 1] = k % 2 ? -0.0f : 0.0f;
+    }
+
+    u32 n_wrong = 0;
+
+    std::vector<f32> bins(plan.n_bins);
+    spectrum(plan, buffer.data(), bins.data(), options);
+
+    for (u32 k = 1; k <= plan.n_bins; k++)
+    {
+        n_wrong += bins[k - 1] != (f32)std::atan2(-(f64)buffer[2 * k + 1], -1.0);
+    }
+
+    TEST_CHECK(n_wrong == 0);
+
+    auto level = simd();
+    set_simd(cpu::SIMD::None);
+
+    std::vector<f32> ref(plan.n_bins);
+    spectrum(plan, buffer.data(), ref.data(), options);
+
+    set_simd(level);
+
+    TEST_CHECK(std::memcmp(bins.data(), ref.data(), plan.n_bins * sizeof(f32)) == 0);
+}
+
+
+// the layouts negate Im by its sign bit: a silent frame gives -0, the same zeros at every simd level
+static void check_split_zero(u32 size)
+{
+    Plan plan;
+    TEST_CHECK(create_plan(plan, size));
+
+    std::vector<f32> buffer(size, 0.0f);
+    std::vector<f32> re(plan.n_full_bins);
+    std::vector<f32> im(plan.n_full_bins);
+    split_bins(plan, buffer.data(), re.data(), im.data());
+
+    u32 n_wrong = 0;
+    for (u32 k = 1; k < size / 2; k++)
+    {
+        n_wrong += !std::signbit(im[k]);
+    }
+
+    TEST_CHECK(n_wrong == 0);
+
+    auto level = simd();
+    set_simd(cpu::SIMD::None);
+
+    std::vector<f32> ref_re(plan.n_full_bins);
+    std::vector<f32> ref_im(plan.n_full_bins);
+    split_bins(plan, buffer.data(), ref_re.data(), ref_im.data());
+
+    set_simd(level);
+
+    TEST_CHECK(std::memcmp(re.data(), ref_re.data(), plan.n_full_bins * sizeof(f32)) == 0);
+    TEST_CHECK(std::memcmp(im.data(), ref_im.data(), plan.n_full_bins * sizeof(f32)) == 0);
+}
+
+
+static void check_window_gain()
+{
+    u32 const size = 1024;
+
+    std::vector<f32> hann(size);
+    for (u32 i = 0; i < size; i++)
+    {
+        hann[i] = (f32)(0.5 - 0.5 * std::cos(2.0 * M_PI * i / size));
+    }
+
+    TEST_CHECK(std::fabs(window_gain(hann.data(), size) - 0.5f) < 1e-6f);
+
+    std::vector<f32> ones(size, 1.0f);
+    TEST_CHECK(window_gain(ones.data(), size) == 1.0f);
+}
+
+
+// forward_parallel with options, the same bins as forward
+static void check_parallel()
+{
+    auto size = PARALLEL_MIN_SIZE * 2;
+    auto x = test::random_frame(size, 3);
+
+    Plan plan;
+    TEST_CHECK(create_plan(plan, size));
+
+    for (auto mode : MODES)
+    {
+        SpectrumOptions options;
+        options.mode = mode;
+
+        std::vector<f32> a(x);
+        std::vector<f32> b(x);
+        std::vector<f32> bins_a(plan.n_bins);
+        std::vector<f32> bins_b(plan.n_bins);
+
+        forward(plan, a.data(), bins_a.data(), options);
+        forward_parallel(plan, b.data(), bins_b.data(), options);
+
+        TEST_CHECK(near(bins_b.data(), std::vector<f64>(bins_a.begin(), bins_a.end()), mode));
+    }
+
+    stop_threads();
+}
+
+
+int main()
+{
+    // the simd kernels with and without a scalar tail
+    u32 const sizes[] = { 4, 8, 16, 32, 64, 128, 1024, 4096 };
+    u32 const n_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+    std::vector<f64> dfts[n_sizes];
+    for (u32 i = 0; i < n_sizes; i++)
+    {
+        dfts[i] = test_dft(sizes[i]);
+    }
+
+    test::for_each_simd([&](cpu::SIMD)
+    {
+        for (u32 i = 0; i < n_sizes; i++)
+        {
+            auto size = sizes[i];
+
+            for (auto mode : MODES)
+            {
+                for (auto gain : { 1.0f, 0.5f, 0.42f })
+                {
+                    SpectrumOptions options;
+                    options.mode = mode;
+                    options.window_gain = gain;
+
+                    check_spectrum(dfts[i], options);
+                }
+            }
+
+            check_layouts(dfts[i]);
+            check_floor(size);
+            check_phase_cut(size);
+            check_split_zero(size);
+        }
+    });
+
+    check_window_gain();
+    check_parallel();
+
+    destroy_plans();
+
+    return test::result("test_spectrum");
+}
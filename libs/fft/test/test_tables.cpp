@@ -0,0 +1,211 @@
+#include "test.hpp"
+
+#include <cstring>
+
+// save_tables / load_tables, files are written to the working directory
+
+using namespace fft;
+
+
+static std::vector<f32> transform(u32 size)
+{
+    auto x = test::random_frame(size, size);
+
+    Plan plan;
+    TEST_CHECK(create_plan(plan, size));
+
+    forward(plan, x.data());
+    destroy_plan(plan);
+
+    return x;
+}
+
+
+static bool in_map(void const* p)
+{
+    auto begin = (u8 const*)internal::tables_map;
+    auto end = begin + internal::tables_map_bytes;
+
+    return begin && (u8 const*)p >= begin && (u8 const*)p < end;
+}
+
+
+static std::vector<u8> read_file(cstr path)
+{
+    std::vector<u8> data;
+
+    auto file = std::fopen(path, "rb");
+    if (!file)
+    {
+        return data;
+    }
+
+    u8 buffer[4096];
+    for (auto n = std::fread(buffer, 1, sizeof(buffer), file); n; n = std::fread(buffer, 1, sizeof(buffer), file))
+    {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+
+    std::fclose(file);
+
+    return data;
+}
+
+
+static bool write_file(cstr path, std::vector<u8> const& data)
+{
+    auto file = std::fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    auto ok = data.empty() || std::fwrite(data.data(), 1, data.size(), file) == data.size();
+
+    return std::fclose(file) == 0 && ok;
+}
+
+
+static void tables_round_trip()
+{
+    u32 const sizes[] = { 1024, 4096, 1u << 16 };
+
+    std::vector<f32> expected[3];
+    for (u32 i = 0; i < 3; i++)
+    {
+        expected[i] = transform(sizes[i]);
+    }
+
+    TEST_CHECK(save_tables("tables.bin"));
+
+    destroy_plans();
+
+    TEST_CHECK(load_tables("tables.bin"));
+
+    // one file at a time
+    TEST_CHECK(!load_tables("tables.bin"));
+
+    for (u32 i = 0; i < 3; i++)
+    {
+        Plan plan;
+        TEST_CHECK(create_plan(plan, sizes[i]));
+        TEST_CHECK(in_map(plan.ip) && in_map(plan.w));
+        destroy_plan(plan);
+
+        auto x = transform(sizes[i]);
+        TEST_CHECK(std::memcmp(x.data(), expected[i].data(), x.size() * sizeof(f32)) == 0);
+    }
+
+    // sizes not in the file are created as before
+    Plan plan;
+    TEST_CHECK(create_plan(plan, 2048));
+    TEST_CHECK(!in_map(plan.w));
+    destroy_plan(plan);
+
+    destroy_plans();
+    TEST_CHECK(internal::tables_map == 0);
+}
+
+
+static void tables_malformed()
+{
+    using namespace internal;
+
+    transform(1024);
+    transform(4096);
+    TEST_CHECK(save_tables("tables.bin"));
+    destroy_plans();
+
+    auto good = read_file("tables.bin");
+    TEST_CHECK(good.size() > sizeof(TableFileHeader) + 2 * sizeof(TableFileEntry));
+
+    auto const rejected = [](std::vector<u8> const& data)
+    {
+        auto ok = write_file("tables_bad.bin", data) && !load_tables("tables_bad.bin") && tables_map == 0;
+        destroy_plans();
+
+        return ok;
+    };
+
+    // changes the header
+    auto const header = [&](auto const& edit)
+    {
+        auto data = good;
+
+        TableFileHeader h;
+        std::memcpy(&h, data.data(), sizeof(h));
+        edit(h);
+        std::memcpy(data.data(), &h, sizeof(h));
+
+        return data;
+    };
+
+    // changes the first entry and signs the file again, only the entry checks can reject it
+    auto const entry = [&](auto const& edit)
+    {
+        auto data = good;
+        auto p = data.data() + sizeof(TableFileHeader);
+
+        TableFileEntry e;
+        std::memcpy(&e, p, sizeof(e));
+        edit(e);
+        std::memcpy(p, &e, sizeof(e));
+
+        TableFileHeader h;
+        std::memcpy(&h, data.data(), sizeof(h));
+        h.checksum = table_file_checksum(p, data.size() - sizeof(h));
+        std::memcpy(data.data(), &h, sizeof(h));
+
+        return data;
+    };
+
+    TEST_CHECK(!load_tables("missing_tables.bin"));
+    TEST_CHECK(rejected({}));
+
+    TEST_CHECK(rejected(std::vector<u8>(good.begin(), good.begin() + sizeof(TableFileHeader) - 1)));
+    TEST_CHECK(rejected(std::vector<u8>(good.begin(), good.begin() + good.size() / 2)));
+    TEST_CHECK(rejected(std::vector<u8>(good.begin(), good.end() - 1)));
+
+    auto longer = good;
+    longer.push_back(0);
+    TEST_CHECK(rejected(longer));
+
+    TEST_CHECK(rejected(header([](auto& h){ h.magic[0] = 'F'; })));
+    TEST_CHECK(rejected(header([](auto& h){ h.version = TABLE_FILE_VERSION + 1; })));
+    TEST_CHECK(rejected(header([](auto& h){ h.byte_order = 0x04030201; })));
+    TEST_CHECK(rejected(header([](auto& h){ h.file_bytes++; })));
+    TEST_CHECK(rejected(header([](auto& h){ h.n_entries = PLAN_MAX_EXP + 2; })));
+    TEST_CHECK(rejected(header([](auto& h){ h.n_entries = 0xFFFFFFFF; })));
+    TEST_CHECK(rejected(header([](auto& h){ h.checksum ^= 1; })));
+
+    // a flipped table value
+    auto flipped = good;
+    flipped.back() ^= 0x10;
+    TEST_CHECK(rejected(flipped));
+
+    TEST_CHECK(rejected(entry([](auto& e){ e.size = 1000; })));
+    TEST_CHECK(rejected(entry([](auto& e){ e.size = 2; })));
+    TEST_CHECK(rejected(entry([](auto& e){ e.size = PLAN_MAX_SIZE * 2; })));
+    TEST_CHECK(rejected(entry([](auto& e){ e.ip_offset += 4; })));
+    TEST_CHECK(rejected(entry([](auto& e){ e.w_offset = 0; })));
+    TEST_CHECK(rejected(entry([&](auto& e){ e.w_offset = table_file_align(good.size()); })));
+
+    // offsets that wrap around when the table size is added
+    TEST_CHECK(rejected(entry([](auto& e){ e.ip_offset = 0ull - TABLE_FILE_ALIGN; })));
+    TEST_CHECK(rejected(entry([](auto& e){ e.w_offset = 0ull - TABLE_FILE_ALIGN; })));
+
+    // the signing above is right
+    TEST_CHECK(!rejected(entry([](auto&){})));
+    destroy_plans();
+}
+
+
+int main()
+{
+    tables_round_trip();
+    tables_malformed();
+
+    destroy_plans();
+
+    return test::result("test_tables");
+}
@@ -0,0 +1,111 @@
+#include "test.hpp"
+
+#include <atomic>
+
+// the pool fft.cpp uses for the parallel transforms
+
+
+static void pool_for_each()
+{
+    ThreadPool pool;
+    TEST_CHECK(pool.start(4));
+    TEST_CHECK(pool.is_running());
+    TEST_CHECK(pool.n_threads() == 4);
+
+    std::atomic<u32> hits[64] = {};
+
+    for (u32 r = 0; r < 100; r++)
+    {
+        pool.for_each(64, [&](u32 id){ hits[id]++; });
+    }
+
+    u32 n_wrong = 0;
+    for (auto& h : hits)
+    {
+        n_wrong += h != 100;
+    }
+
+    TEST_CHECK(n_wrong == 0);
+
+    pool.stop();
+    TEST_CHECK(!pool.is_running());
+    TEST_CHECK(pool.n_threads() == 1);
+}
+
+
+// a task calling for_each again runs the inner tasks inline instead of waiting on itself
+static void pool_nested()
+{
+    ThreadPool pool;
+    TEST_CHECK(pool.start(4));
+
+    std::atomic<u32> n_inner = 0;
+
+    for (u32 r = 0; r < 20; r++)
+    {
+        pool.for_each(8, [&](u32)
+        {
+            pool.for_each(16, [&](u32){ n_inner++; });
+        });
+    }
+
+    TEST_CHECK(n_inner == 20 * 8 * 16);
+
+    // and the pool still runs in parallel afterwards
+    std::atomic<u32> n_outer = 0;
+    pool.for_each(32, [&](u32){ n_outer++; });
+
+    TEST_CHECK(n_outer == 32);
+}
+
+
+// the parallel transforms match the serial ones with the pool in use
+// the engines without a parallel path run the same serial transform, bit for bit
+static void pool_transforms()
+{
+    using namespace fft;
+
+    start_threads(4);
+
+    auto size = PARALLEL_MIN_SIZE * 2;
+    auto x = test::random_frame(size, 5);
+
+    for (auto engine : { Engine::Ooura, Engine::FourStep, Engine::Stockham, Engine::Fft4g, Engine::Fft8g })
+    {
+        auto serial = engine != Engine::Ooura && engine != Engine::FourStep;
+
+        Plan plan;
+        TEST_CHECK(create_plan(plan, size, engine));
+
+        std::vector<f32> a(x);
+        std::vector<f32> b(x);
+
+        forward(plan, a.data());
+        forward_parallel(plan, b.data());
+
+        TEST_CHECK(test::max_error(b.data(), a) < test::EXACT_ERROR);
+        TEST_CHECK(!serial || std::memcmp(a.data(), b.data(), size * sizeof(f32)) == 0);
+
+        inverse(plan, a.data());
+        inverse_parallel(plan, b.data());
+
+        TEST_CHECK(test::max_error(b.data(), a) < test::EXACT_ERROR);
+        TEST_CHECK(!serial || std::memcmp(a.data(), b.data(), size * sizeof(f32)) == 0);
+
+        destroy_plan(plan);
+    }
+
+    stop_threads();
+}
+
+
+int main()
+{
+    pool_for_each();
+    pool_nested();
+    pool_transforms();
+
+    fft::destroy_plans();
+
+    return test::result("test_thread_pool");
+}
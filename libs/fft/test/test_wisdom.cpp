@@ -0,0 +1,96 @@
+#include "test.hpp"
+
+#include <string>
+
+// files are written to the working directory
+
+using namespace fft;
+
+
+static void wisdom_round_trip()
+{
+    TEST_CHECK(tune(16, 1024));
+
+    Engine engines[PLAN_MAX_EXP + 1] = {};
+    for (u32 e = 4; e <= 10; e++)
+    {
+        engines[e] = tuned_engine(1u << e);
+    }
+
+    auto level = simd();
+
+    TEST_CHECK(save_wisdom("wisdom.txt"));
+
+    set_simd(cpu::SIMD::None);
+
+    TEST_CHECK(load_wisdom("wisdom.txt"));
+    TEST_CHECK(simd() == level);
+
+    for (u32 e = 4; e <= 10; e++)
+    {
+        TEST_CHECK(tuned_engine(1u << e) == engines[e]);
+    }
+
+    Plan plan;
+    TEST_CHECK(create_tuned_plan(plan, 1024));
+    TEST_CHECK(plan.engine == tuned_engine(1024));
+    destroy_plan(plan);
+
+    // sizes not tuned
+    TEST_CHECK(tuned_engine(1u << 20) == Engine::Ooura);
+    TEST_CHECK(tuned_engine(1000) == Engine::Ooura);
+}
+
+
+static void wisdom_malformed()
+{
+    char header[64];
+    std::snprintf(header, sizeof(header), "fft wisdom 1\ncpu %s\nsimd none\n", cpu::simd_name(cpu::simd_level()));
+
+    auto const rejected = [&](cstr lines)
+    {
+        std::string text = header;
+        text += lines;
+
+        return test::write_text("wisdom_bad.txt", text.c_str()) && !load_wisdom("wisdom_bad.txt");
+    };
+
+    auto engine = tuned_engine(1024);
+
+    TEST_CHECK(!load_wisdom("missing_wisdom.txt"));
+
+    TEST_CHECK(test::write_text("wisdom_bad.txt", "") && !load_wisdom("wisdom_bad.txt"));
+    TEST_CHECK(test::write_text("wisdom_bad.txt", "fft wisdom 2\ncpu none\nsimd none\n") && !load_wisdom("wisdom_bad.txt"));
+    TEST_CHECK(test::write_text("wisdom_bad.txt", "fft wisdom 1\ncpu SSE9\nsimd none\n") && !load_wisdom("wisdom_bad.txt"));
+
+    // sizes out of range or not a power of 2, before any table is indexed
+    TEST_CHECK(rejected("1073741824 Stockham\n"));
+    TEST_CHECK(rejected("4294967295 Stockham\n"));
+    TEST_CHECK(rejected("99999999999 Fft4g\n"));
+    TEST_CHECK(rejected("0 Ooura\n"));
+    TEST_CHECK(rejected("2 Ooura\n"));
+    TEST_CHECK(rejected("1000 Ooura\n"));
+    TEST_CHECK(rejected("1024 Fft8g\n33554432 Fft4g\n"));
+
+    TEST_CHECK(rejected("1024 Radix3\n"));
+    TEST_CHECK(rejected("1024\n"));
+    TEST_CHECK(rejected("size Ooura\n"));
+
+    // a rejected file changes nothing
+    TEST_CHECK(tuned_engine(1024) == engine);
+
+    // header only, valid and empty
+    TEST_CHECK(!rejected(""));
+    TEST_CHECK(tuned_engine(1024) == Engine::Ooura);
+}
+
+
+int main()
+{
+    wisdom_round_trip();
+    wisdom_malformed();
+
+    destroy_plans();
+
+    return test::result("test_wisdom");
+}
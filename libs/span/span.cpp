@@ -1,8 +1,9 @@
 #pragma once
 
 #include "span.hpp"
+#include "../util/cpu.hpp"
 
-#ifdef __AVX__
+#ifdef __SSE2__
 #define SPAN_SIMD_128
 #endif
 
@@ -13,8 +14,12 @@
 
 
 
-#ifdef SPAN_SIMD_128
+#if defined(SPAN_SIMD_128) || defined(CPU_X86)
 #include <immintrin.h>
+#endif
+
+
+#ifdef SPAN_SIMD_128
 
 /* defines */
 
@@ -524,6 +529,221 @@ namespace span
 }
 
 
+/* avx2 */
+
+#ifdef CPU_X86
+
+namespace span
+{
+    CPU_TARGET_AVX2 static inline void bit_copy_1024_avx2(u8* src, u8* dst)
+    {
+        auto s = (__m256i*)src;
+        auto d = (__m256i*)dst;
+
+        auto a = _mm256_loadu_si256(s);
+        auto b = _mm256_loadu_si256(s + 1);
+        auto c = _mm256_loadu_si256(s + 2);
+        auto e = _mm256_loadu_si256(s + 3);
+
+        _mm256_storeu_si256(d, a);
+        _mm256_storeu_si256(d + 1, b);
+        _mm256_storeu_si256(d + 2, c);
+        _mm256_storeu_si256(d + 3, e);
+    }
+
+
+    CPU_TARGET_AVX2 static inline void bit_fill_1024_avx2(u8* dst, __m256i value)
+    {
+        auto d = (__m256i*)dst;
+
+        _mm256_storeu_si256(d, value);
+        _mm256_storeu_si256(d + 1, value);
+        _mm256_storeu_si256(d + 2, value);
+        _mm256_storeu_si256(d + 3, value);
+    }
+
+
+    CPU_TARGET_AVX2
+    static void copy_1024_avx2(u8* src, u8* dst, u64 len_u8)
+    {
+        auto const n1024 = len_u8 / size1024;
+        auto const end1024 = n1024 * size1024;
+
+        u64 i = 0;
+
+        for(; i < end1024; i += size1024)
+        {
+            bit_copy_1024_avx2(src + i, dst + i);
+        }
+
+        i = len_u8 - size1024;
+        bit_copy_1024_avx2(src + i, dst + i);
+
+        _mm256_zeroupper();
+    }
+
+
+    CPU_TARGET_AVX2
+    static void fill_1024_avx2(u8* dst, __m256i value, u64 len_u8)
+    {
+        auto const n1024 = len_u8 / size1024;
+        auto const end1024 = n1024 * size1024;
+
+        u64 i = 0;
+
+        for (; i < end1024; i += size1024)
+        {
+            bit_fill_1024_avx2(dst + i, value);
+        }
+
+        i = len_u8 - size1024;
+        bit_fill_1024_avx2(dst + i, value);
+
+        _mm256_zeroupper();
+    }
+
+
+    CPU_TARGET_AVX2
+    static void fill_u8_1024_avx2(u8* dst, u8 value, u64 len_u8)
+    {
+        fill_1024_avx2(dst, _mm256_set1_epi8((char)value), len_u8);
+    }
+
+
+    CPU_TARGET_AVX2
+    static void fill_u32_1024_avx2(u32* dst, u32 value, u64 len_u32)
+    {
+        fill_1024_avx2((u8*)dst, _mm256_set1_epi32((int)value), len_u32 * size32);
+    }
+}
+
+
+/* avx512 */
+
+namespace span
+{
+    CPU_TARGET_AVX512 static inline void bit_copy_1024_avx512(u8* src, u8* dst)
+    {
+        auto a = _mm512_loadu_si512(src);
+        auto b = _mm512_loadu_si512(src + size512);
+
+        _mm512_storeu_si512(dst, a);
+        _mm512_storeu_si512(dst + size512, b);
+    }
+
+
+    CPU_TARGET_AVX512
+    static void copy_1024_avx512(u8* src, u8* dst, u64 len_u8)
+    {
+        auto const n1024 = len_u8 / size1024;
+        auto const end1024 = n1024 * size1024;
+
+        u64 i = 0;
+
+        for(; i < end1024; i += size1024)
+        {
+            bit_copy_1024_avx512(src + i, dst + i);
+        }
+
+        i = len_u8 - size1024;
+        bit_copy_1024_avx512(src + i, dst + i);
+
+        _mm256_zeroupper();
+    }
+
+
+    CPU_TARGET_AVX512
+    static void fill_1024_avx512(u8* dst, __m512i value, u64 len_u8)
+    {
+        auto const n1024 = len_u8 / size1024;
+        auto const end1024 = n1024 * size1024;
+
+        u64 i = 0;
+
+        for (; i < end1024; i += size1024)
+        {
+            _mm512_storeu_si512(dst + i, value);
+            _mm512_storeu_si512(dst + i + size512, value);
+        }
+
+        i = len_u8 - size1024;
+        _mm512_storeu_si512(dst + i, value);
+        _mm512_storeu_si512(dst + i + size512, value);
+
+        _mm256_zeroupper();
+    }
+
+
+    CPU_TARGET_AVX512
+    static void fill_u8_1024_avx512(u8* dst, u8 value, u64 len_u8)
+    {
+        fill_1024_avx512(dst, _mm512_set1_epi32((int)(value * 0x01010101u)), len_u8);
+    }
+
+
+    CPU_TARGET_AVX512
+    static void fill_u32_1024_avx512(u32* dst, u32 value, u64 len_u32)
+    {
+        fill_1024_avx512((u8*)dst, _mm512_set1_epi32((int)value), len_u32 * size32);
+    }
+}
+
+#endif // CPU_X86
+
+
+/* simd dispatch */
+
+namespace span
+{
+    // kernels for spans of 128 bytes or more, bound at startup to the best level the cpu supports
+    // the scalar kernels until then, a copy or fill from another static initializer is safe
+
+    class BlockKernels
+    {
+    public:
+        void (*copy_u8)(u8* src, u8* dst, u64 len_u8) = copy_1024;
+        void (*fill_u8)(u8* dst, u8 value, u64 len_u8) = fill_u8_1024;
+        void (*fill_u32)(u32* dst, u32 value, u64 len_u32) = fill_u32_1024;
+    };
+
+
+    static BlockKernels block_kernels;
+
+
+    static cpu::SIMD bind_block_kernels(cpu::SIMD simd)
+    {
+        auto& k = block_kernels;
+
+#ifdef CPU_X86
+        if (simd >= cpu::SIMD::AVX512)
+        {
+            k.copy_u8 = copy_1024_avx512;
+            k.fill_u8 = fill_u8_1024_avx512;
+            k.fill_u32 = fill_u32_1024_avx512;
+
+            return cpu::SIMD::AVX512;
+        }
+
+        if (simd >= cpu::SIMD::AVX2)
+        {
+            k.copy_u8 = copy_1024_avx2;
+            k.fill_u8 = fill_u8_1024_avx2;
+            k.fill_u32 = fill_u32_1024_avx2;
+
+            return cpu::SIMD::AVX2;
+        }
+#endif
+
+        k = BlockKernels{};
+
+        return cpu::SIMD::None;
+    }
+
+
+    static cpu::SIMD block_simd = bind_block_kernels(cpu::simd_level());
+}
+
+
 /* api */
 
 namespace span
@@ -559,7 +779,7 @@ namespace span
             copy_512(src, dst, len_u8);
             break;
         default:
-            copy_1024(src, dst, len_u8);
+            block_kernels.copy_u8(src, dst, len_u8);
         }
     }
 
@@ -595,7 +815,7 @@ namespace span
             fill_u8_512(dst, value, len_u8);
             break;
         default:
-            fill_u8_1024(dst, value, len_u8);
+            block_kernels.fill_u8(dst, value, len_u8);
         }
     }
 
@@ -631,7 +851,7 @@ namespace span
             fill_u32_512(dst, value, len_u32);
             break;
         default:
-            fill_u32_1024(dst, value, len_u32);
+            block_kernels.fill_u32(dst, value, len_u32);
         }
     }
 }
\ No newline at end of file
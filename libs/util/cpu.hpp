@@ -0,0 +1,77 @@
+#pragma once
+
+#include "types.hpp"
+
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#define CPU_X86
+
+// functions using instructions above the compile baseline must be marked
+// and only called after checking simd_level()
+#define CPU_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define CPU_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+
+#endif
+
+
+namespace cpu
+{
+    enum class SIMD : int
+    {
+        None = 0,
+        SSE2,
+        AVX2,   // + FMA
+        AVX512  // AVX-512F + AVX2 + FMA
+    };
+
+
+    inline SIMD detect_simd()
+    {
+#ifdef CPU_X86
+        __builtin_cpu_init();
+
+        auto sse2 = __builtin_cpu_supports("sse2");
+        auto avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        auto avx512 = avx2 && __builtin_cpu_supports("avx512f");
+
+        if (avx512)
+        {
+            return SIMD::AVX512;
+        }
+
+        if (avx2)
+        {
+            return SIMD::AVX2;
+        }
+
+        if (sse2)
+        {
+            return SIMD::SSE2;
+        }
+#endif
+
+        return SIMD::None;
+    }
+
+
+    // detected once, on first use
+    inline SIMD simd_level()
+    {
+        static SIMD const level = detect_simd();
+
+        return level;
+    }
+
+
+    inline cstr simd_name(SIMD simd)
+    {
+        switch (simd)
+        {
+        case SIMD::SSE2: return "SSE2";
+        case SIMD::AVX2: return "AVX2";
+        case SIMD::AVX512: return "AVX-512";
+        default: return "none";
+        }
+    }
+}
@@ -2,12 +2,13 @@
 
 #include "types.hpp"
 
+#include <bit>
 #include <cassert>
 
 
-#ifdef __AVX__
+// SSE2 is baseline on x86-64, FMA only when the build targets it (-mfma)
+#ifdef __SSE2__
 #define NUMERIC_SIMD_128
-// -mavx -mavx2 -mfma
 
 #include <immintrin.h>
 
@@ -40,12 +41,16 @@ namespace numeric
 
 #endif
 
+#if defined(NUMERIC_SIMD_128) && defined(__FMA__)
+#define NUMERIC_FMA
+#endif
+
 namespace numeric
 {
 
     inline f64 fma(f64 a, f64 b, f64 c)
     {
-#ifdef NUMERIC_SIMD_128
+#ifdef NUMERIC_FMA
         auto a128 = to_128(a);
         auto b128 = to_128(b);
         auto c128 = to_128(c);
@@ -61,7 +66,7 @@ namespace numeric
 
     inline f32 fmaf(f32 a, f32 b, f32 c)
     {
-#ifdef NUMERIC_SIMD_128
+#ifdef NUMERIC_FMA
         auto a128 = to_128(a);
         auto b128 = to_128(b);
         auto c128 = to_128(c);
@@ -283,12 +288,12 @@ namespace numeric
 {
     inline f32 log(f32 x) 
     {
-        u32 bx = *(u32*)(&x);
+        u32 bx = std::bit_cast<u32>(x);
         u32 ex = bx >> 23;
         i32 t = (i32)ex-(i32)127;
         i32 s = (t < 0) ? (-t) : t;
         bx = 1065353216 | (bx & 8388607);
-        x = *(f32*)(&bx);
+        x = std::bit_cast<f32>(bx);
 
         return -1.49278 + (2.11263 + (-0.729104+0.10969 * x) * x) * x + 0.6931471806 * t;
     }
@@ -296,15 +301,15 @@ namespace numeric
     
     inline f32 q_rsqrt(f32 number)
     {
-        long i;
+        i32 i;
         float x2, y;
         constexpr float threehalfs = 1.5F;
 
         x2 = number * 0.5F;
         y  = number;
-        i  = * ( long * ) &y;
+        i  = std::bit_cast<i32>(y);
         i  = 0x5f3759df - ( i >> 1 );
-        y  = * ( float * ) &i;
+        y  = std::bit_cast<float>(i);
         y  = y * ( threehalfs - ( x2 * y * y ) );   // 1st iteration
         // y  = y * ( threehalfs - ( x2 * y * y ) );   // 2nd iteration, this can be removed
 
@@ -319,15 +324,15 @@ namespace numeric
             return 0.0f;
         }
         
-        long i;
+        i32 i;
         float x2, y;
         constexpr float threehalfs = 1.5F;
 
         x2 = number * 0.5F;
         y  = number;
-        i  = * ( long * ) &y;
+        i  = std::bit_cast<i32>(y);
         i  = 0x5f3759df - ( i >> 1 );
-        y  = * ( float * ) &i;
+        y  = std::bit_cast<float>(i);
         y  = y * ( threehalfs - ( x2 * y * y ) );   // 1st iteration
         y  = y * ( threehalfs - ( x2 * y * y ) );   // 2nd iteration
 
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+
+// single producer, single consumer ring of T, wait-free on both sides
+// write and read each touch their own index and a cached copy of the other one,
+// the indexes sit on separate cache lines
+template <typename T>
+class SPSCRing
+{
+private:
+	static constexpr u32 LINE = 64;
+
+	T* data_ = 0;
+	u32 capacity_ = 0; // power of 2
+	u32 mask_ = 0;
+
+	// producer side
+	alignas(LINE) std::atomic<u32> head_{ 0 };
+	u32 tail_cache_ = 0;
+
+	// consumer side
+	alignas(LINE) std::atomic<u32> tail_{ 0 };
+	u32 head_cache_ = 0;
+
+
+	// count values starting at index, in at most 2 pieces
+	void copy_in(u32 index, T const* src, u32 count)
+	{
+		auto i = index & mask_;
+		auto first = capacity_ - i < count ? capacity_ - i : count;
+
+		std::memcpy(data_ + i, src, first * sizeof(T));
+		std::memcpy(data_, src + first, (count - first) * sizeof(T));
+	}
+
+
+	void copy_out(u32 index, T* dst, u32 count) const
+	{
+		auto i = index & mask_;
+		auto first = capacity_ - i < count ? capacity_ - i : count;
+
+		std::memcpy(dst, data_ + i, first * sizeof(T));
+		std::memcpy(dst + first, data_, (count - first) * sizeof(T));
+	}
+
+public:
+
+	~SPSCRing() { destroy(); }
+
+
+	// capacity is rounded up to a power of 2
+	bool create(u32 capacity)
+	{
+		destroy();
+
+		u32 c = 1;
+		while (c < capacity)
+		{
+			c *= 2;
+		}
+
+		data_ = (T*)std::malloc(c * sizeof(T));
+		if (!data_)
+		{
+			return false;
+		}
+
+		capacity_ = c;
+		mask_ = c - 1;
+
+		head_ = 0;
+		tail_ = 0;
+		tail_cache_ = 0;
+		head_cache_ = 0;
+
+		return true;
+	}
+
+
+	void destroy()
+	{
+		std::free(data_);
+
+		data_ = 0;
+		capacity_ = 0;
+		mask_ = 0;
+	}
+
+
+	u32 capacity() const { return capacity_; }
+
+
+	/* producer */
+
+	// values that can be written
+	u32 space()
+	{
+		tail_cache_ = tail_.load(std::memory_order_acquire);
+
+		return capacity_ - (head_.load(std::memory_order_relaxed) - tail_cache_);
+	}
+
+
+	// copies as many values as fit, returns the count written
+	u32 write(T const* src, u32 count)
+	{
+		auto head = head_.load(std::memory_order_relaxed);
+
+		if (capacity_ - (head - tail_cache_) < count)
+		{
+			tail_cache_ = tail_.load(std::memory_order_acquire);
+		}
+
+		auto space = capacity_ - (head - tail_cache_);
+		if (count > space)
+		{
+			count = space;
+		}
+
+		copy_in(head, src, count);
+
+		head_.store(head + count, std::memory_order_release);
+
+		return count;
+	}
+
+
+	/* consumer */
+
+	// values ready to read
+	u32 size()
+	{
+		head_cache_ = head_.load(std::memory_order_acquire);
+
+		return head_cache_ - tail_.load(std::memory_order_relaxed);
+	}
+
+
+	// copies up to count values, returns the count read
+	u32 read(T* dst, u32 count)
+	{
+		auto tail = tail_.load(std::memory_order_relaxed);
+
+		if (head_cache_ - tail < count)
+		{
+			head_cache_ = head_.load(std::memory_order_acquire);
+		}
+
+		auto available = head_cache_ - tail;
+		if (count > available)
+		{
+			count = available;
+		}
+
+		copy_out(tail, dst, count);
+
+		tail_.store(tail + count, std::memory_order_release);
+
+		return count;
+	}
+};
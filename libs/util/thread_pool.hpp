@@ -0,0 +1,204 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+
+// fork-join pool, the calling thread works on the tasks too
+class ThreadPool
+{
+private:
+	using task_fn = void (*)(void* ctx, u32 task_id);
+
+	std::vector<std::thread> workers_;
+
+	// read by n_threads() from any thread while start() or stop() runs
+	std::atomic<u32> n_workers_{ 0 };
+
+	std::mutex mutex_;
+	std::mutex run_mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+
+	bool stopping_ = false;
+	u64 generation_ = 0;
+	u32 n_active_ = 0;
+
+	task_fn fn_ = 0;
+	void* ctx_ = 0;
+	u32 n_tasks_ = 0;
+
+	std::atomic<u32> next_task_{ 0 };
+	std::atomic<u32> n_done_{ 0 };
+
+
+	// set while this thread runs a task of any pool
+	static bool& in_task()
+	{
+		thread_local bool in = false;
+		return in;
+	}
+
+
+	void work(task_fn fn, void* ctx, u32 n_tasks)
+	{
+		for (auto id = next_task_.fetch_add(1); id < n_tasks; id = next_task_.fetch_add(1))
+		{
+			in_task() = true;
+			fn(ctx, id);
+			in_task() = false;
+
+			if (n_done_.fetch_add(1) + 1 == n_tasks)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				done_.notify_all();
+			}
+		}
+	}
+
+
+	void worker_proc(u64 seen)
+	{
+		for (;;)
+		{
+			task_fn fn = 0;
+			void* ctx = 0;
+			u32 n_tasks = 0;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				wake_.wait(lock, [&]{ return stopping_ || generation_ != seen; });
+
+				if (stopping_)
+				{
+					return;
+				}
+
+				seen = generation_;
+				fn = fn_;
+				ctx = ctx_;
+				n_tasks = n_tasks_;
+				n_active_++;
+			}
+
+			work(fn, ctx, n_tasks);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				n_active_--;
+				done_.notify_all();
+			}
+		}
+	}
+
+
+	void run(task_fn fn, void* ctx, u32 n_tasks)
+	{
+		std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+		{
+			// a worker still leaving the previous job must not pick up the new one half way
+			std::unique_lock<std::mutex> lock(mutex_);
+			done_.wait(lock, [&]{ return n_active_ == 0; });
+
+			fn_ = fn;
+			ctx_ = ctx;
+			n_tasks_ = n_tasks;
+			next_task_ = 0;
+			n_done_ = 0;
+			generation_++;
+		}
+
+		wake_.notify_all();
+
+		work(fn, ctx, n_tasks);
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		done_.wait(lock, [&]{ return n_done_ == n_tasks; });
+	}
+
+public:
+
+	~ThreadPool() { stop(); }
+
+
+	bool is_running() const { return n_workers_ > 0; }
+
+
+	// workers + the calling thread
+	u32 n_threads() const { return n_workers_ + 1; }
+
+
+	// n_threads including the calling thread, 0: one per hardware thread
+	bool start(u32 n_threads)
+	{
+		stop();
+
+		if (!n_threads)
+		{
+			n_threads = std::thread::hardware_concurrency();
+		}
+
+		stopping_ = false;
+
+		for (u32 i = 1; i < n_threads; i++)
+		{
+			workers_.emplace_back([this, g = generation_]{ worker_proc(g); });
+		}
+
+		n_workers_ = (u32)workers_.size();
+
+		return true;
+	}
+
+
+	void stop()
+	{
+		n_workers_ = 0;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+
+		wake_.notify_all();
+
+		for (auto& th : workers_)
+		{
+			th.join();
+		}
+
+		workers_.clear();
+	}
+
+
+	// calls func(task_id) for task_id 0 to n_tasks - 1 and returns when all are done
+	// called from inside a task the tasks run inline, the workers are busy with the outer job
+	template <class FUNC>
+	void for_each(u32 n_tasks, FUNC const& func)
+	{
+		if (!n_tasks)
+		{
+			return;
+		}
+
+		if (!n_workers_ || n_tasks == 1 || in_task())
+		{
+			for (u32 i = 0; i < n_tasks; i++)
+			{
+				func(i);
+			}
+
+			return;
+		}
+
+		auto fn = [](void* ctx, u32 id) { (*(FUNC const*)ctx)(id); };
+
+		run(fn, (void*)&func, n_tasks);
+	}
+};
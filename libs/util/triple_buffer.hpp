@@ -0,0 +1,64 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <atomic>
+
+
+// latest value handoff between one producer and one consumer
+// the producer fills write_slot() and publishes it, the consumer swaps in the newest published slot
+// neither side waits, the consumer keeps its slot until its next update
+template <typename T>
+class TripleBuffer
+{
+private:
+	static constexpr u32 LINE = 64;
+	static constexpr u32 INDEX = 3;
+	static constexpr u32 FRESH = 4;
+
+	T slots_[3] = {};
+
+	// producer side
+	alignas(LINE) u32 write_ = 0;
+
+	// slot last published, FRESH until the consumer takes it
+	alignas(LINE) std::atomic<u32> middle_{ 1 };
+
+	// consumer side
+	alignas(LINE) u32 read_ = 2;
+
+public:
+
+	// for setting up all slots before the producer and consumer start
+	T& slot(u32 i) { return slots_[i]; }
+
+
+	/* producer */
+
+	T& write_slot() { return slots_[write_]; }
+
+
+	void publish()
+	{
+		write_ = middle_.exchange(write_ | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+
+	/* consumer */
+
+	T const& read_slot() const { return slots_[read_]; }
+
+
+	// returns true when a newer slot was taken
+	bool update()
+	{
+		if (!(middle_.load(std::memory_order_relaxed) & FRESH))
+		{
+			return false;
+		}
+
+		read_ = middle_.exchange(read_, std::memory_order_acq_rel) & INDEX;
+
+		return true;
+	}
+};